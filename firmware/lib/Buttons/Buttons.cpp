@@ -0,0 +1,186 @@
+#include "Buttons.h"
+
+Buttons buttons;
+
+// Samples a button must stay pressed before it reports a long press.
+static constexpr uint16_t kLongPressSamples =
+    (uint16_t)(((uint32_t)BUTTON_LONG_PRESS_MS * 1000UL + Buttons::SAMPLE_US - 1) / Buttons::SAMPLE_US);
+
+// Polled edges closer together than the sampler's 8-sample window are bounce.
+static constexpr uint16_t kPollSettleMs = 16;
+
+// Polled hold times stop here, well before the 16-bit millis() stamp wraps;
+// the main loop polls far more often than the remaining 5.5 s.
+static constexpr uint16_t kPollHeldMaxMs = 60000;
+
+uint8_t Buttons::readPins_()
+{
+    const uint8_t pins = PINC;
+    uint8_t mask = 0;
+    if ((pins & _BV(PC3)) == 0)
+    {
+        mask |= BUTTON_1;
+    }
+    if ((pins & _BV(PC7)) == 0)
+    {
+        mask |= BUTTON_2;
+    }
+    return mask;
+}
+
+uint8_t Buttons::consume_(volatile uint8_t &events)
+{
+    if (!sampling_)
+    {
+        poll_();
+    }
+    const uint8_t oldSREG = SREG;
+    cli();
+    const uint8_t value = events;
+    events = 0;
+    SREG = oldSREG;
+    return value;
+}
+
+void Buttons::begin()
+{
+    const uint8_t pins = readPins_();
+    const uint8_t oldSREG = SREG;
+    cli();
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        history_[i] = (pins & (1 << i)) ? 0xFF : 0x00;
+        held_[i] = 0;
+    }
+    state_ = pins;
+    pressed_ = released_ = long_pressed_ = 0;
+    // Only presses seen by the sampler can turn into long presses.
+    long_armed_ = 0;
+    sampling_ = true;
+    SREG = oldSREG;
+}
+
+void Buttons::end()
+{
+    // Carry the sampled hold times over so a hold in progress keeps counting.
+    const uint16_t now = (uint16_t)millis();
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        since_ms_[i] = now - heldMs(1 << i);
+    }
+    sampling_ = false;
+}
+
+void Buttons::poll_()
+{
+    const uint16_t now = (uint16_t)millis();
+    const uint8_t pins = readPins_();
+    const uint8_t changed = pins ^ state_;
+
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        const uint8_t bit = 1 << i;
+        uint16_t held = now - since_ms_[i];
+
+        if (changed & bit)
+        {
+            // Every edge restarts the hold; only edges after a quiet spell are events.
+            if (held >= kPollSettleMs)
+            {
+                if (pins & bit)
+                {
+                    pressed_ |= bit;
+                }
+                else
+                {
+                    released_ |= bit;
+                }
+            }
+            if (pins & bit)
+            {
+                long_armed_ |= bit;
+            }
+            else
+            {
+                long_armed_ &= ~bit;
+            }
+            since_ms_[i] = now;
+            held = 0;
+        }
+        else if (held > kPollHeldMaxMs)
+        {
+            since_ms_[i] = now - kPollHeldMaxMs;
+        }
+
+        if ((long_armed_ & bit) && held >= BUTTON_LONG_PRESS_MS)
+        {
+            long_armed_ &= ~bit;
+            long_pressed_ |= bit;
+        }
+    }
+    state_ = pins;
+}
+
+void Buttons::sample()
+{
+    const uint8_t pins = readPins_();
+    uint8_t state = state_;
+
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        const uint8_t bit = 1 << i;
+        history_[i] = (history_[i] << 1) | ((pins & bit) ? 1 : 0);
+
+        if (history_[i] == 0xFF && !(state & bit))
+        {
+            state |= bit;
+            pressed_ |= bit;
+            long_armed_ |= bit;
+            held_[i] = 0;
+        }
+        else if (history_[i] == 0x00 && (state & bit))
+        {
+            state &= ~bit;
+            released_ |= bit;
+            long_armed_ &= ~bit;
+            held_[i] = 0;
+        }
+        else if (held_[i] != 0xFFFF)
+        {
+            held_[i]++;
+        }
+
+        if ((long_armed_ & bit) && held_[i] >= kLongPressSamples)
+        {
+            long_armed_ &= ~bit;
+            long_pressed_ |= bit;
+        }
+    }
+    state_ = state;
+}
+
+bool Buttons::isDown(uint8_t mask)
+{
+    if (!sampling_)
+    {
+        poll_();
+    }
+    return (state_ & mask) == mask;
+}
+
+uint16_t Buttons::heldMs(uint8_t button)
+{
+    const uint8_t i = (button == BUTTON_2) ? 1 : 0;
+    if (!sampling_)
+    {
+        poll_();
+        return (uint16_t)millis() - since_ms_[i];
+    }
+    const uint8_t oldSREG = SREG;
+    cli();
+    const uint16_t samples = held_[i];
+    SREG = oldSREG;
+    // 2048 us per sample: multiply by 2097/1024 (about 2.048).
+    const uint32_t ms = ((uint32_t)samples * 2097UL) >> 10;
+    return ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+}
@@ -0,0 +1,128 @@
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <Arduino.h>
+
+// Hold time after which a still-pressed button reports a long press
+#ifndef BUTTON_LONG_PRESS_MS
+#define BUTTON_LONG_PRESS_MS 400U
+#endif
+
+/**
+ * Front-button sampler. The display timer calls sample() once per full
+ * 2048 us refresh; each button shifts its raw level into an 8-sample
+ * history and only changes state after eight equal samples (about 16 ms).
+ * The main loop reads the clean levels and consumes latched edge events,
+ * so its timing no longer affects debouncing or hold durations.
+ *
+ * While the display timer is stopped (headless JP1 builds, power-down),
+ * every read polls the pins instead and times holds from millis().
+ */
+class Buttons
+{
+public:
+    enum Mask : uint8_t
+    {
+        BUTTON_1 = 0x01, // PC3
+        BUTTON_2 = 0x02, // PC7
+        BUTTON_BOTH = BUTTON_1 | BUTTON_2
+    };
+
+    // Sampling period of the debouncer, one full display refresh.
+    static constexpr uint16_t SAMPLE_US = 2048;
+
+    /**
+     * Start debouncing from the current pin levels. Held buttons count as
+     * already pressed, so no press event is raised for them.
+     */
+    void begin();
+
+    /**
+     * Stop using the sampled state while the timer is off. Reads then poll
+     * the pins, and hold times continue from millis().
+     */
+    void end();
+
+    /**
+     * Shift one raw sample into each button history and latch events.
+     * Called from the display timer interrupt.
+     */
+    void sample();
+
+    /**
+     * Return whether all buttons in a mask are held.
+     *
+     * @param mask Buttons to test.
+     * @returns Debounced state while sampling, the raw pin state otherwise.
+     */
+    bool isDown(uint8_t mask);
+
+    /**
+     * Return how long a button has been in its current debounced state.
+     *
+     * @param button `BUTTON_1` or `BUTTON_2`.
+     * @returns Hold time in milliseconds, saturating after about two minutes
+     *     while sampling and after a minute while polling.
+     */
+    uint16_t heldMs(uint8_t button);
+
+    /**
+     * Return and clear the buttons that were pressed since the last call.
+     *
+     * @returns Mask of press events.
+     */
+    uint8_t consumePressed() { return consume_(pressed_); }
+
+    /**
+     * Return and clear the buttons that were released since the last call.
+     *
+     * @returns Mask of release events.
+     */
+    uint8_t consumeReleased() { return consume_(released_); }
+
+    /**
+     * Return and clear the buttons held past `BUTTON_LONG_PRESS_MS` since
+     * the last call. Each press raises at most one long-press event.
+     *
+     * @returns Mask of long-press events.
+     */
+    uint8_t consumeLongPress() { return consume_(long_pressed_); }
+
+private:
+    bool sampling_ = false;
+    uint8_t history_[2] = {0, 0};  // Raw samples, newest in bit 0 (1 = pressed)
+    volatile uint8_t state_ = 0;   // Debounced pressed mask
+    uint16_t held_[2] = {0, 0};    // Samples since each button last changed state
+    volatile uint8_t pressed_ = 0;
+    volatile uint8_t released_ = 0;
+    volatile uint8_t long_pressed_ = 0;
+    uint8_t long_armed_ = 0;       // Pressed buttons that have not reported a long press yet
+    uint16_t since_ms_[2] = {0, 0}; // millis() of each button's last change while polling
+
+    /**
+     * Read the raw pressed mask from the button pins.
+     *
+     * @returns Mask of buttons whose pin reads low.
+     */
+    static uint8_t readPins_();
+
+    /**
+     * Follow the pins from the main loop while the timer is off. The state
+     * tracks the pins directly, so the power-down wake check still works with
+     * millis() stopped; every edge restarts the hold time, and an edge more
+     * than 16 ms after the previous one raises the same event as sample().
+     */
+    void poll_();
+
+    /**
+     * Atomically read and clear one event latch.
+     *
+     * @param events Latch written by sample() or poll_().
+     * @returns Previous latch contents.
+     */
+    uint8_t consume_(volatile uint8_t &events);
+};
+
+extern Buttons buttons;
+
+#endif
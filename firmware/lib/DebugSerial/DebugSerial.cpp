@@ -1,18 +1,53 @@
 #include "DebugSerial.h"
 
-#include <avr/interrupt.h>
-#include <avr/io.h>
-#include <util/delay.h>
+#include <Arduino.h>
 
 #ifndef JP1_DEBUG_BAUD
 #define JP1_DEBUG_BAUD 9600UL
 #endif
 
+#ifndef JP1_DEBUG_TX_FIFO
+#define JP1_DEBUG_TX_FIFO 32
+#endif
+
 #if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+/*
+ * A bit edge waits for whatever interrupt is running. 9600 baud tolerates
+ * about 50 us of extra latency, 38400 only about 6 us, which the multiplex
+ * and ADC interrupts exceed; faster rates are only safe with both stopped.
+ */
+#if JP1_DEBUG_BAUD > 9600 && !(defined(JP1_DEBUG_HEADLESS_RX) && defined(RX_POLLING))
+#error "JP1_DEBUG_BAUD above 9600 needs JP1_DEBUG_HEADLESS_RX and RX_POLLING"
+#endif
+
+static_assert((JP1_DEBUG_TX_FIFO & (JP1_DEBUG_TX_FIFO - 1)) == 0 && JP1_DEBUG_TX_FIFO <= 128,
+              "JP1_DEBUG_TX_FIFO must be a power of two up to 128");
+
+/*
+ * TX-only software UART clocked by the Timer0 compare A interrupt. Timer0
+ * already runs free for millis(), so the UART only moves OCR0A from one bit
+ * edge to the next and does not depend on the display timer, which
+ * JP1_DEBUG_HEADLESS_RX builds stop. Bit periods are kept as 8.8 fixed point
+ * timer ticks, so the rounding error of a 13.02-tick bit (9600 baud at the
+ * usual 125 kHz Timer0 clock) never accumulates across a frame; each edge
+ * lands within half a tick (4 us) plus interrupt latency of its ideal time.
+ */
 namespace
 {
 constexpr uint8_t kTxBit = PC0;
-constexpr uint16_t kBitDelayUs = static_cast<uint16_t>(1000000UL / JP1_DEBUG_BAUD);
+constexpr uint8_t kFifoMask = JP1_DEBUG_TX_FIFO - 1;
+
+volatile uint8_t fifo[JP1_DEBUG_TX_FIFO];
+volatile uint8_t fifo_head = 0;
+volatile uint8_t fifo_tail = 0;
+volatile bool tx_active = false;
+
+// Owned by the compare ISR while tx_active is set.
+uint16_t tx_frame = 0;
+uint8_t tx_bits = 0;
+bool tx_idle_bit = false;
+uint16_t edge_q8 = 0;
+uint16_t bit_q8 = 0;
 
 /**
  * Drive the JP1 TX line high for idle or data bits.
@@ -31,11 +66,47 @@ inline void txLow()
 }
 
 /**
- * Wait exactly one software UART bit period.
+ * Move the next queued byte into the frame shift register. Called from the
+ * compare ISR.
+ *
+ * @returns `false` when the FIFO is empty.
+ */
+inline bool loadNextFrame()
+{
+    const uint8_t tail = fifo_tail;
+    if (tail == fifo_head)
+    {
+        return false;
+    }
+    // Start bit, eight data bits LSB first, stop bit.
+    tx_frame = (uint16_t)(0x200 | ((uint16_t)fifo[tail] << 1));
+    tx_bits = 10;
+    tx_idle_bit = false;
+    fifo_tail = (tail + 1) & kFifoMask;
+    return true;
+}
+
+/**
+ * Arm the compare interrupt for the first bit edge. The first edge drives
+ * one idle bit, so the start bit always begins on a scheduled edge.
  */
-inline void delayBit()
+void startTx()
 {
-    _delay_us(kBitDelayUs);
+    const uint8_t oldSREG = SREG;
+    cli();
+    if (!tx_active)
+    {
+        tx_active = true;
+        tx_frame = 1;
+        tx_bits = 1;
+        tx_idle_bit = false;
+        const uint8_t first = (uint8_t)(TCNT0 + 2);
+        edge_q8 = (uint16_t)first << 8;
+        OCR0A = first;
+        TIFR0 = _BV(OCF0A);
+        TIMSK0 |= _BV(OCIE0A);
+    }
+    SREG = oldSREG;
 }
 
 /**
@@ -56,39 +127,92 @@ inline void writeHexNibble(uint8_t nibble)
 }
 } // namespace
 
+/**
+ * Drive one bit edge of the JP1 UART and schedule the next one.
+ */
+ISR(TIMER0_COMPA_vect)
+{
+    // Drive the edge first; the bookkeeping below only prepares the next one.
+    if (tx_frame & 0x01)
+    {
+        txHigh();
+    }
+    else
+    {
+        txLow();
+    }
+    tx_frame >>= 1;
+    edge_q8 += bit_q8;
+    OCR0A = (uint8_t)((edge_q8 + 0x80) >> 8);
+
+    if (--tx_bits != 0 || loadNextFrame())
+    {
+        return;
+    }
+    if (tx_idle_bit)
+    {
+        // The last stop bit ended at this edge.
+        TIMSK0 &= (uint8_t)~_BV(OCIE0A);
+        tx_active = false;
+        return;
+    }
+    // Hold the line high for one more bit so a byte queued now cannot shorten the stop bit.
+    tx_frame = 1;
+    tx_bits = 1;
+    tx_idle_bit = true;
+}
+
 void debuglog::begin()
 {
     // JP1 pin 2 is wired as a TX-only debug output for simple USB-UART capture during receiver bring-up.
     DDRC |= _BV(kTxBit);
     txHigh();
+
+    // Timer0 belongs to millis(); only its clock select is read here.
+    static const uint16_t kPrescalers[] = {0, 1, 8, 64, 256, 1024};
+    const uint8_t cs = TCCR0A & (_BV(CS02) | _BV(CS01) | _BV(CS00));
+    const uint16_t prescaler = cs < sizeof(kPrescalers) / sizeof(kPrescalers[0]) ? kPrescalers[cs] : 0;
+    const uint32_t q8 = prescaler != 0 ? (((F_CPU / prescaler) << 8) + JP1_DEBUG_BAUD / 2) / JP1_DEBUG_BAUD : 0;
+
+    // A bit needs at least two timer ticks and must fit the 8-bit compare range.
+    bit_q8 = (q8 >= 0x200 && q8 < 0x10000) ? (uint16_t)q8 : 0;
 }
 
 void debuglog::write(uint8_t value)
 {
-    const uint8_t oldSreg = SREG;
-    cli();
-
-    txLow();
-    delayBit();
+    if (bit_q8 == 0)
+    {
+        // Not started, or Timer0 cannot clock this baud rate.
+        return;
+    }
 
-    for (uint8_t bit = 0; bit < 8; ++bit)
+    const uint8_t next = (fifo_head + 1) & kFifoMask;
+    while (next == fifo_tail)
     {
-        if (value & 0x01)
-        {
-            txHigh();
-        }
-        else
+        if (!(SREG & _BV(SREG_I)))
         {
-            txLow();
+            return;
         }
-        delayBit();
-        value >>= 1;
     }
+    fifo[fifo_head] = value;
+    fifo_head = next;
 
-    txHigh();
-    delayBit();
+    if (!tx_active)
+    {
+        startTx();
+    }
+}
+
+uint8_t debuglog::txFree()
+{
+    return (uint8_t)((fifo_tail - fifo_head - 1) & kFifoMask);
+}
 
-    SREG = oldSreg;
+void debuglog::flush()
+{
+    while (tx_active && (SREG & _BV(SREG_I)))
+    {
+    }
 }
 
 void debuglog::print(const char *text)
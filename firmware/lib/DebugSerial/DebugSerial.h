@@ -15,7 +15,8 @@ inline void begin() {}
 #endif
 
 /**
- * Send one raw byte over the JP1 debug serial output.
+ * Queue one raw byte for the JP1 debug serial output. Blocks only while the
+ * transmit FIFO is full; with interrupts disabled a full FIFO drops the byte.
  *
  * @param value Byte to transmit.
  */
@@ -25,6 +26,27 @@ void write(uint8_t value);
 inline void write(uint8_t) {}
 #endif
 
+/**
+ * Return how many bytes fit into the transmit FIFO without blocking.
+ *
+ * @returns Free FIFO slots.
+ */
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+uint8_t txFree();
+#else
+inline uint8_t txFree() { return 0xFF; }
+#endif
+
+/**
+ * Wait until every queued byte, stop bit included, has left the TX pin.
+ * Call before power-down, which stops the timer that clocks the bits.
+ */
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+void flush();
+#else
+inline void flush() {}
+#endif
+
 /**
  * Send a null-terminated string without a trailing newline.
  *
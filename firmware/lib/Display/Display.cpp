@@ -1,4 +1,5 @@
 #include "Display.h"
+#include "Buttons.h"
 #include "Storage.h"
 #include "Timer.h"
 #include <avr/pgmspace.h>
@@ -8,6 +9,8 @@
 static Timer timer;
 Display display; // Global display instance
 static constexpr uint8_t kBootMessageLength = sizeof(emptyPattern) - 4;
+static constexpr uint8_t kColumnQueueMask = DISPLAY_COLUMN_QUEUE_SIZE - 1;
+static_assert((DISPLAY_COLUMN_QUEUE_SIZE & kColumnQueueMask) == 0, "DISPLAY_COLUMN_QUEUE_SIZE must be a power of two");
 
 /**
  * Forward timer interrupts into the display multiplex routine.
@@ -24,7 +27,9 @@ void Display::startAnimation_(const animation_t *anim, bool storage_backed)
     current_anim_progmem = false;
     current_anim_storage_backed = storage_backed;
     reset();
+    applyBrightness_();
     update_threshold = current_anim->speed;
+    scroll_right = current_anim->type == AnimationType::TEXT && current_anim->direction == 1;
 
     if (current_anim->direction == 1 && current_anim->length > 0)
     {
@@ -32,9 +37,192 @@ void Display::startAnimation_(const animation_t *anim, bool storage_backed)
     }
 
     // Render the first frame immediately so the caller does not need to wait
-    // for the next timer threshold before seeing the new content.
+    // for the next timer threshold before seeing the new content. Text only
+    // fills the column queue here, so let the ISR shift in the first column
+    // at the next refresh boundary.
     need_update = 1;
     update();
+    if (col_queue_tail != col_queue_head)
+    {
+        update_cnt = update_threshold - 1;
+    }
+}
+
+void Display::applyBrightness_()
+{
+    uint8_t level = brightness_;
+    if (current_anim && current_anim->brightness != 0 && current_anim->brightness < level)
+    {
+        level = current_anim->brightness;
+    }
+
+    const uint16_t on_ticks = (column_ticks_ / DISPLAY_MAX_BRIGHTNESS) * level;
+    const uint8_t oldSREG = SREG;
+    cli();
+    column_on_ticks_ = on_ticks;
+    column_off_ticks_ = column_ticks_ - on_ticks;
+    SREG = oldSREG;
+}
+
+uint8_t *Display::backBuffer_()
+{
+    uint8_t *back = disp_buf[front_buf ^ 1];
+
+    if (!swap_pending)
+    {
+        const uint8_t *front = disp_buf[front_buf];
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            back[i] = front[i];
+        }
+    }
+
+    return back;
+}
+
+void Display::clearColumnQueue_()
+{
+    col_queue_head = 0;
+    col_queue_tail = 0;
+    text_cycle_done_ = false;
+}
+
+inline void Display::shiftInQueuedColumn_()
+{
+    uint8_t *buf = disp_buf[front_buf];
+    const uint8_t column = col_queue[col_queue_head & kColumnQueueMask];
+    col_queue_head++;
+
+    if (scroll_right)
+    {
+        for (uint8_t i = 7; i > 0; i--)
+        {
+            buf[i] = buf[i - 1];
+        }
+        buf[0] = column;
+    }
+    else
+    {
+        for (uint8_t i = 0; i < 7; i++)
+        {
+            buf[i] = buf[i + 1];
+        }
+        buf[7] = column;
+    }
+}
+
+uint8_t Display::renderTextColumn_(bool boot_message)
+{
+    if (boot_message)
+    {
+        uint8_t glyphIndex = pgm_read_byte(emptyPattern + 4 + str_pos);
+        const uint8_t *glyph_addr = (const uint8_t *)pgm_read_ptr(&font[glyphIndex]);
+        uint8_t glyph_len = pgm_read_byte(&glyph_addr[0]);
+        char_pos++;
+
+        if (char_pos > glyph_len)
+        {
+            char_pos = 0;
+            str_pos = (str_pos + 1) % kBootMessageLength;
+        }
+
+        if (char_pos == 0)
+        {
+            return 0xFF;
+        }
+        return ~pgm_read_byte(&glyph_addr[char_pos]);
+    }
+
+    ensureStorageChunkLoaded_();
+    uint8_t chunk_offset = chunkOffset_();
+
+    // Load current character glyph from PROGMEM
+    const uint8_t *glyph_addr = (const uint8_t *)pgm_read_ptr(&font[current_anim->data[chunk_offset]]);
+    uint8_t glyph_len = pgm_read_byte(&glyph_addr[0]);
+    char_pos++;
+
+    if (char_pos > glyph_len)
+    {
+        char_pos = 0;
+        // Advance to next/previous character in text
+        if (current_anim->direction == 0)
+        {
+            str_pos++;
+        }
+        else
+        {
+            str_pos = (str_pos == 0) ? current_anim->length : (str_pos - 1);
+        }
+    }
+
+    if (str_pos >= current_anim->length)
+    {
+        text_cycle_done_ = true;
+    }
+
+    // Glyphs are streamed one column at a time so long text can scroll without a full frame buffer.
+    if (char_pos == 0)
+    {
+        return 0xFF; // whitespace
+    }
+    if (current_anim->direction == 0)
+    {
+        return ~pgm_read_byte(&glyph_addr[char_pos]);
+    }
+    return ~pgm_read_byte(&glyph_addr[glyph_len - char_pos + 1]);
+}
+
+/**
+ * Keep the ISR's column queue full and run the end-of-cycle handling once the
+ * last queued column of the cycle has actually been shown.
+ *
+ * @param boot_message `true` when the PROGMEM boot message is playing.
+ */
+void Display::updateText_(bool boot_message)
+{
+    if (status == RUNNING)
+    {
+        need_update = 0;
+
+        // The ISR has shifted in the last column of the cycle.
+        if (text_cycle_done_ && col_queue_head == col_queue_tail)
+        {
+            text_cycle_done_ = false;
+            if (finishAnimationCycle_() || status != RUNNING)
+            {
+                return;
+            }
+        }
+
+        // Glyph lookups and storage chunk loads happen here, ahead of the
+        // ISR, so a busy main loop only drains the queue instead of stalling
+        // the scroll.
+        while (!text_cycle_done_ && (uint8_t)(col_queue_tail - col_queue_head) < DISPLAY_COLUMN_QUEUE_SIZE)
+        {
+            col_queue[col_queue_tail & kColumnQueueMask] = renderTextColumn_(boot_message);
+            col_queue_tail++;
+        }
+        return;
+    }
+
+    if (!need_update)
+    {
+        return;
+    }
+    need_update = 0;
+
+    if (boot_message)
+    {
+        str_pos = 0;
+        status = RUNNING;
+        return;
+    }
+
+    str_pos++;
+    if (str_pos >= current_anim->delay)
+    {
+        endPause_();
+    }
 }
 
 void Display::ensureStorageChunkLoaded_()
@@ -97,6 +285,20 @@ void Display::rewindAnimationCycle_()
  *
  * @returns `true` when playback autoskipped to a different stored pattern.
  */
+void Display::endPause_()
+{
+    if (current_anim->direction == 0)
+    {
+        str_pos = 0;
+    }
+    else
+    {
+        str_pos = current_anim->length - 1;
+    }
+    status = RUNNING;
+    update_threshold = current_anim->speed;
+}
+
 bool Display::finishAnimationCycle_()
 {
     if (!current_anim)
@@ -142,6 +344,14 @@ void Display::enable()
     // which yields a full 8-column refresh every 2048 us.
     timer.initialize(256);
     timer.attachInterrupt(onTimerTick);
+    column_ticks_ = timer.periodTicks();
+    column_lit_ = false;
+    if (brightness_ == 0)
+    {
+        brightness_ = DISPLAY_DEFAULT_BRIGHTNESS;
+    }
+    applyBrightness_();
+    buttons.begin();
     timer.start();
 
     // --- Initialize turn-on animation pattern (skip in diagnostics or when disabled) ---
@@ -153,10 +363,19 @@ void Display::enable()
 // Multiplex one column; advance animation on threshold
 void Display::multiplex()
 {
+    // Second compare of a dimmed column: keep it dark for the rest of its slot.
+    if (column_lit_)
+    {
+        PORTB = 0x00;
+        column_lit_ = false;
+        timer.setPeriodTicks(column_off_ticks_);
+        return;
+    }
+
     // Disable current column
     PORTB = 0x00;
     // Output row data for the active column
-    uint8_t rows = disp_buf[active_col];
+    uint8_t rows = disp_buf[front_buf][active_col];
     // Overlay indicator pixel (active-low)
     if (indicator_active && active_col == indicator_col)
     {
@@ -165,11 +384,26 @@ void Display::multiplex()
     PORTD = rows;
     // The matrix uses active-low column selection, so driving one bit high selects that transistor.
     PORTB = (1 << active_col);
+    /*
+     * Binary code modulation with one level for the whole matrix: the lit
+     * bit slots of a column merge into a single on period, so dimming costs
+     * one extra compare interrupt per column instead of one per bit.
+     */
+    timer.setPeriodTicks(column_on_ticks_);
+    column_lit_ = column_off_ticks_ != 0;
 
     // Next column
     if (++active_col == 8)
     {
         active_col = 0;
+        // Debounce the front buttons once per refresh, independent of loop latency.
+        buttons.sample();
+        // Flip buffers only between full refreshes so every scan shows one coherent frame.
+        if (swap_pending)
+        {
+            front_buf ^= 1;
+            swap_pending = 0;
+        }
         // Decrement indicator lifetime once per full refresh
         if (indicator_active)
         {
@@ -185,6 +419,12 @@ void Display::multiplex()
         if (++update_cnt == update_threshold)
         {
             update_cnt = 0;
+            // Text scrolls by shifting in a column the main loop rendered
+            // ahead of time, so the cadence does not depend on loop latency.
+            if (col_queue_head != col_queue_tail)
+            {
+                shiftInQueuedColumn_();
+            }
             need_update = 1;
         }
     }
@@ -193,16 +433,33 @@ void Display::multiplex()
 void Display::disable()
 {
     timer.stop();
+    buttons.end();
     DDRB = DDRD = 0x00;
 }
 
+void Display::resume()
+{
+    DDRB = 0xFF;
+    DDRD = 0xFF;
+    column_lit_ = false;
+    buttons.begin();
+    timer.start();
+}
+
 // Reset the display buffer and animation state
 void Display::reset()
 {
+    const uint8_t oldSREG = SREG;
+    cli();
     for (uint8_t i = 0; i < 8; i++)
     {
-        disp_buf[i] = 0xFF; // All LEDs off (active-low)
+        // All LEDs off (active-low) in both buffers, so no stale frame can flip back in.
+        disp_buf[0][i] = 0xFF;
+        disp_buf[1][i] = 0xFF;
     }
+    swap_pending = 0;
+    clearColumnQueue_();
+    SREG = oldSREG;
     update_cnt = 0;
     repeat_cnt = 0;
     repeat_advance_requested_ = false;
@@ -216,21 +473,29 @@ void Display::reset()
 // --- Diagnostics helpers ---
 void Display::clearColumns()
 {
+    // Batch direct column writes into the back buffer; the ISR shows them
+    // together at the next refresh boundary.
+    const uint8_t oldSREG = SREG;
+    cli();
+    uint8_t *buf = backBuffer_();
     for (uint8_t i = 0; i < 8; i++)
     {
         // 0xFF = all LEDs off for a column (active-low rows)
-        // Keep private buffer semantics consistent
-        // (Multiplex ISR will read from disp_buf)
-        // Note: no locking; acceptable for simple diagnostics
-        disp_buf[i] = 0xFF;
+        buf[i] = 0xFF;
     }
+    swap_pending = 1;
+    SREG = oldSREG;
 }
 
 void Display::setColumn(uint8_t idx, uint8_t value)
 {
     if (idx < 8)
     {
-        disp_buf[idx] = value;
+        const uint8_t oldSREG = SREG;
+        cli();
+        backBuffer_()[idx] = value;
+        swap_pending = 1;
+        SREG = oldSREG;
     }
 }
 
@@ -251,6 +516,57 @@ void Display::clearIndicator()
     indicator_frames = 0;
 }
 
+void Display::setBrightness(uint8_t level)
+{
+    if (level == 0 || level > DISPLAY_MAX_BRIGHTNESS)
+    {
+        return;
+    }
+    brightness_ = level;
+    applyBrightness_();
+}
+
+void Display::stepBrightness()
+{
+    setBrightness(brightness_ <= 1 ? DISPLAY_MAX_BRIGHTNESS : (brightness_ >> 1));
+}
+
+uint8_t Display::brightness() const
+{
+    return brightness_;
+}
+
+uint16_t Display::pauseRemainingMs() const
+{
+    const uint8_t oldSREG = SREG;
+    cli();
+    const bool paused = current_anim != nullptr && status == PAUSED;
+    const uint16_t steps = paused ? current_anim->delay - str_pos : 0;
+    const uint8_t step_progress = update_cnt;
+    SREG = oldSREG;
+
+    if (steps == 0)
+    {
+        return 0;
+    }
+    // Each pause step lasts 244 refreshes of 2048 us.
+    const uint32_t refreshes = (uint32_t)steps * 244 - step_progress;
+    return (uint16_t)((refreshes * 2048UL) / 1000UL);
+}
+
+void Display::skipPause()
+{
+    const uint8_t oldSREG = SREG;
+    cli();
+    if (current_anim != nullptr && status == PAUSED)
+    {
+        endPause_();
+        update_cnt = 0;
+        need_update = 0;
+    }
+    SREG = oldSREG;
+}
+
 bool Display::consumeAnimationRepeatRequest()
 {
     bool requested = repeat_advance_requested_;
@@ -260,10 +576,15 @@ bool Display::consumeAnimationRepeatRequest()
 
 void Display::snapshotState(DisplayState &state) const
 {
+    // Capture the newest frame, which is the back buffer while a swap is pending.
+    const uint8_t oldSREG = SREG;
+    cli();
+    const uint8_t *latest = disp_buf[swap_pending ? (front_buf ^ 1) : front_buf];
     for (uint8_t i = 0; i < 8; ++i)
     {
-        state.columns[i] = disp_buf[i];
+        state.columns[i] = latest[i];
     }
+    SREG = oldSREG;
     state.indicator_active = indicator_active;
     state.indicator_col = indicator_col;
     state.indicator_row = indicator_row;
@@ -280,10 +601,16 @@ void Display::snapshotState(DisplayState &state) const
 
 void Display::freezeState(const DisplayState &state)
 {
+    const uint8_t oldSREG = SREG;
+    cli();
+    uint8_t *buf = backBuffer_();
     for (uint8_t i = 0; i < 8; ++i)
     {
-        disp_buf[i] = state.columns[i];
+        buf[i] = state.columns[i];
     }
+    swap_pending = 1;
+    clearColumnQueue_();
+    SREG = oldSREG;
 
     indicator_active = state.indicator_active;
     indicator_col = state.indicator_col;
@@ -295,6 +622,7 @@ void Display::freezeState(const DisplayState &state)
     current_anim = nullptr;
     current_anim_progmem = false;
     current_anim_storage_backed = false;
+    applyBrightness_();
     update_cnt = 0;
     need_update = 0;
     update_threshold = 0;
@@ -354,6 +682,8 @@ void Display::showBootMessage()
     current_anim_progmem = true;
     current_anim_storage_backed = false;
     reset();
+    applyBrightness_();
+    scroll_right = false;
 
     const uint8_t p2 = pgm_read_byte(emptyPattern + 2);
     const uint8_t p3 = pgm_read_byte(emptyPattern + 3);
@@ -381,148 +711,62 @@ void Display::showBootMessage()
 
     need_update = 1;
     update();
+    if (col_queue_tail != col_queue_head)
+    {
+        update_cnt = update_threshold - 1;
+    }
 }
 
-// Update display content when needed (called from interrupt)
+// Render the next animation step (called from the main loop)
 void Display::update()
 {
-    if (!need_update)
+    const bool boot_message_active = current_anim == nullptr && current_anim_progmem;
+
+    if (boot_message_active || (current_anim && current_anim->type == AnimationType::TEXT))
     {
+        updateText_(boot_message_active);
         return;
     }
-    need_update = 0;
 
-    const bool boot_message_active = current_anim == nullptr && current_anim_progmem;
-
-    if (!current_anim && !boot_message_active)
+    if (!need_update)
     {
         return;
     }
 
-    if (boot_message_active)
+    /*
+     * The previous frame is still waiting for the ISR to flip it in. Keep
+     * the request pending and render on a later pass, so the back buffer is
+     * never written while the ISR may swap it to the front.
+     */
+    if (swap_pending)
     {
-        if (status == RUNNING)
-        {
-            for (uint8_t i = 0; i < 7; i++)
-            {
-                disp_buf[i] = disp_buf[i + 1];
-            }
-
-            uint8_t glyphIndex = pgm_read_byte(emptyPattern + 4 + str_pos);
-            const uint8_t *glyph_addr = (const uint8_t *)pgm_read_ptr(&font[glyphIndex]);
-            uint8_t glyph_len = pgm_read_byte(&glyph_addr[0]);
-            char_pos++;
-
-            if (char_pos > glyph_len)
-            {
-                char_pos = 0;
-                str_pos = (str_pos + 1) % kBootMessageLength;
-            }
+        return;
+    }
+    need_update = 0;
 
-            if (char_pos == 0)
-            {
-                disp_buf[7] = 0xFF;
-            }
-            else
-            {
-                disp_buf[7] = ~pgm_read_byte(&glyph_addr[char_pos]);
-            }
-        }
-        else if (status == PAUSED)
-        {
-            str_pos = 0;
-            status = RUNNING;
-        }
+    if (!current_anim)
+    {
         return;
     }
 
     if (status == RUNNING)
     {
-        if (current_anim->type == AnimationType::FRAMES)
-        {
-            ensureStorageChunkLoaded_();
-            uint8_t chunk_offset = chunkOffset_();
+        ensureStorageChunkLoaded_();
+        uint8_t chunk_offset = chunkOffset_();
 
-            // Copy one frame (8 columns) into disp_buf
-            for (uint8_t i = 0; i < 8; i++)
-            {
-                disp_buf[i] = ~(current_anim->data[chunk_offset + i]); // invert for active-low
-            }
-            str_pos += 8;
-            if (str_pos >= current_anim->length)
-            {
-                if (finishAnimationCycle_())
-                {
-                    return;
-                }
-            }
+        // Copy one frame (8 columns) into the back buffer
+        uint8_t *buf = disp_buf[front_buf ^ 1];
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            buf[i] = ~(current_anim->data[chunk_offset + i]); // invert for active-low
         }
-        else if (current_anim->type == AnimationType::TEXT)
+        swap_pending = 1;
+        str_pos += 8;
+        if (str_pos >= current_anim->length)
         {
-            ensureStorageChunkLoaded_();
-            uint8_t chunk_offset = chunkOffset_();
-
-            // Scroll display contents
-            if (current_anim->direction == 0)
-            {
-                // Left
-                for (uint8_t i = 0; i < 7; i++)
-                {
-                    disp_buf[i] = disp_buf[i + 1];
-                }
-            }
-            else
-            {
-                // Right
-                for (uint8_t i = 7; i > 0; i--)
-                {
-                    disp_buf[i] = disp_buf[i - 1];
-                }
-            }
-
-            // Load current character glyph from PROGMEM
-            const uint8_t *glyph_addr = (const uint8_t *)pgm_read_ptr(&font[current_anim->data[chunk_offset]]);
-            uint8_t glyph_len = pgm_read_byte(&glyph_addr[0]);
-            char_pos++;
-
-            if (char_pos > glyph_len)
-            {
-                char_pos = 0;
-                // Advance to next/previous character in text
-                if (current_anim->direction == 0)
-                {
-                    str_pos++;
-                }
-                else
-                {
-                    str_pos = (str_pos == 0) ? current_anim->length : (str_pos - 1);
-                }
-            }
-
-            // Glyphs are streamed one column at a time so long text can scroll without a full frame buffer.
-            if (current_anim->direction == 0)
-            {
-                // New data on rightmost column
-                if (char_pos == 0)
-                    disp_buf[7] = 0xFF; // whitespace
-                else
-                    disp_buf[7] = ~pgm_read_byte(&glyph_addr[char_pos]);
-            }
-            else
-            {
-                // New data on leftmost column
-                if (char_pos == 0)
-                    disp_buf[0] = 0xFF; // whitespace
-                else
-                    disp_buf[0] = ~pgm_read_byte(&glyph_addr[glyph_len - char_pos + 1]);
-            }
-
-            if (str_pos >= current_anim->length)
+            if (finishAnimationCycle_())
             {
-                if (finishAnimationCycle_())
-                {
-                    return;
-                }
+                return;
             }
         }
     }
@@ -531,20 +775,7 @@ void Display::update()
         str_pos++;
         if (str_pos >= current_anim->delay)
         {
-            if (current_anim->direction == 0)
-            {
-                str_pos = 0;
-            }
-            else if (current_anim->length <= 128)
-            {
-                str_pos = current_anim->length - 1;
-            }
-            else
-            {
-                str_pos = current_anim->length - 1;
-            }
-            status = RUNNING;
-            update_threshold = current_anim->speed;
+            endPause_();
         }
     }
 }
@@ -9,6 +9,20 @@
 #define FW_REV_MINOR 0
 #endif
 
+// Number of text columns the main loop renders ahead of the multiplex ISR.
+// Must be a power of two; 8 columns cover 164 ms of main-loop stalls at the
+// fastest scroll speed.
+#ifndef DISPLAY_COLUMN_QUEUE_SIZE
+#define DISPLAY_COLUMN_QUEUE_SIZE 8
+#endif
+
+// Brightness is the lit share of each column slot in eighths: level 8 keeps
+// every column on for its whole 256 us slot, level 1 for 32 us.
+#define DISPLAY_MAX_BRIGHTNESS 8
+#ifndef DISPLAY_DEFAULT_BRIGHTNESS
+#define DISPLAY_DEFAULT_BRIGHTNESS DISPLAY_MAX_BRIGHTNESS
+#endif
+
 // --- Animation definitions ---
 
 enum class AnimationType : uint8_t
@@ -26,6 +40,7 @@ struct animation
     uint8_t delay;
     uint8_t direction;
     uint8_t repeat;
+    uint8_t brightness; // 1..7 caps this pattern's brightness, 0 follows the global level
     uint8_t *data;
 };
 typedef struct animation animation_t;
@@ -56,13 +71,19 @@ public:
      */
     void disable();
 
+    /**
+     * Restart matrix output after disable() without touching the animation state.
+     */
+    void resume();
+
     /**
      * Drive one multiplex column and advance the animation counters.
      */
     void multiplex();
 
     /**
-     * Advance the currently active animation when the refresh threshold is reached.
+     * Advance the currently active animation when the refresh threshold is
+     * reached, and keep the text column queue topped up.
      */
     void update();
 
@@ -117,6 +138,48 @@ public:
      */
     void clearIndicator();
 
+    /**
+     * Set the global brightness used by every pattern that does not ask for a dimmer level.
+     *
+     * @param level Brightness from 1 (dimmest) to `DISPLAY_MAX_BRIGHTNESS` (full duty).
+     */
+    void setBrightness(uint8_t level);
+
+    /**
+     * Step the global brightness down one binary weight (8, 4, 2, 1) and wrap back to full.
+     */
+    void stepBrightness();
+
+    /**
+     * Return the global brightness level.
+     *
+     * @returns Brightness from 1 to `DISPLAY_MAX_BRIGHTNESS`.
+     */
+    uint8_t brightness() const;
+
+    /**
+     * Return the column the multiplex ISR drives next. It advances once per
+     * 256 us slot, so the main loop can use it as a tick.
+     *
+     * @returns Column index from 0 to 7.
+     */
+    uint8_t activeColumn() const
+    {
+        return *(const volatile uint8_t *)&active_col;
+    }
+
+    /**
+     * Return how much of the end-of-cycle pause is left.
+     *
+     * @returns Remaining pause in milliseconds, or 0 when no pattern is paused.
+     */
+    uint16_t pauseRemainingMs() const;
+
+    /**
+     * End a running end-of-cycle pause now and start the next cycle.
+     */
+    void skipPause();
+
     /**
      * Return and clear a pending autoskip request raised by finite-repeat playback.
      *
@@ -154,6 +217,51 @@ private:
      */
     void startAnimation_(const animation_t *anim, bool storage_backed);
 
+    /**
+     * Recompute the column on/off split from the global level and the active pattern's cap.
+     */
+    void applyBrightness_();
+
+    /**
+     * Return the back buffer for main-loop rendering. When no swap is
+     * pending it is first seeded from the visible front buffer, so partial
+     * updates such as scrolling build on the frame currently shown.
+     *
+     * Callers must either hold interrupts off or know that no swap is
+     * pending, otherwise the ISR could flip the buffer mid-write.
+     *
+     * @returns Pointer to the eight back-buffer columns.
+     */
+    uint8_t *backBuffer_();
+
+    /**
+     * Drop every queued text column and any pending end-of-cycle.
+     *
+     * Callers must hold interrupts off.
+     */
+    void clearColumnQueue_();
+
+    /**
+     * Shift the oldest queued text column into the visible frame (ISR context).
+     */
+    void shiftInQueuedColumn_();
+
+    /**
+     * Render the next text column from the font and payload and advance the
+     * glyph position. Marks the cycle as done once the last glyph is queued.
+     *
+     * @param boot_message `true` to stream the PROGMEM boot message.
+     * @returns Active-low row mask for the new column.
+     */
+    uint8_t renderTextColumn_(bool boot_message);
+
+    /**
+     * Refill the text column queue and finish the cycle once the ISR has shown its last column.
+     *
+     * @param boot_message `true` when the boot message is playing.
+     */
+    void updateText_(bool boot_message);
+
     /**
      * Ensure that the chunk containing the current payload byte is present in RAM.
      */
@@ -178,11 +286,28 @@ private:
      */
     bool finishAnimationCycle_();
 
+    /**
+     * Leave the end-of-cycle pause at the start position of the next cycle.
+     */
+    void endPause_();
+
     uint8_t active_col;       // Current column being multiplexed
     uint8_t update_cnt;       // Counter for animation timing
     uint8_t need_update;      // Flag set when a new frame/scroll is needed
     uint8_t update_threshold; // How many column-cycles per animation step
-    uint8_t disp_buf[8];      // Column data buffer
+    uint8_t disp_buf[2][8];   // Front/back column buffers
+    volatile uint8_t front_buf;    // Index of the buffer the multiplex ISR scans
+    volatile uint8_t swap_pending; // Back buffer holds a finished frame for the next refresh boundary
+    uint8_t col_queue[DISPLAY_COLUMN_QUEUE_SIZE]; // Pre-rendered text columns waiting for the ISR
+    volatile uint8_t col_queue_head; // Free-running index of the next column the ISR shifts in
+    volatile uint8_t col_queue_tail; // Free-running index of the next slot the main loop fills
+    bool scroll_right;        // Queued columns enter on the left edge
+    bool text_cycle_done_;    // Last column of the text cycle is queued
+    uint8_t brightness_;      // Global brightness level, 0 until enable()
+    uint16_t column_ticks_;   // Timer ticks in one 256 us column slot
+    uint16_t column_on_ticks_;  // Lit part of each column slot
+    uint16_t column_off_ticks_; // Dark remainder, 0 at full brightness
+    bool column_lit_;         // ISR is inside the lit part of a dimmed column
     uint16_t str_pos;         // Position index within animation data
     uint8_t str_chunk;        // Active 128-byte EEPROM chunk for storage-backed playback
     int8_t char_pos;          // For text animations (start at -1)
@@ -2,14 +2,105 @@
 
 FECModem fecModem;
 
+#ifdef FEC_REALIGN
+/**
+ * Count the raw bytes needed to read through one bit offset.
+ *
+ * @param bit Last bit offset to read, at least -8.
+ * @returns Raw bytes that must be buffered.
+ */
+static uint8_t rawBytesThrough(int8_t bit)
+{
+    return (uint8_t)((bit + 8) >> 3);
+}
+
+void FECModem::restartIfCleared_()
+{
+    if (g_modem.takeCleared())
+    {
+        offset_ = 0;
+        suspect_ = false;
+    }
+}
+
+uint8_t FECModem::rawByte_(int8_t index) const
+{
+    return index < 0 ? prev_ : g_modem.peek((uint8_t)index);
+}
+
+uint8_t FECModem::byteAt_(int8_t bit) const
+{
+    // Arithmetic shift keeps negative offsets pointing into prev_.
+    int8_t index = bit >> 3;
+    uint8_t shift = bit & 0x07;
+    if (!shift)
+        return rawByte_(index);
+    return (uint8_t)((rawByte_(index) >> shift) | (rawByte_(index + 1) << (8 - shift)));
+}
+
+bool FECModem::tripleClean_(int8_t bit) const
+{
+    return Hamming::parity2416(byteAt_(bit), byteAt_(bit + 8)) == byteAt_(bit + 16);
+}
+
+bool FECModem::realign_()
+{
+    uint8_t raw = g_modem.available();
+    if (raw < rawBytesThrough(offset_ + 23))
+        return false;
+
+    // The last error was noise if the next triple still decodes where expected.
+    if (tripleClean_(offset_))
+    {
+        suspect_ = false;
+        return true;
+    }
+
+    if (raw < rawBytesThrough(offset_ + MAX_SLIP_BITS + 47))
+        return false;
+
+    // Try the smallest slips first, and require two clean triples so a random match is unlikely.
+    for (int8_t slip = 1; slip <= MAX_SLIP_BITS; ++slip)
+    {
+        for (int8_t candidate = offset_ - slip; candidate <= offset_ + slip; candidate += 2 * slip)
+        {
+            if (tripleClean_(candidate) && tripleClean_(candidate + 24))
+            {
+                offset_ = candidate;
+                if (offset_ >= 8)
+                {
+                    prev_ = g_modem.read();
+                    offset_ -= 8;
+                }
+                suspect_ = false;
+                return true;
+            }
+        }
+    }
+
+    // No alignment fits better, so keep the current one and decode the triple as it is.
+    suspect_ = false;
+    return true;
+}
+#endif
+
 uint8_t FECModem::available()
 {
     if (state_ == SECOND_BYTE)
         return 1;
 
+#ifndef FEC_REALIGN
+    if (g_modem.available() >= 3)
+        return 2;
+#else
+    restartIfCleared_();
+    if (suspect_ && !realign_())
+        return 0;
+
     uint8_t raw = g_modem.available();
-    if (raw >= 3)
+    if (raw >= rawBytesThrough(offset_ + 23))
         return 2;
+#endif
     return 0;
 }
 
@@ -20,13 +111,28 @@ uint8_t FECModem::read()
         state_ = FIRST_BYTE;
         return buf_;
     }
+#ifndef FEC_REALIGN
     // fetch three raw bytes: first, second, parity
-    uint8_t b1 = g_modem.read();
-    buf_ = g_modem.read();
+    uint8_t t1 = g_modem.read();
+    uint8_t t2 = g_modem.read();
     uint8_t p = g_modem.read();
-    uint8_t t1 = b1;
-    uint8_t t2 = buf_;
     Hamming::correct2416(t1, t2, p);
+#else
+    // assemble three raw bytes at the current bit alignment: first, second, parity
+    uint8_t t1 = byteAt_(offset_);
+    uint8_t t2 = byteAt_(offset_ + 8);
+    uint8_t p = byteAt_(offset_ + 16);
+    // A symbol inserted or dropped by a glitch shifts every later byte, and shows up first as a parity mismatch.
+    suspect_ = Hamming::correct2416(t1, t2, p) != 0;
+
+    int8_t end = offset_ + 24;
+    for (uint8_t i = end >> 3; i; --i)
+    {
+        prev_ = g_modem.read();
+    }
+    offset_ = end & 0x07;
+#endif
+
     // return first, buffer second
     buf_ = t2;
     state_ = SECOND_BYTE;
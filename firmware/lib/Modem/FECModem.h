@@ -41,6 +41,54 @@ private:
     enum State : uint8_t { FIRST_BYTE, SECOND_BYTE };
     State state_ = FIRST_BYTE;
     uint8_t buf_ = 0;
+
+#ifdef FEC_REALIGN
+    // Largest bit slip realign_() repairs in either direction. A glitch usually splits or merges one pulse, which
+    // inserts or drops two symbols.
+    static constexpr int8_t MAX_SLIP_BITS = 7;
+
+    // Bit offset of the next triple from the oldest unread raw byte. Negative offsets start inside prev_.
+    int8_t offset_ = 0;
+    uint8_t prev_ = 0;
+    // Set after a triple needed correction, until the alignment of the next one has been checked.
+    bool suspect_ = false;
+
+    /**
+     * Restart at byte alignment when the raw modem buffer was cleared since the last call.
+     */
+    void restartIfCleared_();
+
+    /**
+     * Return the raw byte at an index, where -1 is the last consumed byte.
+     *
+     * @param index Raw byte index from the oldest unread byte.
+     * @returns Raw byte.
+     */
+    uint8_t rawByte_(int8_t index) const;
+
+    /**
+     * Assemble the eight raw bits starting at a bit offset, first received bit in bit 0.
+     *
+     * @param bit Bit offset from the oldest unread raw byte.
+     * @returns Assembled byte.
+     */
+    uint8_t byteAt_(int8_t bit) const;
+
+    /**
+     * Check whether the triple starting at a bit offset has a clean Hamming syndrome.
+     *
+     * @param bit Bit offset from the oldest unread raw byte.
+     * @returns `true` when parity matches both data bytes.
+     */
+    bool tripleClean_(int8_t bit) const;
+
+    /**
+     * Move to the nearest alignment where the next two triples decode cleanly.
+     *
+     * @returns `false` while more raw bytes are needed to decide.
+     */
+    bool realign_();
+#endif
 };
 
 extern FECModem fecModem;
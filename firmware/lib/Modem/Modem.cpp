@@ -35,6 +35,81 @@ void Modem::startConversion_()
     ADCSRA |= _BV(ADSC);
 }
 
+void Modem::trackNoiseFloor_(uint16_t activity)
+{
+    if (calibration_left_)
+    {
+        // Average the first windows after begin(); clipping each one keeps the sum in 16 bits.
+        noise_floor64_ += (activity < 1023) ? activity : 1023;
+        if (--calibration_left_)
+            return;
+    }
+    else if (activity < activity_threshold_)
+    {
+        // Windows below the threshold carry no tone, so the floor follows them as a running average.
+        noise_floor64_ += activity - (noise_floor64_ >> 6);
+    }
+    else if (noise_floor64_ < (uint16_t)(ACTIVITY_THRESHOLD_MAX << 6))
+    {
+        noise_floor64_ += NOISE_RISE_STEP;
+    }
+
+    // Window activity scales with the noise amplitude, so a fixed multiple of the floor keeps the false-trigger
+    // rate the same at any level. 2.25x is more than four standard deviations above the mean of ADC noise.
+    uint16_t floor = noise_floor64_ >> 6;
+    uint16_t threshold = (floor << 1) + (floor >> 2);
+    if (threshold < ACTIVITY_THRESHOLD_MIN)
+        threshold = ACTIVITY_THRESHOLD_MIN;
+    if (threshold > ACTIVITY_THRESHOLD_MAX)
+        threshold = ACTIVITY_THRESHOLD_MAX;
+#if MODEM_OPTICAL
+    // Screen edges are slow against a window, so slice them around half the flash height to keep lit and dark
+    // symbols the same length, with a margin either side so ambient flicker on an edge cannot split a symbol.
+    uint16_t slice = (light_peak_ >> 1) - (light_peak_ >> 3);
+    if (activity < activity_threshold_)
+        slice += light_peak_ >> 2;
+    if (threshold < slice)
+        threshold = slice;
+#endif
+    activity_threshold_ = threshold;
+}
+
+#if MODEM_OPTICAL
+uint16_t Modem::lightActivity_(uint16_t level)
+{
+    // Mains lighting flickers at 100 or 120 Hz, close to one period per three 64-conversion windows, so the level
+    // is summed over the last three windows. A quarter of each window sum keeps the total in 16 bits.
+    level >>= 2;
+    // The first window after begin() is taken as the idle level.
+    if (calibration_left_ == CALIBRATION_WINDOWS)
+    {
+        light_hist_[0] = light_hist_[1] = level;
+        light_ref_ = 3 * level;
+    }
+    uint16_t smoothed = level + light_hist_[0] + light_hist_[1];
+    light_hist_[1] = light_hist_[0];
+    light_hist_[0] = level;
+    level = smoothed;
+
+    uint16_t diff = (level > light_ref_) ? (level - light_ref_) : (light_ref_ - level);
+    uint16_t activity = diff / (3 * NUMBER_OF_SAMPLES / 32);
+
+    // Windows well below the threshold pull the reference in quickly, so each flash is measured from the current
+    // ambient light. Edge and flash windows hold it, since even a slow pull would eat into the next gap; a flash that
+    // outlasts the silence limit is a change of room light instead, and its level becomes the new idle level.
+    if (activity < (activity_threshold_ >> 1))
+        light_ref_ = (level > light_ref_) ? (light_ref_ + (diff >> 3)) : (light_ref_ - (diff >> 3));
+    else if ((prev_freq_ == FREQ_HIGH) && (bitlen_ > (BITLEN_THRESHOLD << 2)))
+        light_ref_ = level;
+
+    // The flash height decays with a time constant of 256 windows, so a dimmer screen is sliced right within a second.
+    light_peak_ -= light_peak_ >> 8;
+    if (activity > light_peak_)
+        light_peak_ = activity;
+    return activity;
+}
+#endif
+
 void Modem::processActivity_(uint16_t activity)
 {
     last_activity_ = activity;
@@ -43,14 +118,18 @@ void Modem::processActivity_(uint16_t activity)
         activity_peak_ = activity;
     }
 
+    trackNoiseFloor_(activity);
+
     // Keep the adaptive envelope tracker alive for diagnostics, but use the
-    // original threshold demodulator for actual bit classification.
-    slicer_.update(activity);
+    // original threshold demodulator for actual bit classification. The tracker
+    // sees activity above the noise floor, so its fixed thresholds are relative to it.
+    uint16_t floor = noise_floor64_ >> 6;
+    slicer_.update(calibration_left_ ? activity : (activity > floor ? activity - floor : 0));
 
     if (bitlen_ < 100)
         bitlen_++;
 
-    if ((activity < ACTIVITY_THRESHOLD) && (bitlen_ > (BITLEN_THRESHOLD << 2)))
+    if ((activity < activity_threshold_) && (bitlen_ > (BITLEN_THRESHOLD << 2)))
     {
         prev_freq_ = FREQ_NONE;
         bitcount_ = 0;
@@ -59,7 +138,7 @@ void Modem::processActivity_(uint16_t activity)
         return;
     }
 
-    freq_ = (activity >= ACTIVITY_THRESHOLD) ? FREQ_HIGH : FREQ_LOW;
+    freq_ = (activity >= activity_threshold_) ? FREQ_HIGH : FREQ_LOW;
     if (freq_ != prev_freq_)
     {
         if (transition_count_ != 0xFF)
@@ -69,15 +148,24 @@ void Modem::processActivity_(uint16_t activity)
         if (prev_freq_ != FREQ_NONE)
         {
             // Each frequency transition closes one symbol; short spans map to 0, long spans map to 1.
-            byte_ = (byte_ >> 1) | (bitlen_ < BITLEN_THRESHOLD ? 0x00 : 0x80);
-            if (!(++bitcount_ % 8))
+            uint8_t bit = bitlen_ < BITLEN_THRESHOLD ? 0x00 : 0x80;
+            byte_ = (byte_ >> 1) | bit;
+            sync_window_ = (sync_window_ >> 1) | ((uint32_t)bit << 16);
+            uint32_t sync_diff = sync_window_ ^ SYNC_WORD;
+            if (sync_search_ && !(sync_diff & (sync_diff - 1)))
+            {
+                // The marker fixes the byte phase whatever came before it, so restart the raw stream with its bytes.
+                clear();
+                emit_((uint8_t)SYNC_WORD);
+                emit_((uint8_t)(SYNC_WORD >> 8));
+                emit_((uint8_t)(SYNC_WORD >> 16));
+                bitcount_ = 0;
+                byte_ = 0;
+                sync_search_ = false;
+            }
+            else if (!(++bitcount_ % 8))
             {
-                put_(byte_);
-                // Update recent raw bytes (pre-FEC)
-                recent_[recent_idx_] = byte_;
-                recent_idx_ = (recent_idx_ + 1) & 0x07;
-                if (recent_count_ < 8)
-                    recent_count_++;
+                emit_(byte_);
             }
         }
         prev_freq_ = freq_;
@@ -95,6 +183,13 @@ void Modem::begin()
     slicer_.reset();
     activity_peak_ = 0;
     transition_count_ = 0;
+    // Measure the idle input before deriving the threshold; until then classify with the build default.
+    noise_floor64_ = 0;
+    activity_threshold_ = ACTIVITY_THRESHOLD;
+    calibration_left_ = CALIBRATION_WINDOWS;
+#if MODEM_OPTICAL
+    light_peak_ = 0;
+#endif
 
     // Configure ADC: AVcc reference, selectable input channel
     ADMUX = _BV(REFS0) | (MODEM_ADC_CHANNEL & 0x0F);
@@ -165,6 +260,18 @@ uint8_t Modem::read()
 void Modem::clear()
 {
     head_ = tail_ = 0;
+    cleared_ = true;
+}
+
+bool Modem::takeCleared()
+{
+    // clear() also runs in the ADC interrupt, so test and reset the flag together.
+    uint8_t sreg = SREG;
+    cli();
+    bool cleared = cleared_;
+    cleared_ = false;
+    SREG = sreg;
+    return cleared;
 }
 
 void Modem::onAdcIsr()
@@ -176,13 +283,17 @@ void Modem::onAdcIsr()
 #endif
     uint16_t delta = (sample > sample_prev_) ? (sample - sample_prev_) : (sample_prev_ - sample);
     sample_prev_ = sample;
-    sample_accu_ += delta;
+    // A light sensor carries each symbol in its level rather than in a tone, so optical builds sum the level itself.
+    sample_accu_ += MODEM_OPTICAL ? sample : delta;
     if (++sample_cnt_ < NUMBER_OF_SAMPLES)
         return;
 
     uint16_t activity = sample_accu_;
     sample_cnt_ = 0;
     sample_accu_ = 0;
+#if MODEM_OPTICAL
+    activity = lightActivity_(activity);
+#endif
     processActivity_(activity);
 }
 
@@ -209,7 +320,7 @@ void Modem::poll(uint8_t budget)
 #endif
         uint16_t delta = (sample > sample_prev_) ? (sample - sample_prev_) : (sample_prev_ - sample);
         sample_prev_ = sample;
-        sample_accu_ += delta;
+        sample_accu_ += MODEM_OPTICAL ? sample : delta;
         if (++sample_cnt_ < NUMBER_OF_SAMPLES)
         {
             continue;
@@ -218,13 +329,16 @@ void Modem::poll(uint8_t budget)
         uint16_t activity = sample_accu_;
         sample_cnt_ = 0;
         sample_accu_ = 0;
+#if MODEM_OPTICAL
+        activity = lightActivity_(activity);
+#endif
 
         if (bitlen_ < 100)
             bitlen_++;
 
 #ifdef DIAG_RX
         // Visualize input activity (top-right corner) regardless of decode
-        if (activity >= (ACTIVITY_THRESHOLD / 2))
+        if (activity >= (activity_threshold_ / 2))
         {
             display.setIndicator(7, 0, 1);
         }
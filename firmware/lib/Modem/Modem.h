@@ -36,11 +36,29 @@ public:
      */
     uint8_t read();
 
+    /**
+     * Read one buffered raw byte without consuming it.
+     *
+     * @param offset Position counted from the oldest buffered byte; must be below available().
+     * @returns Buffered byte.
+     */
+    uint8_t peek(uint8_t offset) const { return buf_[(uint8_t)(tail_ + offset) & (BUF_SIZE - 1)]; }
+
     /**
      * Drop all buffered raw bytes.
      */
     void clear();
 
+    /**
+     * Report whether the raw buffer was cleared since the last call, and reset the report.
+     *
+     * Bytes after a clear start on a fresh bit alignment, so layers that track their own alignment restart when this
+     * is set. Silence clears the buffer on every window, so a latched flag is used rather than a count that could wrap.
+     *
+     * @returns `true` once after one or more clears.
+     */
+    bool takeCleared();
+
     /**
      * Consume one ADC sample batch from the ADC interrupt context.
      */
@@ -60,6 +78,30 @@ public:
      */
     uint16_t getActivity() const { return last_activity_; }
 
+    /**
+     * Enable or disable the start-marker correlator.
+     *
+     * While enabled, every decoded bit is compared with the first FEC triple of the legacy start marker. A match with
+     * at most one bit error restarts byte alignment on the marker, so a transfer needs no silence in front of it.
+     *
+     * @param enabled `true` while the receiver is looking for a frame start.
+     */
+    void setSyncSearch(bool enabled) { sync_search_ = SYNC_SEARCH && enabled; }
+
+    /**
+     * Return the activity threshold the bit classifier currently uses.
+     *
+     * @returns Threshold derived from the measured noise floor.
+     */
+    uint16_t getActivityThreshold() const { return activity_threshold_; }
+
+    /**
+     * Return the measured idle activity level.
+     *
+     * @returns Noise floor in activity units.
+     */
+    uint16_t getNoiseFloor() const { return noise_floor64_ >> 6; }
+
     /**
      * Return the smoothed activity average from the adaptive slicer.
      *
@@ -117,6 +159,7 @@ private:
     static constexpr uint8_t BUF_SIZE = 64;
     volatile uint8_t head_ = 0;
     volatile uint8_t tail_ = 0;
+    volatile bool cleared_ = false;
     uint8_t buf_[BUF_SIZE];
 
     /**
@@ -134,6 +177,20 @@ private:
         }
     }
 
+    /**
+     * Queue one demodulated byte and record it in the recent raw-byte diagnostic ring.
+     *
+     * @param b Byte to emit.
+     */
+    inline void emit_(uint8_t b)
+    {
+        put_(b);
+        recent_[recent_idx_] = b;
+        recent_idx_ = (recent_idx_ + 1) & 0x07;
+        if (recent_count_ < 8)
+            recent_count_++;
+    }
+
     // Demodulation state
     static constexpr uint8_t FREQ_NONE = 0;
     static constexpr uint8_t FREQ_LOW = 1;
@@ -143,9 +200,18 @@ private:
     #ifndef MODEM_NUMBER_OF_SAMPLES
     #define MODEM_NUMBER_OF_SAMPLES 8
     #endif
+    // Threshold used until the noise floor has been measured.
     #ifndef MODEM_ACTIVITY_THRESHOLD
     #define MODEM_ACTIVITY_THRESHOLD 150
     #endif
+    // Bounds for the threshold derived from the noise floor. The lower bound keeps ADC quantization noise out of the
+    // classifier; the upper bound keeps a tone that was already playing at begin() from raising it out of reach.
+    #ifndef MODEM_ACTIVITY_THRESHOLD_MIN
+    #define MODEM_ACTIVITY_THRESHOLD_MIN 32
+    #endif
+    #ifndef MODEM_ACTIVITY_THRESHOLD_MAX
+    #define MODEM_ACTIVITY_THRESHOLD_MAX 300
+    #endif
     #ifndef MODEM_BITLEN_THRESHOLD
     #define MODEM_BITLEN_THRESHOLD 6
     #endif
@@ -158,6 +224,14 @@ private:
     #ifndef MODEM_ACTIVITY_SPAN_THRESHOLD
     #define MODEM_ACTIVITY_SPAN_THRESHOLD 24
     #endif
+    // Set to 1 to receive screen flashes through a light sensor instead of audio tones; see docs/firmware.md.
+    #ifndef MODEM_OPTICAL
+    #define MODEM_OPTICAL 0
+    #endif
+    // Set to 0 to build without the start-marker correlator; transfers then need the long quiet sync gap.
+    #ifndef MODEM_SYNC_SEARCH
+    #define MODEM_SYNC_SEARCH 1
+    #endif
 
     static constexpr uint8_t NUMBER_OF_SAMPLES = MODEM_NUMBER_OF_SAMPLES;
     static constexpr uint16_t ACTIVITY_THRESHOLD = MODEM_ACTIVITY_THRESHOLD;
@@ -165,13 +239,46 @@ private:
     static constexpr uint16_t TONE_DIAG_ON_THRESHOLD = MODEM_TONE_DIAG_ON_THRESHOLD;
     static constexpr uint16_t TONE_DIAG_OFF_THRESHOLD = MODEM_TONE_DIAG_OFF_THRESHOLD;
     static constexpr uint16_t ACTIVITY_SPAN_THRESHOLD = MODEM_ACTIVITY_SPAN_THRESHOLD;
+    static constexpr uint16_t ACTIVITY_THRESHOLD_MIN = MODEM_ACTIVITY_THRESHOLD_MIN;
+    static constexpr uint16_t ACTIVITY_THRESHOLD_MAX = MODEM_ACTIVITY_THRESHOLD_MAX;
+    static constexpr bool SYNC_SEARCH = MODEM_SYNC_SEARCH;
+    // Windows averaged at begin(); 64 windows keep the sum in 16 bits and take about 27 ms at the release ADC rate.
+    static constexpr uint8_t CALIBRATION_WINDOWS = 64;
+    // The noise estimate follows sub-threshold windows with a time constant of 64 windows, and rises by 1/16 count
+    // per window above the threshold so it can still climb when the noise itself crosses the threshold.
+    static constexpr uint8_t NOISE_RISE_STEP = 4;
+
+    static_assert(ACTIVITY_THRESHOLD_MIN <= ACTIVITY_THRESHOLD_MAX, "activity threshold bounds are reversed");
+    static_assert(ACTIVITY_THRESHOLD_MAX <= 1000, "noise floor estimate must fit in 16 bits");
+#if MODEM_OPTICAL
+    static_assert(NUMBER_OF_SAMPLES == 64, "optical flicker filtering assumes 64-conversion windows");
+#endif
 
     uint8_t bitcount_ = 0;
     uint8_t byte_ = 0;
 
+    // Legacy start marker bytes 0xA5 0xA5 and their Hamming parity 0x33, first received bit in bit 0.
+    static constexpr uint32_t SYNC_WORD = 0x33A5A5UL;
+    // Last 24 decoded bits in the same layout.
+    uint32_t sync_window_ = 0;
+    volatile bool sync_search_ = false;
+
+    // Noise floor scaled by 64, the threshold derived from it, and the windows left in the start-up measurement.
+    uint16_t noise_floor64_ = 0;
+    uint16_t activity_threshold_ = ACTIVITY_THRESHOLD;
+    uint8_t calibration_left_ = 0;
+
     uint8_t sample_cnt_ = 0;
     uint16_t sample_prev_ = 512;
     uint16_t sample_accu_ = 0;
+#if MODEM_OPTICAL
+    // Quarter level sums of the previous two windows, newest first.
+    uint16_t light_hist_[2] = {0, 0};
+    // Three-window level sum that flashes are measured against, normally the idle screen under the ambient light.
+    uint16_t light_ref_ = 0;
+    // Tallest recent flash in activity units; the bit threshold sits at half of it.
+    uint16_t light_peak_ = 0;
+#endif
     uint8_t bitlen_ = 0;
     uint8_t freq_ = FREQ_NONE;
     uint8_t prev_freq_ = FREQ_NONE;
@@ -199,6 +306,24 @@ private:
      */
     static void startConversion_();
 
+    /**
+     * Fold one activity measurement into the noise floor and re-derive the classifier threshold.
+     *
+     * @param activity Activity magnitude for the completed sample window.
+     */
+    void trackNoiseFloor_(uint16_t activity);
+
+#if MODEM_OPTICAL
+    /**
+     * Turn one window's light level sum, averaged with the two before it, into activity against the tracked idle
+     * level.
+     *
+     * @param level Sum of the window's ADC conversions.
+     * @returns Distance from the idle level, scaled to an 8-conversion window.
+     */
+    uint16_t lightActivity_(uint16_t level);
+#endif
+
     /**
      * Feed one accumulated activity measurement into the bit classifier.
      *
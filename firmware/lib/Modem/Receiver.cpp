@@ -1,8 +1,8 @@
 #include "Receiver.h"
-#include "DebugSerial.h"
 #include "Display.h"
 #include "DiagLog.h"
 #include "static_patterns.h"
+#include "Trace.h"
 
 ModemReceiver modemReceiver;
 
@@ -18,33 +18,6 @@ static bool storage_ready = false;
  */
 static bool showProgmemPayload(const uint8_t *pattern, uint8_t *buffer, uint8_t length);
 
-#if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-namespace
-{
-/**
- * Emit one compact JP1 receive event marker.
- *
- * @param event Short event string to print.
- */
-inline void logRxEvent(const char *event)
-{
-    debuglog::println(event);
-}
-
-/**
- * Emit the decoded payload length in the JP1 debug stream.
- *
- * @param length Payload length in bytes.
- */
-inline void logRxLength(uint16_t length)
-{
-    debuglog::print("L");
-    debuglog::printHex16(length);
-    debuglog::write('\r');
-    debuglog::write('\n');
-}
-} // namespace
-#endif
 
 /**
  * Decode a stored payload buffer into a temporary animation descriptor and show it.
@@ -76,7 +49,9 @@ static bool showPayloadBuffer(uint8_t *payload, bool storage_backed = false)
     {
         anim.speed = 250 - (p2 & 0xF0);
         anim.delay = (p2 & 0x0F);
-        anim.direction = (p3 >> 4);
+        // Direction is 0 or 1; the three spare bits above it carry an optional brightness cap.
+        anim.direction = (p3 >> 4) & 0x01;
+        anim.brightness = (p3 >> 5);
         anim.repeat = (p3 & 0x0F);
     }
     else
@@ -84,6 +59,8 @@ static bool showPayloadBuffer(uint8_t *payload, bool storage_backed = false)
         anim.speed = 250 - ((p2 & 0x0F) << 4);
         anim.delay = (p3 >> 4);
         anim.direction = 0;
+        // Frame speed only uses the low nibble, so bits 4..6 carry the brightness cap.
+        anim.brightness = (p2 >> 4) & 0x07;
         anim.repeat = (p3 & 0x0F);
     }
     anim.data = payload + 4;
@@ -142,6 +119,23 @@ static bool showProgmemPayload(const uint8_t *pattern, uint8_t *buffer, uint8_t
     return showPayloadBuffer(buffer);
 }
 
+#ifdef RX_BUFFERED_STORE
+/**
+ * Report one committed page of a buffered-store flush on the matrix.
+ *
+ * @param page Zero-based page index inside the flushed batch.
+ * @param ok `true` when the EEPROM acknowledged the page.
+ */
+static void onBufferedPageStored(uint8_t page, bool ok)
+{
+    if (ok)
+    {
+        diaglog::markAppend();
+        display.setIndicator(page & 0x07, 7, 2);
+    }
+}
+#endif
+
 #ifdef DIAG_RX
 static uint8_t diag_hex[40];
 static uint8_t diag_hex_len = 0;
@@ -157,7 +151,7 @@ void ModemReceiver::begin()
     // Defer storage.enable() until a real frame starts to avoid interfering with display pins at boot
     storage_ready = false;
     fecModem.begin();
-    debuglog::println("RX BEGIN");
+    trace::record(trace::RX_BEGIN);
     state_ = START1;
     diaglog::setState(static_cast<uint8_t>(state_));
     rx_pos_ = 0;
@@ -185,7 +179,7 @@ void ModemReceiver::begin()
 void ModemReceiver::end()
 {
     fecModem.end();
-    debuglog::println("RX END");
+    trace::record(trace::RX_END);
 }
 
 #if !defined(RX_NO_STORAGE)
@@ -230,7 +224,8 @@ void ModemReceiver::handleTimeout_()
     fecModem.clear();
     g_modem.clearRecentRaw();
     showTimeoutPattern();
-    debuglog::println("RX TIMEOUT");
+    trace::record(trace::RX_TIMEOUT);
+    diaglog::markTimeout();
 #ifdef DIAG_RX
     diag_hex_len = 0;
     diag_capture_count = 0;
@@ -259,6 +254,9 @@ void ModemReceiver::process()
         return;
     }
 
+    // Let the modem lock byte alignment on the start marker while no frame is open.
+    g_modem.setSyncSearch(state_ <= START2);
+
     uint8_t budget = 32;
     while (budget-- && fecModem.available())
     {
@@ -300,7 +298,7 @@ void ModemReceiver::process()
                     diag_raw[len++] = ' ';
                 }
                 diag_raw_len = len;
-                animation_t a; a.type = AnimationType::TEXT; a.length = diag_raw_len; a.speed = 10; a.delay = 0; a.direction = 0; a.repeat = 0; a.data = diag_raw;
+                animation_t a; a.type = AnimationType::TEXT; a.length = diag_raw_len; a.speed = 10; a.delay = 0; a.direction = 0; a.repeat = 0; a.brightness = 0; a.data = diag_raw;
                 display.show(&a);
                 diag_showing_raw = true;
             }
@@ -338,7 +336,7 @@ void ModemReceiver::process()
                 diag_start_count_ = 0;
                 diag_start_capture_ = true;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("S");
+                trace::record(trace::RX_START);
 #endif
                 // In diagnostics, no large buffering to conserve SRAM
 #ifndef RX_NO_STORAGE
@@ -375,7 +373,7 @@ void ModemReceiver::process()
                 diaglog::markPattern1();
                 diag_events_ |= DIAG_EVENT_PATTERN1;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("1");
+                trace::record(trace::RX_PATTERN1);
 #endif
             }
             else if (b == BYTE_END)
@@ -393,7 +391,7 @@ void ModemReceiver::process()
                 diaglog::markEnd();
                 diag_events_ |= DIAG_EVENT_END;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("E");
+                trace::record(trace::RX_END_MARKER);
 #endif
                 // End of frame: either store or show directly (diagnostic)
 #if !defined(RX_NO_STORAGE) && !defined(RX_BUFFERED_STORE)
@@ -407,7 +405,7 @@ void ModemReceiver::process()
                 diaglog::markFrame();
                 diag_events_ |= DIAG_EVENT_FRAME;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("F");
+                trace::record(trace::RX_FRAME);
 #endif
 
                 // Reload the just-written payload so the user sees exactly what landed in EEPROM.
@@ -425,10 +423,8 @@ void ModemReceiver::process()
                 if (store_pages_used_ > 0)
                 {
                     storage.save(store_pages_[0]);
-                    for (uint8_t p = 1; p < store_pages_used_; ++p)
-                    {
-                        storage.append(store_pages_[p]);
-                    }
+                    // Flush the remaining pages as one acknowledge-polled burst.
+                    storage.appendPages(store_pages_[1], store_pages_used_ - 1, onBufferedPageStored);
                 }
                 storage.sync();
                 state_ = START1;
@@ -440,7 +436,7 @@ void ModemReceiver::process()
                 diaglog::markFrame();
                 diag_events_ |= DIAG_EVENT_FRAME;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("F");
+                trace::record(trace::RX_FRAME);
 #endif
 
                 // Reload the just-written payload so the display path matches the persisted bytes.
@@ -459,7 +455,7 @@ void ModemReceiver::process()
                 diaglog::markFrame();
                 diag_events_ |= DIAG_EVENT_FRAME;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("F");
+                trace::record(trace::RX_FRAME);
 #endif
 #ifdef DIAG_RX
                 // If we captured some bytes but didn't reach 12 yet, show what we have
@@ -472,6 +468,7 @@ void ModemReceiver::process()
                     anim.delay = 0;
                     anim.direction = 0;
                     anim.repeat = 0;
+                    anim.brightness = 0;
                     anim.data = diag_hex;
                     display.show(&anim);
                     diag_showing_hex = true;
@@ -496,7 +493,7 @@ void ModemReceiver::process()
                 rx_pos_ = 0;
                 diag_events_ |= DIAG_EVENT_PATTERN2;
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-                logRxEvent("2");
+                trace::record(trace::RX_PATTERN2);
 #endif
             }
             else
@@ -520,7 +517,7 @@ void ModemReceiver::process()
             diag_length_ = remaining_;
             diaglog::setLength(remaining_);
 #if defined(JP1_DEBUG_SERIAL) && defined(JP1_DEBUG_RX_EVENTS)
-            logRxLength(remaining_);
+            trace::record(trace::RX_LENGTH, remaining_);
 #endif
             break;
         case META1:
@@ -40,6 +40,13 @@ public:
      */
     bool hasFrameComplete();
 
+    /**
+     * Report whether the parser is waiting for a new transfer.
+     *
+     * @returns `true` when no transfer is in progress.
+     */
+    bool isIdle() const { return state_ == START1; }
+
     /**
      * Copy the most recent decoded bytes into an eight-byte buffer.
      *
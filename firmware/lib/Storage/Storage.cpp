@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include "Storage.h"
+#include "Trace.h"
 #include "TwiBus.h"
 
 Storage storage;
@@ -76,6 +77,7 @@ bool Storage::hasData()
 
 void Storage::load(uint8_t idx, uint8_t *data)
 {
+    trace::record(trace::STORAGE_LOAD, idx);
     twiBus.read(I2C_EEPROM_ADDR, 0, 1 + idx, 1, &page_offset);
 
     /*
@@ -121,6 +123,7 @@ void Storage::save(uint8_t *data)
         if (first_free_page < 248)
         {
             num_anims++;
+            trace::record(trace::STORAGE_SAVE, first_free_page);
             // Persist the page pointer immediately so later append() calls know where the pattern starts.
             twiBus.write(I2C_EEPROM_ADDR, 0, num_anims, 1, &first_free_page);
             append(data);
@@ -137,6 +140,45 @@ void Storage::append(uint8_t *data)
         // - it's easier to just write the whole page and skip the trailing
         // garbage when reading.
         twiBus.write(I2C_EEPROM_ADDR, 1 + (first_free_page / 8), (first_free_page % 8) * 32, 32, data);
+        trace::record(trace::STORAGE_APPEND, first_free_page);
         first_free_page++;
     }
 }
+
+uint8_t Storage::appendPages(uint8_t *data, uint8_t count, PageWriteCallback onPage)
+{
+    uint8_t written = 0;
+
+    for (uint8_t page = 0; page < count; page++)
+    {
+        bool ok = false;
+
+        /*
+         * Acknowledge polling replaces the fixed 500 us retry backoff in
+         * TwiBus::write(), so a batch costs one transfer plus one EEPROM
+         * write cycle per page and nothing more.
+         */
+        if (first_free_page < 248 && twiBus.waitReady(I2C_EEPROM_ADDR) == TwiBus::OK)
+        {
+            ok = twiBus.write(I2C_EEPROM_ADDR, 1 + (first_free_page / 8), (first_free_page % 8) * 32, 32, data + (uint16_t)page * 32) == TwiBus::OK;
+        }
+
+        if (ok)
+        {
+            first_free_page++;
+            written++;
+        }
+
+        if (onPage)
+        {
+            onPage(page, ok);
+        }
+
+        if (!ok)
+        {
+            break;
+        }
+    }
+
+    return written;
+}
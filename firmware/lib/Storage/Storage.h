@@ -2,6 +2,14 @@
 
 #define I2C_EEPROM_ADDR 0x50
 
+/**
+ * Per-page completion callback for Storage::appendPages().
+ *
+ * @param page Zero-based page index inside the submitted batch.
+ * @param ok `true` when the page was acknowledged by the EEPROM.
+ */
+typedef void (*PageWriteCallback)(uint8_t page, bool ok);
+
 class Storage
 {
 private:
@@ -113,6 +121,19 @@ public:
      * @param data pattern data. Must be at least 32 bytes
      */
     void append(uint8_t *data);
+
+    /**
+     * Append a batch of consecutive 32-byte pages after the most recently
+     * written block. Pages are written back to back, and each write starts
+     * as soon as the EEPROM finishes the previous internal write cycle.
+     * The batch stops at the first failed page.
+     *
+     * @param data count * 32 bytes of pattern data
+     * @param count number of pages to write
+     * @param onPage optional callback invoked once per attempted page
+     * @return number of pages written successfully
+     */
+    uint8_t appendPages(uint8_t *data, uint8_t count, PageWriteCallback onPage = nullptr);
 };
 
 extern Storage storage;
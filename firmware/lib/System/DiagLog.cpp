@@ -3,58 +3,92 @@
 #ifdef DIAG_INTERNAL_LOG
 #include <avr/eeprom.h>
 
+namespace diaglog
+{
+Slot EEMEM ee_slots[2];
+static_assert(sizeof(ee_slots) <= 64, "both diagnostic slots must fit the 64-byte internal EEPROM");
+}
+
+/*
+ * The counters live in SRAM while the receiver runs. An internal EEPROM byte
+ * write takes about 3.4 ms, so the old write-through log stalled the receive
+ * loop once for every state change and counter step. Now a completed or
+ * interrupted frame only schedules a flush, and service() copies the record
+ * into the older of the two slots one byte write per main loop pass without
+ * waiting for the EEPROM. The flush writes from a snapshot taken when it
+ * starts, so counters that move during the ~100 ms it takes (and two-byte
+ * fields in particular) cannot tear the record. A brown-out mid-flush leaves
+ * that slot without a matching commit byte, so the previous record stays the
+ * newest valid one.
+ */
 namespace
 {
-struct DiagLogLayout
-{
-    uint8_t magic;
-    uint8_t version;
-    uint8_t reset_cause;
-    uint8_t last_state;
-    uint8_t start_count;
-    uint8_t pattern1_count;
-    uint8_t pattern2_count;
-    uint8_t end_count;
-    uint8_t frame_count;
-    uint8_t save_count;
-    uint8_t append_count;
-    uint8_t num_patterns;
-    uint8_t first_hdr0;
-    uint8_t first_hdr1;
-    uint8_t first_meta2;
-    uint8_t first_meta3;
-    uint8_t loaded_hdr0;
-    uint8_t loaded_hdr1;
-    uint8_t loaded_meta2;
-    uint8_t loaded_meta3;
-    uint8_t show_ok;
-    uint8_t reserved;
-    uint16_t length;
-};
-
-DiagLogLayout EEMEM ee_diag_log;
-constexpr uint8_t kMagic = 0xD1;
-constexpr uint8_t kVersion = 0x01;
+using diaglog::ee_slots;
+using diaglog::Slot;
+
+constexpr uint8_t kIdle = 0xFF;
+
+diaglog::Layout ram_log;
+// Record being flushed; sequence and commit bytes are filled in when a flush starts.
+Slot flush_copy;
+uint8_t newest_slot = 1;
+uint8_t newest_seq = 0;
+uint8_t flush_slot = 0;
+uint8_t flush_pos = kIdle;
+bool flush_requested = false;
+bool dirty = false;
 
 /**
- * Clear one EEPROM-backed diagnostic byte.
+ * Check whether one EEPROM slot holds a completely written record.
  *
- * @param field EEPROM field to reset.
+ * @param slot Slot index.
+ * @returns `true` when the commit byte matches the sequence and the layout is current.
  */
-void resetField(uint8_t &field)
+bool slotValid(uint8_t slot)
 {
-    eeprom_update_byte(&field, 0);
+    const uint8_t seq = eeprom_read_byte(&ee_slots[slot].seq);
+    return eeprom_read_byte(&ee_slots[slot].commit) == seq &&
+           eeprom_read_byte(&ee_slots[slot].log.magic) == diaglog::kMagic &&
+           eeprom_read_byte(&ee_slots[slot].log.version) == diaglog::kVersion;
+}
+
+/**
+ * Find the newest valid slot so new records continue its sequence.
+ */
+void scanSlots()
+{
+    const bool valid0 = slotValid(0);
+    const bool valid1 = slotValid(1);
+    const uint8_t seq0 = eeprom_read_byte(&ee_slots[0].seq);
+    const uint8_t seq1 = eeprom_read_byte(&ee_slots[1].seq);
+
+    if (valid0 && (!valid1 || static_cast<int8_t>(seq0 - seq1) > 0))
+    {
+        newest_slot = 0;
+        newest_seq = seq0;
+    }
+    else if (valid1)
+    {
+        newest_slot = 1;
+        newest_seq = seq1;
+    }
+    else
+    {
+        // Nothing usable yet; the first record goes to slot 0.
+        newest_slot = 1;
+        newest_seq = 0;
+    }
 }
 
 /**
- * Increment one EEPROM-backed diagnostic byte in place.
+ * Increment one SRAM counter and mark the record for the next flush.
  *
- * @param field EEPROM field to increment.
+ * @param field Counter to increment.
  */
-void incrementField(uint8_t &field)
+void increment(uint8_t &field)
 {
-    uint8_t value = eeprom_read_byte(&field);
-    eeprom_update_byte(&field, static_cast<uint8_t>(value + 1));
+    field++;
+    dirty = true;
 }
 } // namespace
 
@@ -62,64 +96,86 @@ namespace diaglog
 {
 void reset(uint8_t resetCause)
 {
-    eeprom_update_byte(&ee_diag_log.magic, kMagic);
-    eeprom_update_byte(&ee_diag_log.version, kVersion);
-    eeprom_update_byte(&ee_diag_log.reset_cause, resetCause);
-    resetField(ee_diag_log.last_state);
-    resetField(ee_diag_log.start_count);
-    resetField(ee_diag_log.pattern1_count);
-    resetField(ee_diag_log.pattern2_count);
-    resetField(ee_diag_log.end_count);
-    resetField(ee_diag_log.frame_count);
-    resetField(ee_diag_log.save_count);
-    resetField(ee_diag_log.append_count);
-    resetField(ee_diag_log.num_patterns);
-    resetField(ee_diag_log.first_hdr0);
-    resetField(ee_diag_log.first_hdr1);
-    resetField(ee_diag_log.first_meta2);
-    resetField(ee_diag_log.first_meta3);
-    resetField(ee_diag_log.loaded_hdr0);
-    resetField(ee_diag_log.loaded_hdr1);
-    resetField(ee_diag_log.loaded_meta2);
-    resetField(ee_diag_log.loaded_meta3);
-    resetField(ee_diag_log.show_ok);
-    resetField(ee_diag_log.reserved);
-    eeprom_update_word(&ee_diag_log.length, 0);
+    scanSlots();
+
+    uint8_t *bytes = reinterpret_cast<uint8_t *>(&ram_log);
+    for (uint8_t i = 0; i < sizeof(ram_log); ++i)
+    {
+        bytes[i] = 0;
+    }
+    ram_log.magic = kMagic;
+    ram_log.version = kVersion;
+    ram_log.reset_cause = resetCause;
+    dirty = true;
+
+    // The boot record goes to the older slot, so the last record of the previous run survives until the next flush.
+    flush();
 }
 
 void setState(uint8_t state)
 {
-    eeprom_update_byte(&ee_diag_log.last_state, state);
+    if (ram_log.last_state != state)
+    {
+        ram_log.last_state = state;
+        dirty = true;
+    }
 }
 
 void markStart()
 {
-    incrementField(ee_diag_log.start_count);
+    increment(ram_log.start_count);
 }
 
 void markPattern1()
 {
-    incrementField(ee_diag_log.pattern1_count);
+    increment(ram_log.pattern1_count);
 }
 
 void markPattern2()
 {
-    incrementField(ee_diag_log.pattern2_count);
+    increment(ram_log.pattern2_count);
 }
 
 void markEnd()
 {
-    incrementField(ee_diag_log.end_count);
+    increment(ram_log.end_count);
 }
 
 void markFrame()
 {
-    incrementField(ee_diag_log.frame_count);
+    increment(ram_log.frame_count);
+    flush_requested = true;
+}
+
+void markTimeout()
+{
+    increment(ram_log.timeout_count);
+    flush_requested = true;
 }
 
 void setLength(uint16_t length)
 {
-    eeprom_update_word(&ee_diag_log.length, length);
+    ram_log.length = length;
+    dirty = true;
+}
+
+void setStackFree(uint16_t bytes)
+{
+    if (ram_log.stack_free != bytes)
+    {
+        ram_log.stack_free = bytes;
+        dirty = true;
+    }
+}
+
+void markTaskOverrun(uint8_t task)
+{
+    if (ram_log.task_overruns != 0xFF)
+    {
+        ram_log.task_overruns++;
+    }
+    ram_log.overrun_task = task;
+    dirty = true;
 }
 
 void captureFirstPage(const uint8_t *page32)
@@ -129,33 +185,93 @@ void captureFirstPage(const uint8_t *page32)
         return;
     }
 
-    eeprom_update_byte(&ee_diag_log.first_hdr0, page32[0]);
-    eeprom_update_byte(&ee_diag_log.first_hdr1, page32[1]);
-    eeprom_update_byte(&ee_diag_log.first_meta2, page32[2]);
-    eeprom_update_byte(&ee_diag_log.first_meta3, page32[3]);
+    ram_log.first_hdr0 = page32[0];
+    ram_log.first_hdr1 = page32[1];
+    ram_log.first_meta2 = page32[2];
+    ram_log.first_meta3 = page32[3];
+    dirty = true;
 }
 
 void markSave()
 {
-    incrementField(ee_diag_log.save_count);
+    increment(ram_log.save_count);
 }
 
 void markAppend()
 {
-    incrementField(ee_diag_log.append_count);
+    increment(ram_log.append_count);
 }
 
 void captureLoaded(const uint8_t *payload, uint8_t numPatterns, bool shown)
 {
     if (payload)
     {
-        eeprom_update_byte(&ee_diag_log.loaded_hdr0, payload[0]);
-        eeprom_update_byte(&ee_diag_log.loaded_hdr1, payload[1]);
-        eeprom_update_byte(&ee_diag_log.loaded_meta2, payload[2]);
-        eeprom_update_byte(&ee_diag_log.loaded_meta3, payload[3]);
+        ram_log.loaded_hdr0 = payload[0];
+        ram_log.loaded_hdr1 = payload[1];
+        ram_log.loaded_meta2 = payload[2];
+        ram_log.loaded_meta3 = payload[3];
+    }
+    ram_log.num_patterns = numPatterns;
+    ram_log.show_ok = shown ? 1 : 0;
+    dirty = true;
+}
+
+void service()
+{
+    if (flush_pos == kIdle)
+    {
+        if (!flush_requested)
+        {
+            return;
+        }
+        flush_requested = false;
+        dirty = false;
+        flush_slot = newest_slot ^ 1;
+        flush_copy.seq = static_cast<uint8_t>(newest_seq + 1);
+        flush_copy.log = ram_log;
+        flush_copy.commit = flush_copy.seq;
+        flush_pos = 0;
+    }
+
+    if (!eeprom_is_ready())
+    {
+        return;
+    }
+
+    // Skip bytes that already match and start at most one write.
+    const uint8_t *source = reinterpret_cast<const uint8_t *>(&flush_copy);
+    uint8_t *base = reinterpret_cast<uint8_t *>(&ee_slots[flush_slot]);
+    while (flush_pos < sizeof(Slot))
+    {
+        const uint8_t value = source[flush_pos];
+        uint8_t *addr = base + flush_pos++;
+        if (eeprom_read_byte(addr) != value)
+        {
+            eeprom_write_byte(addr, value);
+            break;
+        }
+    }
+
+    if (flush_pos == sizeof(Slot))
+    {
+        // The commit byte is on its way; the slot now holds the newest record.
+        newest_slot = flush_slot;
+        newest_seq = flush_copy.seq;
+        flush_pos = kIdle;
+    }
+}
+
+void flush()
+{
+    if (dirty)
+    {
+        flush_requested = true;
+    }
+    while (flush_pos != kIdle || flush_requested)
+    {
+        service();
     }
-    eeprom_update_byte(&ee_diag_log.num_patterns, numPatterns);
-    eeprom_update_byte(&ee_diag_log.show_ok, shown ? 1 : 0);
+    eeprom_busy_wait();
 }
 } // namespace diaglog
 #endif
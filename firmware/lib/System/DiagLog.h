@@ -4,6 +4,63 @@
 
 namespace diaglog
 {
+/**
+ * One diagnostic record as stored in the internal EEPROM. The firmware keeps
+ * it in SRAM while running and only copies it out from flush() and service().
+ */
+struct Layout
+{
+    uint8_t magic;
+    uint8_t version;
+    uint8_t reset_cause;
+    uint8_t last_state;
+    uint8_t start_count;
+    uint8_t pattern1_count;
+    uint8_t pattern2_count;
+    uint8_t end_count;
+    uint8_t frame_count;
+    uint8_t save_count;
+    uint8_t append_count;
+    uint8_t num_patterns;
+    uint8_t first_hdr0;
+    uint8_t first_hdr1;
+    uint8_t first_meta2;
+    uint8_t first_meta3;
+    uint8_t loaded_hdr0;
+    uint8_t loaded_hdr1;
+    uint8_t loaded_meta2;
+    uint8_t loaded_meta3;
+    uint8_t show_ok;
+    uint8_t timeout_count;
+    uint16_t length;
+    uint16_t stack_free;
+    uint8_t task_overruns;
+    uint8_t overrun_task;
+};
+
+/**
+ * One of the two alternating EEPROM record slots. A flush writes `seq` first
+ * and `commit` last, so a slot is complete only while both match; of two
+ * complete slots the one whose `seq` is ahead by a signed 8-bit difference is
+ * the newest, which keeps working across the 255 -> 0 wrap.
+ */
+struct Slot
+{
+    uint8_t seq;
+    Layout log;
+    uint8_t commit;
+};
+
+constexpr uint8_t kMagic = 0xD1;
+constexpr uint8_t kVersion = 0x04;
+
+#ifdef DIAG_INTERNAL_LOG
+/**
+ * EEPROM copy of the log, at the start of the internal EEPROM.
+ */
+extern Slot ee_slots[2];
+#endif
+
 /**
  * Reset the internal diagnostic log and record the reset cause.
  *
@@ -63,7 +120,8 @@ inline void markEnd() {}
 #endif
 
 /**
- * Increment the diagnostic counter for completed frames.
+ * Increment the diagnostic counter for completed frames and schedule a flush
+ * of the log to the internal EEPROM.
  */
 #ifdef DIAG_INTERNAL_LOG
 void markFrame();
@@ -71,6 +129,16 @@ void markFrame();
 inline void markFrame() {}
 #endif
 
+/**
+ * Increment the diagnostic counter for interrupted transfers and schedule a
+ * flush of the log to the internal EEPROM.
+ */
+#ifdef DIAG_INTERNAL_LOG
+void markTimeout();
+#else
+inline void markTimeout() {}
+#endif
+
 /**
  * Record the most recent decoded payload length.
  *
@@ -82,6 +150,28 @@ void setLength(uint16_t length);
 inline void setLength(uint16_t) {}
 #endif
 
+/**
+ * Record the stack headroom left since boot.
+ *
+ * @param bytes Painted bytes the stack has never reached.
+ */
+#ifdef DIAG_INTERNAL_LOG
+void setStackFree(uint16_t bytes);
+#else
+inline void setStackFree(uint16_t) {}
+#endif
+
+/**
+ * Count one scheduler task that ran over its budget.
+ *
+ * @param task Id of the task.
+ */
+#ifdef DIAG_INTERNAL_LOG
+void markTaskOverrun(uint8_t task);
+#else
+inline void markTaskOverrun(uint8_t) {}
+#endif
+
 /**
  * Capture the first received 32-byte page for post-mortem inspection.
  *
@@ -123,4 +213,23 @@ void captureLoaded(const uint8_t *payload, uint8_t numPatterns, bool shown);
 #else
 inline void captureLoaded(const uint8_t *, uint8_t, bool) {}
 #endif
+
+/**
+ * Advance a scheduled flush by at most one EEPROM byte write. Never waits for
+ * the EEPROM, so it is safe to call on every main loop pass, even mid-transfer.
+ */
+#ifdef DIAG_INTERNAL_LOG
+void service();
+#else
+inline void service() {}
+#endif
+
+/**
+ * Write the log to the internal EEPROM and wait until it is committed.
+ */
+#ifdef DIAG_INTERNAL_LOG
+void flush();
+#else
+inline void flush() {}
+#endif
 }
@@ -0,0 +1,147 @@
+#include "Scheduler.h"
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "DiagLog.h"
+#include "Trace.h"
+
+namespace
+{
+const sched::Task *table = nullptr;
+sched::TaskState *states = nullptr;
+uint8_t task_count = 0;
+void (*run_task)(uint8_t) = nullptr;
+#if SCHED_STATS
+bool discard_run = false;
+#endif
+
+/**
+ * Increment a saturating 8-bit counter.
+ *
+ * @param counter Counter to increment.
+ */
+inline void bump(uint8_t &counter)
+{
+    if (counter != 0xFF)
+    {
+        counter++;
+    }
+}
+
+/**
+ * Run one task and account its run time.
+ *
+ * @param index Table index.
+ * @param id Task id.
+ */
+void runTask(uint8_t index, uint8_t id)
+{
+#if SCHED_STATS
+    discard_run = false;
+    const uint16_t start = static_cast<uint16_t>(micros());
+    run_task(id);
+    const uint16_t took = static_cast<uint16_t>(micros()) - start;
+    if (discard_run)
+    {
+        return;
+    }
+
+    sched::TaskState &state = states[index];
+    if (took > pgm_read_word(&table[index].budget_us))
+    {
+        bump(state.overruns);
+        diaglog::markTaskOverrun(id);
+        if (took > state.worst_us)
+        {
+            // Task id in the top nibble, run time in 16 us units below it.
+            const uint16_t units = took >> 4;
+            trace::record(trace::TASK_OVERRUN, static_cast<uint16_t>((id << 12) | (units < 0x0FFF ? units : 0x0FFF)));
+        }
+    }
+    if (took > state.worst_us)
+    {
+        state.worst_us = took;
+    }
+#else
+    (void)index;
+    run_task(id);
+#endif
+}
+} // namespace
+
+void sched::begin(const Task *tasks, TaskState *taskStates, uint8_t count, void (*run)(uint8_t id))
+{
+    table = tasks;
+    states = taskStates;
+    task_count = count;
+    run_task = run;
+    resync();
+}
+
+void sched::runPass()
+{
+    bool housekeeping_ran = false;
+    for (uint8_t i = 0; i < task_count; ++i)
+    {
+        const uint16_t period = pgm_read_word(&table[i].period_ms);
+        if (period != 0)
+        {
+            if (housekeeping_ran)
+            {
+                continue;
+            }
+            TaskState &state = states[i];
+            const uint16_t now = static_cast<uint16_t>(millis());
+            const int16_t behind = static_cast<int16_t>(now - state.due_ms);
+            if (behind < 0)
+            {
+                continue;
+            }
+#if SCHED_STATS
+            if (behind >= static_cast<int16_t>(period))
+            {
+                bump(state.late);
+            }
+#endif
+            // Keep the release grid, but do not replay releases that were missed.
+            state.due_ms += period;
+            if (static_cast<int16_t>(now - state.due_ms) >= 0)
+            {
+                state.due_ms = now + period;
+            }
+            housekeeping_ran = true;
+        }
+        runTask(i, pgm_read_byte(&table[i].id));
+    }
+}
+
+void sched::resync()
+{
+    const uint16_t now = static_cast<uint16_t>(millis());
+    for (uint8_t i = 0; i < task_count; ++i)
+    {
+        states[i].due_ms = now;
+    }
+#if SCHED_STATS
+    discard_run = true;
+#endif
+}
+
+#if SCHED_STATS
+void sched::report()
+{
+    for (uint8_t i = 0; i < task_count; ++i)
+    {
+        const uint16_t id = pgm_read_byte(&table[i].id);
+        if (states[i].overruns != 0)
+        {
+            trace::record(trace::TASK_STATS, static_cast<uint16_t>((id << 8) | states[i].overruns));
+        }
+        if (states[i].late != 0)
+        {
+            trace::record(trace::TASK_LATE, static_cast<uint16_t>((id << 8) | states[i].late));
+        }
+    }
+}
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Cooperative scheduler for System::loop(). The caller owns a static task
+ * table in PROGMEM, ordered by priority, and a matching array of TaskState in
+ * SRAM. Each pass runs every critical task (period 0) and then at most one
+ * due housekeeping task, the first in table order, so one pass costs the
+ * critical work plus a single housekeeping budget. A housekeeping task is
+ * released every period; starting it a full period after its release
+ * misses its deadline.
+ *
+ * With SCHED_STATS each run is timed with micros() against the task's
+ * budget. Runs over budget count as overruns, report a TASK_OVERRUN trace
+ * record whenever they set a new worst time, and feed the DiagLog overrun
+ * counters.
+ */
+
+#ifndef SCHED_STATS
+#if (defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)) || defined(DIAG_INTERNAL_LOG)
+#define SCHED_STATS 1
+#else
+#define SCHED_STATS 0
+#endif
+#endif
+
+namespace sched
+{
+/**
+ * Constant part of one task table entry, kept in PROGMEM.
+ */
+struct Task
+{
+    uint8_t id;         // Passed to the run callback and used in trace records
+    uint16_t period_ms; // 0 runs the task on every pass
+    uint16_t budget_us; // Longer runs count as overruns
+};
+
+/**
+ * Per-task bookkeeping in SRAM. Zero-initialise it; begin() sets it up.
+ */
+struct TaskState
+{
+    uint16_t due_ms; // Low 16 bits of millis() of the next release
+#if SCHED_STATS
+    uint16_t worst_us; // Longest run so far
+    uint8_t overruns;  // Runs over budget, saturating
+    uint8_t late;      // Deadline misses, saturating
+#endif
+};
+
+/**
+ * Install the task table and release every housekeeping task now.
+ *
+ * @param tasks PROGMEM task table, highest priority first.
+ * @param states SRAM state, one entry per task.
+ * @param count Number of tasks.
+ * @param run Callback that runs the task with the given id.
+ */
+void begin(const Task *tasks, TaskState *states, uint8_t count, void (*run)(uint8_t id));
+
+/**
+ * Run the critical tasks and at most one due housekeeping task.
+ */
+void runPass();
+
+/**
+ * Release every housekeeping task now and exclude the running task's time
+ * from its statistics. Call after sleeping inside a task.
+ */
+void resync();
+
+#if SCHED_STATS
+/**
+ * Report the tasks with overruns or deadline misses as TASK_STATS and
+ * TASK_LATE trace records.
+ */
+void report();
+#else
+inline void report() {}
+#endif
+}
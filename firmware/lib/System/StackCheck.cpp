@@ -0,0 +1,37 @@
+#include "StackCheck.h"
+
+#if STACK_CHECK
+
+// Linker symbols: first byte after the static data, and the initial stack top (RAMEND).
+extern uint8_t _end;
+extern uint8_t __stack;
+
+namespace
+{
+constexpr uint8_t kPaint = 0xC5;
+}
+
+/**
+ * Paint the free SRAM. Runs from .init3, after .init2 has set up the stack
+ * pointer and the zero register and before anything was pushed, so the loop
+ * may run up to RAMEND. It must not call functions or use the stack.
+ */
+extern "C" void stackcheck_paint() __attribute__((naked, used, section(".init3")));
+extern "C" void stackcheck_paint()
+{
+    for (uint8_t *p = &_end; p <= &__stack; ++p)
+    {
+        *p = kPaint;
+    }
+}
+
+uint16_t stackcheck::headroom()
+{
+    const uint8_t *p = &_end;
+    while (p <= &__stack && *p == kPaint)
+    {
+        ++p;
+    }
+    return static_cast<uint16_t>(p - &_end);
+}
+#endif
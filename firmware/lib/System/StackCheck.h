@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Stack high-water check. Before main() runs, every SRAM byte between the end
+ * of the static data (.data, .bss, .noinit) and the top of the stack is
+ * filled with a paint byte. The stack grows down into that area, so the
+ * paint that survives at its bottom is the headroom the deepest call chain
+ * so far has left. A pushed byte that happens to equal the paint value can
+ * overstate the headroom by that byte.
+ *
+ * Only builds with a channel that reports the headroom (JP1 trace or the
+ * internal diagnostic log) paint; the others skip the startup loop.
+ */
+#ifndef STACK_CHECK
+#if (defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)) || defined(DIAG_INTERNAL_LOG)
+#define STACK_CHECK 1
+#else
+#define STACK_CHECK 0
+#endif
+#endif
+
+#if STACK_CHECK
+namespace stackcheck
+{
+/**
+ * Count the painted bytes that the stack has never reached since boot.
+ *
+ * @returns Bytes between the static data and the deepest stack use so far.
+ */
+uint16_t headroom();
+}
+#endif
@@ -1,8 +1,12 @@
 #include "System.h"
+#include "Buttons.h"
 #include "DiagLog.h"
 #include "Display.h"
 #include "DebugSerial.h"
+#include "Scheduler.h"
+#include "StackCheck.h"
 #include "static_patterns.h"
+#include "Trace.h"
 #include <Arduino.h>
 #include <avr/interrupt.h>
 #include <avr/power.h>
@@ -16,21 +20,35 @@
 
 System blinkenstar;
 
-// Buttons are wired to Port C pins: PC3 (pin 26) and PC7 (pin 20)
-// Use direct port access to avoid any Arduino pin mapping ambiguity
+// Buttons are wired to Port C pins: PC3 (pin 26) and PC7 (pin 20). The
+// display timer debounces them; before display.enable() and while it is
+// disabled for power-down, these read the pins directly.
 /**
  * Return whether button 1 is currently pressed.
  *
- * @returns `true` when PC3 reads low.
+ * @returns `true` when PC3 is (debounced) low.
  */
-static inline bool button1_is_low() { return (PINC & _BV(PC3)) == 0; }
+static inline bool button1_is_low() { return buttons.isDown(Buttons::BUTTON_1); }
 
 /**
  * Return whether button 2 is currently pressed.
  *
- * @returns `true` when PC7 reads low.
+ * @returns `true` when PC7 is (debounced) low.
  */
-static inline bool button2_is_low() { return (PINC & _BV(PC7)) == 0; }
+static inline bool button2_is_low() { return buttons.isDown(Buttons::BUTTON_2); }
+
+/**
+ * Report the stack high-water mark over JP1 and in the internal diagnostic log.
+ * Builds without either channel skip the SRAM scan.
+ */
+static void reportStackHeadroom()
+{
+#if STACK_CHECK
+    const uint16_t bytes = stackcheck::headroom();
+    trace::record(trace::STACK_FREE, bytes);
+    diaglog::setStackFree(bytes);
+#endif
+}
 
 #if defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE)
 /**
@@ -256,15 +274,13 @@ void System::initialize()
     PORTC |= _BV(PC3) | _BV(PC7);       // enable pull-ups
 
     debuglog::begin();
-    debuglog::println("BOOT");
-    debuglog::print("MCUSR=0x");
-    debuglog::printlnHex8(reset_cause);
+    trace::record(trace::BOOT, reset_cause);
     diaglog::reset(reset_cause);
 #if defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE) && !defined(NO_STORED_PATTERN_BOOT_RESTORE)
     const bool factory_reset_requested = resetStorageIfRequested();
 #endif
 #ifdef JP1_DEBUG_SKIP_MODEM
-    debuglog::println("MODEM SKIP");
+    trace::record(trace::MODEM_SKIP);
 #endif
 
     // Initialize display
@@ -301,7 +317,7 @@ void System::initialize()
     else if (mcusr & _BV(EXTRF)) { rst_text[n++] = 'E'; rst_text[n++] = 'X'; rst_text[n++] = 'T'; }
     else if (mcusr & _BV(PORF)) { rst_text[n++] = 'P'; rst_text[n++] = 'O'; rst_text[n++] = 'R'; }
     else { rst_text[n++] = 'O'; rst_text[n++] = 'K'; }
-    animation_t a; a.type = AnimationType::TEXT; a.length = n; a.speed = 10; a.delay = 0; a.direction = 0; a.repeat = 0; a.data = rst_text;
+    animation_t a; a.type = AnimationType::TEXT; a.length = n; a.speed = 10; a.delay = 0; a.direction = 0; a.repeat = 0; a.brightness = 0; a.data = rst_text;
     display.show(&a);
   #else
     // Store env: defer modem start slightly to let display stabilize
@@ -311,17 +327,114 @@ void System::initialize()
 #endif
 #endif
 
+    startTasks_();
+
     // Enable interrupts globally
     interrupts();
 }
 
-void System::loop()
+/*
+ * Main loop tasks, highest priority first. The receiver and the display run
+ * on every pass; of the housekeeping tasks below them at most one runs per
+ * pass, so a pass never pays for all of them at once. Budgets are the run
+ * times a task is expected to stay within; SCHED_STATS builds report longer
+ * runs (see docs/firmware.md#main-loop-tasks).
+ */
+static const sched::Task tasks[] PROGMEM = {
+#ifdef ENABLE_MODEM
+    {System::TASK_RECEIVE, 0, 4000},
+#endif
+    {System::TASK_DISPLAY, 0, 4000},
+    {System::TASK_BUTTONS, 10, 500},
+#ifdef ENABLE_MODEM
+    {System::TASK_MODEM_CONTROL, 10, 500},
+#endif
+#if defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE)
+    {System::TASK_BROWSE, 10, 4000},
+#endif
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+    {System::TASK_TRACE, 2, 500},
+#endif
+#ifdef DIAG_INTERNAL_LOG
+    {System::TASK_DIAGLOG, 4, 200},
+#endif
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT)
+    {System::TASK_HEARTBEAT, 20, 2000},
+#endif
+#ifdef SLEEP_BETWEEN_REPEATS
+    {System::TASK_PAUSE_SLEEP, 10, 500},
+#endif
+};
+
+static constexpr uint8_t kTaskCount = sizeof(tasks) / sizeof(tasks[0]);
+static sched::TaskState task_states[kTaskCount];
+
+void System::startTasks_()
 {
-#if (defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE)) || (defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT))
-    const unsigned long loop_now = millis();
+    sched::begin(tasks, task_states, kTaskCount, &System::runTask_);
+}
+
+void System::runTask_(uint8_t id)
+{
+    switch (id)
+    {
+#ifdef ENABLE_MODEM
+    case TASK_RECEIVE:
+        blinkenstar.receiveTask_();
+        break;
+    case TASK_MODEM_CONTROL:
+        blinkenstar.modemControlTask_();
+        break;
+#endif
+    case TASK_DISPLAY:
+        blinkenstar.displayTask_();
+        break;
+    case TASK_BUTTONS:
+        blinkenstar.buttonsTask_();
+        break;
+#if defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE)
+    case TASK_BROWSE:
+        blinkenstar.browseTask_();
+        break;
 #endif
+    case TASK_TRACE:
+        // Queue at most one JP1 trace record per run, and keep the UART interrupt load out of a transfer.
+#ifdef ENABLE_MODEM
+        if (!blinkenstar.modem_enabled || modemReceiver.isIdle())
+#endif
+        {
+            trace::drain();
+        }
+        break;
+    case TASK_DIAGLOG:
+        // Copy a scheduled diagnostic record to the internal EEPROM one non-blocking byte write at a time.
+        diaglog::service();
+        break;
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT)
+    case TASK_HEARTBEAT:
+        blinkenstar.heartbeatTask_();
+        break;
+#endif
+#ifdef SLEEP_BETWEEN_REPEATS
+    case TASK_PAUSE_SLEEP:
+        blinkenstar.sleepThroughPause_();
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+void System::loop()
+{
+    sched::runPass();
+}
 
 #if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT)
+void System::heartbeatTask_()
+{
+    const unsigned long loop_now = millis();
+
 #if defined(ENABLE_MODEM) && defined(JP1_DEBUG_TONE_DIAG)
     const bool tone_present = g_modem.isTonePresent();
     if (tone_present)
@@ -359,17 +472,17 @@ void System::loop()
 #endif
         debug_heartbeat_at_ms = loop_now + 1000;
     }
+}
 #endif
 
-    // Optional: receive-mode toggle + processing
 #ifdef ENABLE_MODEM
+void System::modemControlTask_()
+{
 #ifndef RX_ALWAYS_ON
     // Toggle modem/receiver on long-press of Button2 (PC7)
     if (button2_is_low())
     {
-        if (btn2_hold < RECEIVE_HOLD_TICKS)
-            btn2_hold++;
-        else if (!btn2_latched)
+        if (!btn2_latched && buttons.heldMs(Buttons::BUTTON_2) >= RECEIVE_HOLD_MS)
         {
             // Toggle state once per long hold
             modem_enabled = !modem_enabled;
@@ -387,13 +500,12 @@ void System::loop()
 #ifndef RX_NO_STORAGE
             // A receive-mode toggle is not also a browse action on release.
             button_mask_ = BUTTON_NONE;
-            button_debounce_until_ms_ = loop_now + BUTTON_BROWSE_COOLDOWN_MS;
+            button_debounce_until_ms_ = millis() + BUTTON_BROWSE_COOLDOWN_MS;
 #endif
         }
     }
     else
     {
-        btn2_hold = 0;
         btn2_latched = false;
     }
 #endif
@@ -414,7 +526,7 @@ void System::loop()
         {
             modem_enabled = true;
             modemReceiver.begin();
-            debuglog::println("MODEM ON");
+            trace::record(trace::MODEM_ON);
         }
     }
 #endif
@@ -432,8 +544,46 @@ void System::loop()
     }
   #endif
 #endif
+}
+
+void System::receiveTask_()
+{
+    if (modem_enabled)
+    {
+        // Process first; if a frame completed, leave receive mode and keep the shown pattern
+        modemReceiver.process();
+        if (modemReceiver.hasFrameComplete())
+        {
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT) && defined(JP1_DEBUG_TONE_DIAG)
+            printToneSummary();
+            debug_tone_report_pending_ = false;
+            debug_tone_active_ = false;
+#endif
+            // Drop back out of receive mode once one transfer has been fully decoded and displayed.
+            modem_enabled = false;
+#ifndef RX_NO_STORAGE
+            current_pattern_index_ = 0;
+#endif
+            modemReceiver.end();
+            trace::record(trace::FRAME_DONE);
+            reportStackHeadroom();
+            sched::report();
+            display.setIndicator(7, 7, 20); // disabled
+        }
+        else
+        {
+            // In rxdiag, suppress live inspector to avoid bright lines; rely on RW/HX text only
+            // No additional drawing here.
+        }
+    }
+}
+#endif
 
 #if defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE)
+void System::browseTask_()
+{
+    const unsigned long loop_now = millis();
+
     if (button_mask_ == BUTTON_BROWSE_LOCKED)
     {
         /*
@@ -524,33 +674,53 @@ void System::loop()
             }
         }
     }
+}
 #endif
 
-    if (modem_enabled)
+void System::buttonsTask_()
+{
+    /*
+     * Brightness chord: hold button 1 and tap button 2. Browsing ignores the
+     * mixed press, and a tap that turns into a long press (BUTTON_LONG_PRESS_MS)
+     * is left to the shutdown hold instead.
+     */
+    const uint8_t pressed = buttons.consumePressed();
+    const uint8_t released = buttons.consumeReleased();
+    const uint8_t long_pressed = buttons.consumeLongPress();
+    if (!button1_is_low() || (long_pressed & Buttons::BUTTON_2))
     {
-        // Process first; if a frame completed, leave receive mode and keep the shown pattern
-        modemReceiver.process();
-        if (modemReceiver.hasFrameComplete())
-        {
-#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT) && defined(JP1_DEBUG_TONE_DIAG)
-            printToneSummary();
-            debug_tone_report_pending_ = false;
-            debug_tone_active_ = false;
-#endif
-            // Drop back out of receive mode once one transfer has been fully decoded and displayed.
-            modem_enabled = false;
-#ifndef RX_NO_STORAGE
-            current_pattern_index_ = 0;
+        brightness_tap_armed_ = false;
+    }
+    else if (pressed & Buttons::BUTTON_2)
+    {
+        brightness_tap_armed_ = true;
+    }
+    else if ((released & Buttons::BUTTON_2) && brightness_tap_armed_)
+    {
+        brightness_tap_armed_ = false;
+        display.stepBrightness();
+    }
+
+#if AUTO_OFF_MS > 0
+    /*
+     * Inactivity auto-off: a button press or a transfer in progress restarts
+     * the countdown. Expiry runs the regular shutdown, so the two-button
+     * chord wakes the badge again.
+     */
+    bool active = pressed != 0;
+#ifdef ENABLE_MODEM
+    active = active || (modem_enabled && !modemReceiver.isIdle());
 #endif
-            modemReceiver.end();
-            debuglog::println("FRAME DONE");
-            display.setIndicator(7, 7, 20); // disabled
-        }
-        else
-        {
-            // In rxdiag, suppress live inspector to avoid bright lines; rely on RW/HX text only
-            // No additional drawing here.
-        }
+    const unsigned long now_ms = millis();
+    if (active)
+    {
+        last_activity_ms_ = now_ms;
+    }
+    else if (now_ms - last_activity_ms_ >= AUTO_OFF_MS)
+    {
+        trace::record(trace::AUTO_OFF);
+        shutdown();
+        last_activity_ms_ = millis();
     }
 #endif
 
@@ -559,37 +729,31 @@ void System::loop()
 
     if (both_low)
     {
+        // Both buttons have been down since the later of the two presses.
+        const uint16_t held1_ms = buttons.heldMs(Buttons::BUTTON_1);
+        const uint16_t held2_ms = buttons.heldMs(Buttons::BUTTON_2);
+        const uint16_t held_ms = held1_ms < held2_ms ? held1_ms : held2_ms;
+
         // Require a short stable period with both buttons low
-        if (both_pressed_stable < BOTH_STABLE_THRESHOLD)
+        if (held_ms < BOTH_STABLE_MS)
         {
-            both_pressed_stable++;
-            display.update();
             return; // don't start counting toward shutdown yet
         }
 
         /*
          * Naptime!
-         * (After BOTH_STABLE_THRESHOLD stable polls, count at
-         * SHUTDOWN_THRESHOLD * poll-period)
+         * (After BOTH_STABLE_MS of stable presses, hold for another
+         * SHUTDOWN_HOLD_MS)
          */
-        if (want_shutdown < SHUTDOWN_THRESHOLD)
-        {
-            want_shutdown++;
-        }
-        else
+        if (held_ms >= BOTH_STABLE_MS + SHUTDOWN_HOLD_MS)
         {
             shutdown();
-            want_shutdown = 0;
-            both_pressed_stable = 0;
         }
     }
-    else
-    {
-        // Any release or mismatch resets the detection
-        both_pressed_stable = 0;
-        want_shutdown = 0;
-    }
+}
 
+void System::displayTask_()
+{
     /*
      * Match the upstream execution model: the timer ISR only requests an
      * update, while the main loop advances animation state and performs any
@@ -604,6 +768,142 @@ void System::loop()
 #endif
 }
 
+#ifdef SLEEP_BETWEEN_REPEATS
+static volatile bool watchdog_woke = false;
+
+/**
+ * Arm the watchdog in interrupt-only mode.
+ *
+ * @param n Period index: the timeout is 16 ms << n, up to 8 s at n = 9.
+ */
+static void armWatchdogInterrupt(uint8_t n)
+{
+    const uint8_t prescaler = (n & 0x07) | ((n & 0x08) ? _BV(WDP3) : 0);
+    const uint8_t oldSREG = SREG;
+    cli();
+    wdt_reset();
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | prescaler;
+    SREG = oldSREG;
+}
+
+void System::sleepThroughPause_()
+{
+    uint16_t remaining_ms = display.pauseRemainingMs();
+    if (remaining_ms < SLEEP_BETWEEN_REPEATS_MIN_MS || button1_is_low() || button2_is_low())
+    {
+        return;
+    }
+#ifdef ENABLE_MODEM
+    // Never cut into a transfer; the receiver is blind only between transfers.
+    if (modem_enabled && !modemReceiver.isIdle())
+    {
+        return;
+    }
+    if (modem_enabled)
+    {
+        modemReceiver.end();
+    }
+#endif
+
+    // Power-down stops Timer0, which clocks the JP1 UART bits.
+    debuglog::flush();
+    display.disable();
+    PCMSK1 |= _BV(3) | _BV(7);
+    PCICR |= _BV(PCIE1);
+
+    uint16_t slept_ms = 0;
+    while (remaining_ms >= 16)
+    {
+        // Largest watchdog period that still fits the rest of the pause.
+        uint8_t n = 0;
+        while (n < 9 && ((uint16_t)16 << (n + 1)) <= remaining_ms)
+        {
+            n++;
+        }
+
+        watchdog_woke = false;
+        armWatchdogInterrupt(n);
+        set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+        sleep_enable();
+        interrupts();
+        sleep_cpu();
+        sleep_disable();
+
+        if (!watchdog_woke)
+        {
+            // A button press ends the pause early.
+            break;
+        }
+        remaining_ms -= (uint16_t)16 << n;
+        slept_ms += (uint16_t)16 << n;
+    }
+
+    wdt_disable();
+    PCMSK1 &= ~( _BV(3) | _BV(7) );
+    display.skipPause();
+    display.resume();
+    // The sleep stopped millis(); release the other tasks again and drop this run from the statistics.
+    sched::resync();
+#if AUTO_OFF_MS > 0
+    // millis() stops in power-down; count the slept time toward auto-off.
+    last_activity_ms_ -= slept_ms;
+#endif
+#ifdef ENABLE_MODEM
+    if (modem_enabled)
+    {
+        modemReceiver.begin();
+    }
+#endif
+}
+
+/**
+ * Mark a watchdog wakeup at the end of a timed pause step.
+ */
+ISR(WDT_vect)
+{
+    watchdog_woke = true;
+}
+#endif
+
+void System::idle()
+{
+#ifndef NO_IDLE_SLEEP
+#if defined(ENABLE_MODEM) && defined(RX_POLLING)
+    // Polled ADC conversions are only collected by the loop itself.
+    if (modem_enabled)
+    {
+        return;
+    }
+#endif
+
+    /*
+     * Timer0 (millis), the multiplex timer, the modem ADC and the button
+     * pin-change interrupt all wake the CPU from idle. Only a new column
+     * tick or a decodable modem byte has work for the loop, so the other
+     * wakeups go straight back to sleep. Buttons and millis() deadlines are
+     * therefore polled once per 256 us column slot. A millis() tick also
+     * ends the wait, so the loop keeps running its deadlines while the
+     * multiplex timer is stopped, as in JP1_DEBUG_HEADLESS_RX builds.
+     */
+    const uint8_t column = display.activeColumn();
+    const uint8_t tick = (uint8_t)millis();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    do
+    {
+        sleep_enable();
+        sleep_cpu();
+        sleep_disable();
+#ifdef ENABLE_MODEM
+        if (modem_enabled && fecModem.available())
+        {
+            break;
+        }
+#endif
+    } while (display.activeColumn() == column && (uint8_t)millis() == tick);
+#endif
+}
+
 /**
  * Advance to the next stored pattern after a finite repeat cycle completes.
  */
@@ -633,7 +933,7 @@ void System::shutdown()
     uint8_t i;
     DisplayState preShutdownDisplayState;
 
-    debuglog::println("SHUTDOWN");
+    trace::record(trace::SHUTDOWN);
 
     display.snapshotState(preShutdownDisplayState);
     // Freeze the active image as a static frame so the timer ISR no longer
@@ -661,6 +961,16 @@ void System::shutdown()
     // Disable ADC to save power via Arduino API
     power_adc_disable();
 
+    // The shutdown path holds a display snapshot on the stack; report it too.
+    reportStackHeadroom();
+    sched::report();
+
+    // Buffered trace records would otherwise wait for the wakeup.
+    trace::flush();
+
+    // Commit the SRAM diagnostic record; the battery may be removed while off.
+    diaglog::flush();
+
     // Enable pin-change interrupts on button pins for wakeup
     // Map: PC3 (A3) -> PCINT11 -> PCMSK1 bit 3, PC7 (A7) -> PCINT15 -> PCMSK1 bit 7
     PCMSK1 |= _BV(3) | _BV(7);
@@ -714,7 +1024,8 @@ void System::shutdown()
     }
 #endif
 
-    debuglog::println("WAKE");
+    trace::record(trace::WAKE);
+    sched::resync();
 }
 
 /**
@@ -3,13 +3,23 @@
 
 #include <Arduino.h>
 
-#ifndef SHUTDOWN_THRESHOLD
-#define SHUTDOWN_THRESHOLD 2048
+// Both-button hold, after the stability window, that requests shutdown.
+// 524 ms matches the former 2048 polls at one pass per 256 us column tick.
+#ifndef SHUTDOWN_HOLD_MS
+#define SHUTDOWN_HOLD_MS 524U
 #endif
-// Number of consecutive polls with both buttons low required
-// before starting to count toward shutdown threshold
-#ifndef BOTH_STABLE_THRESHOLD
-#define BOTH_STABLE_THRESHOLD 32
+// Time both buttons must stay low before the shutdown hold starts counting
+#ifndef BOTH_STABLE_MS
+#define BOTH_STABLE_MS 8U
+#endif
+// Power down after this long without a button press or receive activity; 0, the default, keeps
+// the badge displaying until it is switched off. Battery builds can set e.g. -DAUTO_OFF_MS=3600000UL.
+#ifndef AUTO_OFF_MS
+#define AUTO_OFF_MS 0UL
+#endif
+// With SLEEP_BETWEEN_REPEATS, end-of-cycle pauses at least this long are slept through
+#ifndef SLEEP_BETWEEN_REPEATS_MIN_MS
+#define SLEEP_BETWEEN_REPEATS_MIN_MS 1000U
 #endif
 #ifndef MODEM_BOOT_DELAY_MS
 #define MODEM_BOOT_DELAY_MS 1000UL
@@ -31,6 +41,11 @@ public:
      */
     void loop();
 
+    /**
+     * Idle-sleep until the next multiplex column tick or a decodable modem byte.
+     */
+    void idle();
+
     /**
      * Play the shutdown animation, enter sleep, and restore state on wake.
      */
@@ -41,9 +56,79 @@ public:
      */
     void handleAnimationRepeat();
 
+    /**
+     * Main loop task ids, also reported in TASK_* trace records.
+     */
+    enum TaskId : uint8_t
+    {
+        TASK_RECEIVE,
+        TASK_DISPLAY,
+        TASK_BUTTONS,
+        TASK_MODEM_CONTROL,
+        TASK_BROWSE,
+        TASK_TRACE,
+        TASK_DIAGLOG,
+        TASK_HEARTBEAT,
+        TASK_PAUSE_SLEEP,
+    };
+
 private:
-    uint16_t want_shutdown = 0; // Track long-press duration
-    uint16_t both_pressed_stable = 0; // Stability gate for simultaneous press
+    /**
+     * Install the main loop task table in the scheduler.
+     */
+    void startTasks_();
+
+    /**
+     * Run one main loop task; the scheduler callback.
+     *
+     * @param id Task id.
+     */
+    static void runTask_(uint8_t id);
+
+    /**
+     * Handle the brightness chord, inactivity auto-off and the shutdown hold.
+     */
+    void buttonsTask_();
+
+    /**
+     * Advance the display and hand finished repeat cycles to storage browsing.
+     */
+    void displayTask_();
+
+#ifdef ENABLE_MODEM
+    /**
+     * Decode pending modem bytes and leave receive mode after a complete transfer.
+     */
+    void receiveTask_();
+
+    /**
+     * Toggle receive mode on a long press, or start it after the boot delay.
+     */
+    void modemControlTask_();
+#endif
+#if defined(ENABLE_MODEM) && !defined(RX_NO_STORAGE)
+    /**
+     * Step through stored patterns once a browse button is released.
+     */
+    void browseTask_();
+#endif
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT)
+    /**
+     * Send the JP1 heartbeat or tone summary once per second.
+     */
+    void heartbeatTask_();
+#endif
+
+    /**
+     * Blank the matrix and power down through a long end-of-cycle pause,
+     * waking from the watchdog or a button press.
+     */
+    void sleepThroughPause_();
+
+    bool brightness_tap_armed_ = false; // Button 2 went down while button 1 was held
+#if AUTO_OFF_MS > 0
+    uint32_t last_activity_ms_ = 0; // millis() of the last press or receive activity
+#endif
 #if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_NO_HEARTBEAT)
     uint32_t debug_heartbeat_at_ms = 0;
 #if defined(ENABLE_MODEM) && defined(JP1_DEBUG_TONE_DIAG)
@@ -65,9 +150,8 @@ private:
     uint8_t button_mask_ = 0;
     uint32_t button_debounce_until_ms_ = 0;
 #endif
-    uint16_t btn2_hold = 0;
-    #ifndef RECEIVE_HOLD_TICKS
-    #define RECEIVE_HOLD_TICKS 200
+    #ifndef RECEIVE_HOLD_MS
+    #define RECEIVE_HOLD_MS 50U
     #endif
     bool btn2_latched = false; // prevents multiple toggles while held
     uint16_t modem_boot_delay = 0; // legacy tick-based delay (unused when time-based)
@@ -97,6 +97,30 @@ void Timer::stop()
     TCCR1B &= ~((1 << CS12) | (1 << CS11) | (1 << CS10));
 }
 
+void Timer::setPeriodTicks(uint16_t ticks)
+{
+    // CTC restarts TCNT1 at every match, so a new TOP applies to the period
+    // that is already running as long as TCNT1 has not passed it yet.
+    OCR1A = ticks - 1;
+    /*
+     * A short period (256 ticks for a column at brightness 1) can be over
+     * before the callback gets here, for example when the ADC interrupt
+     * delayed it. TCNT1 would then run through 0xFFFF, an 8 ms glitch.
+     * Move it two ticks short of TOP instead, so the overdue match fires
+     * right after this interrupt; a write to TCNT1 blocks a match on the
+     * next tick only.
+     */
+    if (TCNT1 > OCR1A)
+    {
+        TCNT1 = ticks >= 3 ? ticks - 3 : 0;
+    }
+}
+
+uint16_t Timer::periodTicks() const
+{
+    return OCR1A + 1;
+}
+
 /**
  * Dispatch the Timer1 compare-match interrupt to the registered callback.
  */
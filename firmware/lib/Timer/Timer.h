@@ -30,6 +30,22 @@ public:
      */
     void stop();
 
+    /**
+     * Set the length of the running compare period in timer ticks. Called
+     * from the callback, it decides when the next interrupt fires; later
+     * periods keep the new length until it is changed again.
+     *
+     * @param ticks Period length in timer ticks (at least 1).
+     */
+    void setPeriodTicks(uint16_t ticks);
+
+    /**
+     * Return the current compare period in timer ticks.
+     *
+     * @returns Period length in timer ticks.
+     */
+    uint16_t periodTicks() const;
+
     /**
      * User-defined ISR callback function pointer (called from TIMER1 COMPA ISR).
      * This is publicly accessible (like TimerOne's isrCallback) so the ISR can call it.
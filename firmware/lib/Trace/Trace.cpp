@@ -0,0 +1,124 @@
+#include "Trace.h"
+
+#include <Arduino.h>
+
+#include "DebugSerial.h"
+
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0 && TRACE_RING_SIZE <= 128,
+              "TRACE_RING_SIZE must be a power of two up to 128");
+
+namespace
+{
+constexpr uint8_t kSync = 0xA5;
+constexpr uint8_t kMask = TRACE_RING_SIZE - 1;
+
+struct Record
+{
+    uint8_t event;
+    uint16_t timestamp;
+    uint16_t arg;
+};
+
+// One slot stays free so head == tail always means empty.
+Record ring[TRACE_RING_SIZE];
+volatile uint8_t head = 0;
+volatile uint8_t tail = 0;
+volatile uint16_t dropped = 0;
+
+/**
+ * Append one record to the ring. The caller holds the interrupt lock.
+ *
+ * @param event Record id.
+ * @param timestamp Low 16 bits of `millis()`.
+ * @param arg Event-specific argument.
+ * @returns `false` when the ring is full.
+ */
+bool push(uint8_t event, uint16_t timestamp, uint16_t arg)
+{
+    const uint8_t next = (head + 1) & kMask;
+    if (next == tail)
+    {
+        return false;
+    }
+    ring[head].event = event;
+    ring[head].timestamp = timestamp;
+    ring[head].arg = arg;
+    head = next;
+    return true;
+}
+
+/**
+ * Send one byte and fold it into the running record checksum.
+ *
+ * @param value Byte to send.
+ * @param check Running XOR checksum.
+ */
+inline void sendByte(uint8_t value, uint8_t &check)
+{
+    debuglog::write(value);
+    check ^= value;
+}
+} // namespace
+
+void trace::record(Event event, uint16_t arg)
+{
+    const uint16_t now = (uint16_t)millis();
+    const uint8_t oldSREG = SREG;
+    cli();
+
+    if (dropped != 0 && push(DROPPED, now, dropped))
+    {
+        dropped = 0;
+    }
+    if (dropped != 0 || !push(event, now, arg))
+    {
+        if (dropped != 0xFFFF)
+        {
+            dropped++;
+        }
+    }
+
+    SREG = oldSREG;
+}
+
+bool trace::drain()
+{
+    // Low priority: never wait for the UART.
+    if (debuglog::txFree() < 7)
+    {
+        return false;
+    }
+
+    Record rec;
+    const uint8_t oldSREG = SREG;
+    cli();
+    if (head == tail)
+    {
+        SREG = oldSREG;
+        return false;
+    }
+    rec = ring[tail];
+    tail = (tail + 1) & kMask;
+    SREG = oldSREG;
+
+    uint8_t check = 0;
+    sendByte(kSync, check);
+    sendByte(rec.event, check);
+    sendByte((uint8_t)(rec.timestamp & 0xFF), check);
+    sendByte((uint8_t)(rec.timestamp >> 8), check);
+    sendByte((uint8_t)(rec.arg & 0xFF), check);
+    sendByte((uint8_t)(rec.arg >> 8), check);
+    debuglog::write(check);
+    return true;
+}
+
+void trace::flush()
+{
+    do
+    {
+        debuglog::flush();
+    } while (drain());
+    debuglog::flush();
+}
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Binary event trace for the JP1 debug channel. Call sites store a 5-byte
+ * record (event id, 16-bit millis() timestamp, 16-bit argument) in a small
+ * SRAM ring, which takes a few microseconds and is safe from interrupt
+ * context. System::loop() queues at most one record per pass for the JP1
+ * UART while no transfer is running, so the UART interrupt load stays out
+ * of a receive.
+ *
+ * Wire format per record, little endian:
+ *   0xA5 <id> <ts lo> <ts hi> <arg lo> <arg hi> <xor of the previous six bytes>
+ * The sync byte never occurs in the ASCII text that other JP1 output still
+ * uses, so `npm run trace:decode` can separate the two.
+ */
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 16
+#endif
+
+namespace trace
+{
+/**
+ * Record ids. scripts/lib/trace-decode.mjs reads the names from this list,
+ * so keep one id per line and append new ids at the end.
+ */
+enum Event : uint8_t
+{
+    BOOT = 1,          // arg: MCUSR reset cause
+    MODEM_SKIP,        // JP1_DEBUG_SKIP_MODEM left the receiver off
+    MODEM_ON,          // receive mode toggled on
+    FRAME_DONE,        // System left receive mode after a complete transfer
+    AUTO_OFF,          // inactivity timeout reached
+    SHUTDOWN,          // shutdown requested
+    WAKE,              // woke from shutdown
+    RX_BEGIN,          // receiver started
+    RX_END,            // receiver stopped
+    RX_TIMEOUT,        // stalled transfer aborted
+    RX_START,          // start marker seen
+    RX_PATTERN1,       // first pattern marker seen
+    RX_PATTERN2,       // second pattern marker seen
+    RX_END_MARKER,     // end marker seen
+    RX_FRAME,          // frame complete
+    RX_LENGTH,         // arg: decoded payload length
+    STORAGE_SAVE,      // arg: first page of the new pattern
+    STORAGE_APPEND,    // arg: page written
+    STORAGE_LOAD,      // arg: pattern index
+    TWI_RETRY,         // arg: attempts before the transaction succeeded
+    TWI_READ_ERROR,    // arg: EEPROM address
+    TWI_WRITE_ERROR,   // arg: EEPROM address
+    DROPPED,           // arg: records lost because the ring was full
+    STACK_FREE,        // arg: stack headroom left since boot, in bytes
+    TASK_OVERRUN,      // arg: task id << 12 | new worst run time in 16 us units
+    TASK_STATS,        // arg: task id << 8 | overruns since boot
+    TASK_LATE,         // arg: task id << 8 | deadline misses since boot
+};
+
+/**
+ * Store one trace record in the SRAM ring. A full ring drops the record
+ * and reports the loss with a DROPPED record once space is available.
+ *
+ * @param event Record id.
+ * @param arg Event-specific argument.
+ */
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+void record(Event event, uint16_t arg = 0);
+#else
+inline void record(Event, uint16_t = 0) {}
+#endif
+
+/**
+ * Queue the oldest buffered record for the JP1 UART, unless its transmit
+ * FIFO lacks room for a whole record.
+ *
+ * @returns `true` when a record was queued.
+ */
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+bool drain();
+#else
+inline bool drain() { return false; }
+#endif
+
+/**
+ * Send every buffered record and wait until the UART is idle, for example
+ * before the MCU powers down.
+ */
+#if defined(JP1_DEBUG_SERIAL) && !defined(JP1_DEBUG_SILENT)
+void flush();
+#else
+inline void flush() {}
+#endif
+} // namespace trace
@@ -1,4 +1,5 @@
 #include "TwiBus.h"
+#include "Trace.h"
 
 #include <avr/io.h>
 #include <util/delay.h>
@@ -136,13 +137,45 @@ void TwiBus::stop_()
 void TwiBus::enable()
 {
     /*
-     * Set I2C clock frequency to 100kHz.
+     * Set the I2C clock frequency (100 kHz unless TWI_FAST_MODE is set).
      * freq = F_CPU / (16 + (2 * TWBR * TWPS) )
      * let TWPS = "00" = 1
-     * -> TWBR = (F_CPU / 100000) - 16 / 2
+     * -> TWBR = (F_CPU / freq) - 16 / 2
+     *
+     * At 8 MHz this gives TWBR = 2 for 400 kHz and TWBR = 32 for 100 kHz.
      */
+#if (F_CPU / TWI_BUS_FREQ_HZ) < 16
+#error "TWI_BUS_FREQ_HZ is too fast for the configured F_CPU"
+#endif
     TWSR = 0; // prescaler = 1
-    TWBR = ((F_CPU / 100000UL) - 16) / 2;
+    TWBR = ((F_CPU / TWI_BUS_FREQ_HZ) - 16) / 2;
+}
+
+TwiBus::Status TwiBus::waitReady(uint8_t deviceAddress)
+{
+    /*
+     * A 24C64 write cycle takes at most 5 ms. One address-only poll costs
+     * about 25 us at 400 kHz (100 us at 100 kHz), so 255 polls comfortably
+     * cover the worst case at either speed while still bounding the wait
+     * if the device is missing.
+     */
+    for (uint8_t num_polls = 0; num_polls < 255; num_polls++)
+    {
+        const Status status = startWrite_(deviceAddress);
+        stop_();
+        // Let the STOP condition finish before the next poll re-arms START.
+        while (TWCR & _BV(TWSTO))
+        {
+        }
+
+        if (status == OK)
+        {
+            return OK;
+        }
+        _delay_us(10);
+    }
+
+    return ADDR_ERR;
 }
 
 TwiBus::Status TwiBus::write(uint8_t deviceAddress, uint8_t addrhi, uint8_t addrlo, uint8_t len, uint8_t *data)
@@ -182,10 +215,15 @@ TwiBus::Status TwiBus::write(uint8_t deviceAddress, uint8_t addrhi, uint8_t addr
         }
 
         stop_();
+        if (num_tries > 0)
+        {
+            trace::record(trace::TWI_RETRY, num_tries);
+        }
         return OK;
     }
 
     stop_();
+    trace::record(trace::TWI_WRITE_ERROR, ((uint16_t)addrhi << 8) | addrlo);
     return DATA_ERR;
 }
 
@@ -232,9 +270,14 @@ TwiBus::Status TwiBus::read(uint8_t deviceAddress, uint8_t addrhi, uint8_t addrl
         }
 
         stop_();
+        if (num_tries > 0)
+        {
+            trace::record(trace::TWI_RETRY, num_tries);
+        }
         return OK;
     }
 
     stop_();
+    trace::record(trace::TWI_READ_ERROR, ((uint16_t)addrhi << 8) | addrlo);
     return DATA_ERR;
 }
@@ -2,6 +2,21 @@
 
 #include <Arduino.h>
 
+/*
+ * SCL frequency used by TwiBus::enable(). The default stays at 100 kHz
+ * standard mode: the schematic lists an AT24CS01 while the storage layout
+ * assumes a 24C64, so the fitted part's rating is not settled. Builds whose
+ * EEPROM is known to handle fast mode opt in with -DTWI_FAST_MODE (400 kHz),
+ * or set -DTWI_BUS_FREQ_HZ directly.
+ */
+#ifndef TWI_BUS_FREQ_HZ
+#ifdef TWI_FAST_MODE
+#define TWI_BUS_FREQ_HZ 400000UL
+#else
+#define TWI_BUS_FREQ_HZ 100000UL
+#endif
+#endif
+
 /**
  * Generic AVR TWI bus helper for 16-bit-addressed peripherals.
  */
@@ -24,6 +39,17 @@ public:
      */
     void enable();
 
+    /**
+     * Poll a device with address-only write starts until it acknowledges.
+     * EEPROMs NACK their address while an internal write cycle is running,
+     * so this lets back-to-back page writes start as soon as the device is
+     * ready instead of waiting out a fixed backoff.
+     *
+     * @param deviceAddress 7-bit device address.
+     * @returns `OK` once the device acknowledges, or `ADDR_ERR` on timeout.
+     */
+    Status waitReady(uint8_t deviceAddress);
+
     /**
      * Read bytes from a 16-bit-addressed I2C/TWI device.
      *
@@ -0,0 +1,142 @@
+"""
+Static SRAM map of a linked firmware image.
+
+PlatformIO runs this after linking every environment (see `extra_scripts` in
+platformio.ini). It lists each .data, .bss and .noinit object by size, sums
+the static use and reports what is left for the stack, and writes the same
+text next to the ELF as `sram-map.txt`. Compare it with the STACK_FREE trace
+record or the `stack_free` DiagLog field, which show how much of that
+remainder the stack actually left untouched.
+
+Outside PlatformIO it reads an `avr-nm -S` listing instead:
+
+    avr-nm -S -C firmware.elf | python3 sram_map.py --ram-size 512
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+
+# avr-gcc places SRAM at this offset in the ELF address space.
+SRAM_OFFSET = 0x800000
+EEPROM_OFFSET = 0x810000
+
+# Warn when less than this is left for the stack and interrupt frames.
+DEFAULT_STACK_RESERVE = 96
+
+
+def parse_nm(listing):
+    """
+    Collect SRAM objects and section bounds from an `avr-nm -S` listing.
+
+    :param listing: nm output text.
+    :returns: (objects, symbols) with objects as (size, kind, name) tuples and
+        symbols mapping every SRAM symbol name to its data-space address.
+    """
+    objects = []
+    symbols = {}
+    for line in listing.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 3:
+            continue
+        try:
+            address = int(fields[0], 16)
+        except ValueError:
+            continue
+        if not SRAM_OFFSET <= address < EEPROM_OFFSET:
+            continue
+
+        if len(fields) == 4 and len(fields[2]) == 1:
+            size, kind, name = int(fields[1], 16), fields[2], fields[3]
+        else:
+            # Symbols without a size, such as section bounds.
+            size, kind, name = 0, fields[1], line.split(None, 2)[2]
+        symbols[name] = address - SRAM_OFFSET
+        if size and kind in "bBdDvV":
+            objects.append((size, "bss" if kind in "bB" else "data", name))
+
+    objects.sort(key=lambda item: (-item[0], item[2]))
+    return objects, symbols
+
+
+def format_map(objects, symbols, ram_size, stack_reserve, title=None):
+    """
+    Render the SRAM map.
+
+    :param objects: Objects from parse_nm().
+    :param symbols: Symbol addresses from parse_nm().
+    :param ram_size: SRAM size in bytes.
+    :param stack_reserve: Stack headroom below which a warning is added.
+    :param title: Optional first line, usually the environment name.
+    :returns: (text, stack_bytes) with the report and the bytes left for the stack.
+    """
+    data = sum(size for size, kind, _ in objects if kind == "data")
+    bss = sum(size for size, kind, _ in objects if kind == "bss")
+    static = data + bss
+    if "__data_start" in symbols and "_end" in symbols:
+        # Section bounds include alignment and objects without a size.
+        static = symbols["_end"] - symbols["__data_start"]
+    stack = ram_size - static
+
+    lines = []
+    if title:
+        lines.append(title)
+    lines.append("SRAM %d bytes: data %d, bss %d, static %d, stack %d" % (ram_size, data, bss, static, stack))
+    for size, kind, name in objects:
+        lines.append("%6d  %-4s  %s" % (size, kind, name))
+    if stack < stack_reserve:
+        lines.append("warning: only %d bytes left for the stack (reserve %d)" % (stack, stack_reserve))
+    return "\n".join(lines) + "\n", stack
+
+
+def main(argv):
+    """
+    Print the SRAM map for an nm listing read from a file or stdin.
+
+    :param argv: Command-line arguments.
+    :returns: Process exit code.
+    """
+    parser = argparse.ArgumentParser(description="Static SRAM map from an avr-nm -S listing.")
+    parser.add_argument("listing", nargs="?", help="avr-nm -S output (default: stdin)")
+    parser.add_argument("--ram-size", type=int, default=512)
+    parser.add_argument("--stack-reserve", type=int, default=DEFAULT_STACK_RESERVE)
+    args = parser.parse_args(argv)
+
+    if args.listing:
+        with open(args.listing) as handle:
+            listing = handle.read()
+    else:
+        listing = sys.stdin.read()
+    objects, symbols = parse_nm(listing)
+    text, _ = format_map(objects, symbols, args.ram_size, args.stack_reserve)
+    sys.stdout.write(text)
+    return 0
+
+
+def after_link(target, source, env):
+    """
+    PlatformIO post-link action: write sram-map.txt and print its summary.
+    """
+    elf = target[0].get_abspath()
+    # The toolchain's bin directory is on the PATH of the build environment.
+    listing = subprocess.check_output(["avr-nm", "-S", "-C", elf], env=env["ENV"], universal_newlines=True)
+    ram_size = int(env.BoardConfig().get("upload.maximum_ram_size", 512))
+    reserve = int(env.GetProjectOption("custom_stack_reserve", DEFAULT_STACK_RESERVE))
+
+    objects, symbols = parse_nm(listing)
+    text, _ = format_map(objects, symbols, ram_size, reserve, "[%s]" % env["PIOENV"])
+    with open(os.path.join(os.path.dirname(elf), "sram-map.txt"), "w") as handle:
+        handle.write(text)
+    for line in text.splitlines():
+        if line.startswith(("SRAM", "warning")):
+            print(line)
+
+
+try:
+    Import("env")  # noqa: F821 - provided by SCons inside PlatformIO
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main(sys.argv[1:]))
+else:
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", after_link)  # noqa: F821
@@ -92,8 +92,9 @@ void setup()
  */
 void loop()
 {
-    // Continuously run system loop (not used in this case, as everything is interrupt-driven)
     blinkenstar.loop();
+    // Sleep until the display or modem interrupts leave new work for the loop.
+    blinkenstar.idle();
 }
 
 #endif
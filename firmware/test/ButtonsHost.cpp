@@ -0,0 +1,238 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "Buttons.h"
+
+/*
+ * Host-side probe for the refresh-rate button debouncer. PINC is driven
+ * directly and sample() is called the way the display timer calls it, once
+ * per 2048 us refresh.
+ */
+volatile uint8_t SREG;
+volatile uint8_t PINC = 0xFF;
+
+static unsigned long now_ms = 0;
+
+unsigned long millis()
+{
+    return now_ms;
+}
+
+static constexpr uint8_t kButton1Pin = _BV(PC3);
+static constexpr uint8_t kButton2Pin = _BV(PC7);
+
+/**
+ * Set the raw button levels and take a number of samples.
+ *
+ * @param low Pin mask of buttons held low.
+ * @param samples Number of display refreshes to simulate.
+ */
+static void hold(uint8_t low, uint16_t samples)
+{
+    PINC = (uint8_t)(0xFF & ~low);
+    while (samples--)
+    {
+        buttons.sample();
+    }
+}
+
+/**
+ * Verify that contact bounce shorter than the history window raises no event.
+ *
+ * @returns `true` when bounce is filtered and a clean press is reported once.
+ */
+static bool testBounceFiltered()
+{
+    PINC = 0xFF;
+    buttons.begin();
+    for (uint8_t i = 0; i < 6; ++i)
+    {
+        hold(kButton1Pin, 3);
+        hold(0, 2);
+    }
+    if (buttons.consumePressed() != 0 || buttons.isDown(Buttons::BUTTON_1))
+    {
+        fprintf(stderr, "bounce produced a press\n");
+        return false;
+    }
+
+    hold(kButton1Pin, 7);
+    if (buttons.isDown(Buttons::BUTTON_1))
+    {
+        fprintf(stderr, "press reported before eight stable samples\n");
+        return false;
+    }
+    hold(kButton1Pin, 1);
+    if (!buttons.isDown(Buttons::BUTTON_1) || buttons.consumePressed() != Buttons::BUTTON_1 || buttons.consumePressed() != 0)
+    {
+        fprintf(stderr, "clean press not reported exactly once\n");
+        return false;
+    }
+
+    hold(0, 8);
+    if (buttons.isDown(Buttons::BUTTON_1) || buttons.consumeReleased() != Buttons::BUTTON_1)
+    {
+        fprintf(stderr, "release not reported\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Verify long-press timing and hold durations.
+ *
+ * @returns `true` when the long press fires once at BUTTON_LONG_PRESS_MS.
+ */
+static bool testLongPress()
+{
+    PINC = 0xFF;
+    buttons.begin();
+    hold(kButton2Pin, 8);
+    buttons.consumePressed();
+
+    // 400 ms is 196 samples of 2048 us; the press itself took 8 samples.
+    hold(kButton2Pin, 195);
+    if (buttons.consumeLongPress() != 0)
+    {
+        fprintf(stderr, "long press fired early\n");
+        return false;
+    }
+    hold(kButton2Pin, 1);
+    if (buttons.consumeLongPress() != Buttons::BUTTON_2)
+    {
+        fprintf(stderr, "long press missing at %u ms\n", buttons.heldMs(Buttons::BUTTON_2));
+        return false;
+    }
+    hold(kButton2Pin, 500);
+    if (buttons.consumeLongPress() != 0)
+    {
+        fprintf(stderr, "long press fired twice\n");
+        return false;
+    }
+    const uint16_t held = buttons.heldMs(Buttons::BUTTON_2);
+    if (held < 1424 || held > 1426)
+    {
+        fprintf(stderr, "heldMs reported %u ms for 696 samples\n", held);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Verify that buttons already held when sampling starts raise no events,
+ * and that reads fall back to the pins while sampling is stopped.
+ *
+ * @returns `true` when begin() adopts held buttons silently.
+ */
+static bool testBeginWithHeldButtons()
+{
+    PINC = (uint8_t)~(kButton1Pin | kButton2Pin);
+    buttons.begin();
+    if (!buttons.isDown(Buttons::BUTTON_BOTH))
+    {
+        fprintf(stderr, "held buttons not adopted by begin()\n");
+        return false;
+    }
+    hold(kButton1Pin | kButton2Pin, 400);
+    if (buttons.consumePressed() != 0 || buttons.consumeLongPress() != 0)
+    {
+        fprintf(stderr, "held buttons raised events after begin()\n");
+        return false;
+    }
+
+    buttons.end();
+    PINC = (uint8_t)~kButton2Pin;
+    if (buttons.isDown(Buttons::BUTTON_1) || !buttons.isDown(Buttons::BUTTON_2))
+    {
+        fprintf(stderr, "stopped sampler did not read the pins\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Verify that holds and events still advance from millis() while the display
+ * timer is stopped, as in the headless JP1 build.
+ *
+ * @returns `true` when the shutdown, chord and long-press inputs work unsampled.
+ */
+static bool testPolledWithoutSampling()
+{
+    PINC = 0xFF;
+    now_ms = 1000;
+    buttons.begin();
+    // The press debounces after 8 samples, so 92 samples (188 ms) of hold remain.
+    hold(kButton1Pin, 100);
+    buttons.end();
+
+    // The hold started under the sampler keeps counting.
+    now_ms += 100;
+    uint16_t held = buttons.heldMs(Buttons::BUTTON_1);
+    if (!buttons.isDown(Buttons::BUTTON_1) || held != 288)
+    {
+        fprintf(stderr, "hold not carried over from the sampler: %u ms\n", held);
+        return false;
+    }
+
+    // Bounce on the press restarts the hold and raises one press event.
+    buttons.consumePressed();
+    PINC = (uint8_t)~(kButton1Pin | kButton2Pin);
+    buttons.isDown(Buttons::BUTTON_2);
+    now_ms += 2;
+    PINC = (uint8_t)~kButton1Pin;
+    buttons.isDown(Buttons::BUTTON_2);
+    now_ms += 3;
+    PINC = (uint8_t)~(kButton1Pin | kButton2Pin);
+    if (!buttons.isDown(Buttons::BUTTON_BOTH) || buttons.consumePressed() != Buttons::BUTTON_2
+        || buttons.heldMs(Buttons::BUTTON_2) != 0)
+    {
+        fprintf(stderr, "polled press not reported once\n");
+        return false;
+    }
+
+    // Button 1, pressed under the sampler, passes its long press in the same stretch.
+    now_ms += 600;
+    held = buttons.heldMs(Buttons::BUTTON_2);
+    if (held != 600 || buttons.consumeLongPress() != Buttons::BUTTON_BOTH || buttons.consumeLongPress() != 0)
+    {
+        fprintf(stderr, "polled hold reported %u ms without one long press\n", held);
+        return false;
+    }
+
+    now_ms += 20;
+    PINC = (uint8_t)~kButton1Pin;
+    if (buttons.isDown(Buttons::BUTTON_2) || buttons.consumeReleased() != Buttons::BUTTON_2)
+    {
+        fprintf(stderr, "polled release not reported\n");
+        return false;
+    }
+
+    // Hold times saturate instead of wrapping with the 16-bit stamp, as long as the loop keeps polling.
+    for (uint8_t i = 0; i < 70; ++i)
+    {
+        now_ms += 1000;
+        buttons.isDown(Buttons::BUTTON_1);
+    }
+    held = buttons.heldMs(Buttons::BUTTON_1);
+    now_ms += 1000;
+    if (held != 60000 || buttons.heldMs(Buttons::BUTTON_1) != 60000)
+    {
+        fprintf(stderr, "polled hold did not saturate: %u ms\n", held);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Run the host-side button debouncer checks.
+ *
+ * @returns Process exit code for the tiny host test binary.
+ */
+int main()
+{
+    if (!testBounceFiltered() || !testLongPress() || !testBeginWithHeldButtons() || !testPolledWithoutSampling())
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Arduino.h>
+
+#include "DebugSerial.h"
+
+/*
+ * Host-side capture of the JP1 software UART. It links the real
+ * DebugSerial.cpp against register stubs, advances a free-running Timer0 at
+ * the 125 kHz millis() clock, and calls the compare ISR on every match, late
+ * by a pseudo-random interrupt latency of up to --jitter-us. Every change of
+ * the TX pin is printed with its time, like a logic analyzer capture, so the
+ * caller can decode the bytes with an independent UART receiver.
+ *
+ * Usage:
+ *   DebugSerialHost [--jitter-us N]
+ *
+ * Output lines:
+ *   T <ns> <level>   TX pin changed to <level> at <ns>
+ *   E <ns>           end of the capture
+ */
+
+volatile uint8_t SREG = _BV(SREG_I);
+volatile uint8_t PORTC = 0;
+volatile uint8_t DDRC = 0;
+volatile uint8_t TCCR0A = _BV(CS01) | _BV(CS00); // Prescaler 64, as set up for millis()
+volatile uint8_t TCNT0 = 0;
+volatile uint8_t OCR0A = 0;
+volatile uint8_t TIMSK0 = 0;
+volatile uint8_t TIFR0 = 0;
+
+extern "C" void TIMER0_COMPA_vect();
+
+static constexpr uint64_t kTickNs = 8000;
+static uint64_t tick_count = 0;
+static uint8_t tx_level = 1;
+static uint32_t jitter_ns = 0;
+static uint32_t lcg = 12345;
+
+/**
+ * Return a reproducible interrupt latency.
+ *
+ * @returns Latency in nanoseconds, up to the configured jitter.
+ */
+static uint32_t nextLatencyNs()
+{
+    if (jitter_ns == 0)
+    {
+        return 0;
+    }
+    lcg = lcg * 1103515245u + 12345u;
+    return (lcg >> 8) % (jitter_ns + 1);
+}
+
+/**
+ * Advance Timer0 by one tick and service a compare match.
+ */
+static void step()
+{
+    TCNT0++;
+    tick_count++;
+    if (TCNT0 == OCR0A && (TIMSK0 & _BV(OCIE0A)))
+    {
+        const uint64_t at = tick_count * kTickNs + nextLatencyNs();
+        TIMER0_COMPA_vect();
+        const uint8_t level = PORTC & _BV(PC0) ? 1 : 0;
+        if (level != tx_level)
+        {
+            tx_level = level;
+            printf("T %llu %u\n", (unsigned long long)at, level);
+        }
+    }
+}
+
+/**
+ * Advance Timer0 until the UART is idle.
+ */
+static void runUntilIdle()
+{
+    while (TIMSK0 & _BV(OCIE0A))
+    {
+        step();
+    }
+}
+
+/**
+ * Queue bytes and capture their transmission.
+ *
+ * @returns Process exit code.
+ */
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--jitter-us") == 0 && i + 1 < argc)
+        {
+            jitter_ns = (uint32_t)strtoul(argv[++i], nullptr, 10) * 1000u;
+        }
+        else
+        {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    debuglog::begin();
+    if (!(DDRC & _BV(PC0)) || !(PORTC & _BV(PC0)))
+    {
+        fprintf(stderr, "begin() did not drive TX idle high\n");
+        return 1;
+    }
+
+    // Every byte value, in bursts that fit the FIFO.
+    for (uint16_t value = 0; value < 256; value += 16)
+    {
+        for (uint8_t i = 0; i < 16; ++i)
+        {
+            debuglog::write((uint8_t)(value + i));
+        }
+        runUntilIdle();
+    }
+
+    // Refill while the transmitter is running.
+    debuglog::print("JP1 ");
+    for (uint8_t tick = 0; tick < 20; ++tick)
+    {
+        step();
+    }
+    debuglog::println("UART");
+    runUntilIdle();
+
+    // With interrupts off a full FIFO drops bytes instead of waiting forever.
+    SREG = 0;
+    for (uint8_t i = 0; i < 40; ++i)
+    {
+        debuglog::write('a' + (i % 26));
+    }
+    if (debuglog::txFree() != 0)
+    {
+        fprintf(stderr, "FIFO should be full\n");
+        return 1;
+    }
+    SREG = _BV(SREG_I);
+    runUntilIdle();
+
+    printf("E %llu\n", (unsigned long long)(tick_count * kTickNs));
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avr/eeprom.h>
+
+#include "DiagLog.h"
+
+/*
+ * Host-side probe for the batched diagnostic log. It links the real
+ * DiagLog.cpp against a counting EEPROM stub and replays the diaglog calls the
+ * receiver makes for one 100-byte text transfer (four 32-byte pages), calling
+ * service() between them the way the main loop does. Next to the measured
+ * EEPROM writes it prints the bytes the old write-through log changed for the
+ * same calls, each of which blocked the receiver for a full EEPROM write.
+ * Then it cuts the supply at every point of a flush and runs the sequence
+ * counter across its wrap. test/diaglog-batching.test.mjs checks the output.
+ *
+ * Output lines:
+ *   boot_writes <n>          EEPROM writes of the boot record
+ *   legacy_receive_writes <n> blocking writes of the old log during the frame
+ *   receive_writes <n>       EEPROM writes started before the frame completed
+ *   flush_writes <n>         EEPROM writes of the frame record
+ *   flush_passes <n>         service() calls needed for them
+ *   max_pass_writes <n>      most writes started by one service() call
+ *   torn_ok <n>/<m>          brown-out points that left the previous record intact
+ *   snapshot_ok <0|1>        a flush wrote the record as it was when the flush started
+ *   wrap_ok <0|1>            newest record still found after 600 flushes
+ */
+
+uint32_t host_eeprom_writes = 0;
+int32_t host_eeprom_write_budget = -1;
+
+namespace
+{
+// ModemReceiver::RxExpect values.
+enum : uint8_t
+{
+    START1,
+    START2,
+    NEXT_BLOCK,
+    PATTERN1,
+    PATTERN2,
+    HEADER1,
+    HEADER2,
+    META1,
+    META2,
+    DATA_FIRSTBLOCK,
+    DATA,
+};
+
+uint32_t legacy_writes = 0;
+uint8_t legacy_state = START1;
+uint32_t pass_writes_max = 0;
+
+/**
+ * Run one main loop pass worth of diagnostic log service.
+ */
+void loopPass()
+{
+    const uint32_t before = host_eeprom_writes;
+    diaglog::service();
+    const uint32_t written = host_eeprom_writes - before;
+    if (written > pass_writes_max)
+    {
+        pass_writes_max = written;
+    }
+}
+
+/**
+ * Forward a state change and count it the way the old log wrote it.
+ *
+ * @param state Receiver state.
+ */
+void state(uint8_t state)
+{
+    if (state != legacy_state)
+    {
+        legacy_state = state;
+        legacy_writes++;
+    }
+    diaglog::setState(state);
+    loopPass();
+}
+
+/**
+ * Forward a counter step; the old log rewrote the counter byte each time.
+ *
+ * @param mark Counter function.
+ */
+void count(void (*mark)())
+{
+    legacy_writes++;
+    mark();
+    loopPass();
+}
+
+/**
+ * Find the record a post-mortem reader would pick from the EEPROM image.
+ *
+ * @returns Newest complete record, or `nullptr`.
+ */
+const diaglog::Layout *newestRecord()
+{
+    const diaglog::Slot *best = nullptr;
+    for (const diaglog::Slot &slot : diaglog::ee_slots)
+    {
+        if (slot.commit != slot.seq || slot.log.magic != diaglog::kMagic || slot.log.version != diaglog::kVersion)
+        {
+            continue;
+        }
+        if (!best || static_cast<int8_t>(slot.seq - best->seq) > 0)
+        {
+            best = &slot;
+        }
+    }
+    return best ? &best->log : nullptr;
+}
+
+/**
+ * Replay the receiver's diagnostic calls for one complete text transfer.
+ */
+void receiveFrame()
+{
+    static const uint8_t kPage[32] = {0x01, 0x00, 0x00, 0x64};
+
+    state(START2);
+    state(NEXT_BLOCK);
+    count(diaglog::markStart);
+    state(PATTERN2);
+    count(diaglog::markPattern1);
+    state(HEADER1);
+    count(diaglog::markPattern2);
+    state(HEADER2);
+    state(META1);
+    diaglog::setLength(100);
+    legacy_writes++;
+    state(META2);
+    state(DATA_FIRSTBLOCK);
+    state(DATA);
+    diaglog::captureFirstPage(kPage);
+    legacy_writes += 4;
+    count(diaglog::markSave);
+    count(diaglog::markAppend);
+    count(diaglog::markAppend);
+    state(NEXT_BLOCK);
+    count(diaglog::markAppend);
+    count(diaglog::markEnd);
+    state(START1);
+}
+
+/**
+ * Boot, receive one frame, then flush a timeout record with a limited supply.
+ *
+ * @param budget EEPROM writes before the supply fails, or -1 for no failure.
+ * @returns EEPROM writes the timeout flush completed.
+ */
+uint32_t tornTimeoutFlush(int32_t budget)
+{
+    memset(diaglog::ee_slots, 0xFF, sizeof(diaglog::ee_slots));
+    diaglog::reset(0x02);
+    receiveFrame();
+    diaglog::markFrame();
+    diaglog::flush();
+
+    diaglog::markTimeout();
+    host_eeprom_writes = 0;
+    host_eeprom_write_budget = budget;
+    diaglog::flush();
+    host_eeprom_write_budget = -1;
+    return host_eeprom_writes;
+}
+} // namespace
+
+/**
+ * Run the probe.
+ *
+ * @returns Process exit code.
+ */
+int main()
+{
+    memset(diaglog::ee_slots, 0xFF, sizeof(diaglog::ee_slots));
+
+    diaglog::reset(0x02);
+    printf("boot_writes %u\n", (unsigned)host_eeprom_writes);
+    const diaglog::Layout *boot = newestRecord();
+    if (!boot || boot->reset_cause != 0x02)
+    {
+        fprintf(stderr, "boot record missing\n");
+        return 1;
+    }
+
+    host_eeprom_writes = 0;
+    receiveFrame();
+    printf("receive_writes %u\n", (unsigned)host_eeprom_writes);
+
+    // Frame complete: the counter step schedules the flush, then the loaded payload is captured.
+    diaglog::markFrame();
+    legacy_writes++;
+    static const uint8_t kLoaded[4] = {0x01, 0x00, 0x00, 0x64};
+    diaglog::captureLoaded(kLoaded, 1, true);
+    legacy_writes += 6;
+    printf("legacy_receive_writes %u\n", (unsigned)legacy_writes);
+
+    host_eeprom_writes = 0;
+    unsigned passes = 0;
+    const diaglog::Layout *frame = nullptr;
+    while (passes < 200)
+    {
+        loopPass();
+        passes++;
+        frame = newestRecord();
+        if (frame && frame->frame_count == 1)
+        {
+            break;
+        }
+    }
+    printf("flush_writes %u\n", (unsigned)host_eeprom_writes);
+    printf("flush_passes %u\n", passes);
+    printf("max_pass_writes %u\n", (unsigned)pass_writes_max);
+    if (!frame || frame->frame_count != 1 || frame->append_count != 3 || frame->length != 100 || frame->show_ok != 1)
+    {
+        fprintf(stderr, "frame record missing\n");
+        return 1;
+    }
+
+    // Cut the supply after every possible number of writes of the next flush.
+    const uint32_t timeout_writes = tornTimeoutFlush(-1);
+    unsigned torn_ok = 0;
+    for (uint32_t budget = 0; budget < timeout_writes; ++budget)
+    {
+        tornTimeoutFlush((int32_t)budget);
+        const diaglog::Layout *newest = newestRecord();
+        if (newest && newest->frame_count == 1 && newest->timeout_count == 0)
+        {
+            torn_ok++;
+        }
+    }
+    printf("torn_ok %u/%u\n", torn_ok, (unsigned)timeout_writes);
+
+    // Counters that move while a flush is running wait for the next flush.
+    memset(diaglog::ee_slots, 0xFF, sizeof(diaglog::ee_slots));
+    diaglog::reset(0x01);
+    diaglog::setLength(0x0102);
+    diaglog::markTimeout();
+    loopPass();
+    diaglog::setLength(0xFEFD);
+    diaglog::setStackFree(0x0304);
+    diaglog::markStart();
+    for (unsigned pass = 0; pass < 200; ++pass)
+    {
+        loopPass();
+    }
+    const diaglog::Layout *started = newestRecord();
+    bool snapshot_ok = started && started->timeout_count == 1 && started->length == 0x0102 &&
+                       started->stack_free == 0 && started->start_count == 0;
+    diaglog::flush();
+    const diaglog::Layout *next = newestRecord();
+    snapshot_ok = snapshot_ok && next && next->length == 0xFEFD && next->stack_free == 0x0304 && next->start_count == 1;
+    printf("snapshot_ok %u\n", snapshot_ok ? 1u : 0u);
+
+    // Sequence wrap: every flush must still be found as the newest record.
+    memset(diaglog::ee_slots, 0xFF, sizeof(diaglog::ee_slots));
+    diaglog::reset(0x01);
+    bool wrap_ok = true;
+    for (uint16_t i = 1; i <= 600; ++i)
+    {
+        diaglog::markTimeout();
+        diaglog::flush();
+        const diaglog::Layout *newest = newestRecord();
+        if (!newest || newest->timeout_count != (uint8_t)i)
+        {
+            wrap_ok = false;
+        }
+    }
+    printf("wrap_ok %u\n", wrap_ok ? 1u : 0u);
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Display.h"
+#include "Storage.h"
+#include "Timer.h"
+
+/*
+ * Host-side display simulator. It links the real Display.cpp, Buttons.cpp,
+ * font.h and static_patterns.h against port-register stubs, calls the multiplex ISR at
+ * every simulated compare match (honouring the periods it programs), and
+ * interleaves main-loop update() calls once per 256 us column slot the way
+ * System::loop does. Every full refresh whose 8 observed columns differ from
+ * the previous refresh is printed, so callers can rebuild the visible frame
+ * sequence and its timing.
+ *
+ * Usage:
+ *   DisplaySimHost [--boot | --pattern HEX] [--storage] [--refreshes N]
+ *                  [--loop-every TICKS] [--brightness LEVEL]
+ *
+ * Output lines:
+ *   F <refresh> <16 hex digits>   frame (columns 0..7, active-low rows) first shown at <refresh>
+ *   R <refresh>                   finite-repeat autoskip request raised
+ *   U <calls> <mean_ns> <max_ns>  wall time of Display::update()
+ *   D <lit> <total> <isr_calls>   timer ticks with a column driven, total ticks, ISR invocations
+ *   E <refresh>                   end of the simulated run
+ */
+
+volatile uint8_t PORTB;
+volatile uint8_t PORTD;
+volatile uint8_t DDRB;
+volatile uint8_t DDRD;
+volatile uint8_t SREG;
+volatile uint8_t PINC = 0xFF; // Both buttons released (pull-ups)
+
+// Buttons only times holds from millis() while the display timer is stopped.
+unsigned long millis()
+{
+    return 0;
+}
+
+void (*Timer::callback)() = nullptr;
+uint8_t Timer::clockSelectBits = 0;
+static uint16_t timer_period_ticks = 0;
+
+void Timer::initialize(unsigned int period_us)
+{
+    // Prescaler 1, like the real Timer for periods up to 8 ms.
+    timer_period_ticks = (uint16_t)((F_CPU / 1000000UL) * period_us);
+}
+
+void Timer::setPeriodTicks(uint16_t ticks)
+{
+    timer_period_ticks = ticks;
+}
+
+uint16_t Timer::periodTicks() const
+{
+    return timer_period_ticks;
+}
+
+void Timer::attachInterrupt(void (*isr)())
+{
+    callback = isr;
+}
+
+void Timer::start() {}
+
+void Timer::stop() {}
+
+/*
+ * Stored payload model for storage-backed playback. Only the chunk streaming
+ * used by Display is needed; chunk N is bytes 128*N.. of the payload.
+ */
+Storage storage;
+static uint8_t stored_payload[4096];
+
+void Storage::loadChunk(uint8_t chunk, uint8_t *data)
+{
+    memcpy(data, stored_payload + chunk * 128, 128);
+}
+
+static uint8_t payload[132];
+
+/**
+ * Parse a hex string into bytes.
+ *
+ * @param hex Input digits, two per byte.
+ * @param out Destination buffer.
+ * @param capacity Destination size in bytes.
+ * @returns Number of bytes parsed, or -1 for malformed input.
+ */
+static int parseHex(const char *hex, uint8_t *out, size_t capacity)
+{
+    const size_t digits = strlen(hex);
+    if ((digits & 1) != 0 || digits / 2 > capacity)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < digits / 2; ++i)
+    {
+        char byte[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char *end = nullptr;
+        out[i] = (uint8_t)strtoul(byte, &end, 16);
+        if (*end != 0)
+        {
+            return -1;
+        }
+    }
+    return (int)(digits / 2);
+}
+
+/**
+ * Decode a stored pattern header into an animation descriptor, mirroring
+ * showPayloadBuffer() in Receiver.cpp.
+ *
+ * @param bytes Pattern bytes beginning with the four-byte header.
+ * @param anim Destination descriptor.
+ * @returns `true` when the header describes a text or frames pattern.
+ */
+static bool decodePattern(const uint8_t *bytes, animation_t &anim)
+{
+    anim.type = static_cast<AnimationType>(bytes[0] >> 4);
+    if (anim.type != AnimationType::TEXT && anim.type != AnimationType::FRAMES)
+    {
+        return false;
+    }
+
+    anim.length = ((bytes[0] & 0x0F) << 8) | bytes[1];
+    if (anim.type == AnimationType::TEXT)
+    {
+        anim.speed = 250 - (bytes[2] & 0xF0);
+        anim.delay = (bytes[2] & 0x0F);
+        anim.direction = (bytes[3] >> 4) & 0x01;
+        anim.brightness = (bytes[3] >> 5);
+        anim.repeat = (bytes[3] & 0x0F);
+    }
+    else
+    {
+        anim.speed = 250 - ((bytes[2] & 0x0F) << 4);
+        anim.delay = (bytes[3] >> 4);
+        anim.direction = 0;
+        anim.brightness = (bytes[2] >> 4) & 0x07;
+        anim.repeat = (bytes[3] & 0x0F);
+    }
+    return anim.length != 0;
+}
+
+/**
+ * Run the simulation described by the command line.
+ *
+ * @returns Process exit code.
+ */
+int main(int argc, char **argv)
+{
+    const char *pattern_hex = nullptr;
+    bool boot = false;
+    bool storage_backed = false;
+    unsigned long refreshes = 1000;
+    unsigned long loop_every = 1;
+    unsigned long brightness = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--boot") == 0)
+        {
+            boot = true;
+        }
+        else if (strcmp(argv[i], "--storage") == 0)
+        {
+            storage_backed = true;
+        }
+        else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc)
+        {
+            pattern_hex = argv[++i];
+        }
+        else if (strcmp(argv[i], "--refreshes") == 0 && i + 1 < argc)
+        {
+            refreshes = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--loop-every") == 0 && i + 1 < argc)
+        {
+            loop_every = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--brightness") == 0 && i + 1 < argc)
+        {
+            brightness = strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (loop_every == 0 || (!boot && pattern_hex == nullptr))
+    {
+        fprintf(stderr, "need --boot or --pattern HEX, and --loop-every >= 1\n");
+        return 2;
+    }
+
+    display.enable();
+    const uint16_t column_ticks = timer_period_ticks;
+    if (brightness != 0)
+    {
+        display.setBrightness((uint8_t)brightness);
+    }
+
+    if (boot)
+    {
+        display.showBootMessage();
+    }
+    else
+    {
+        uint8_t bytes[4 + sizeof(stored_payload)];
+        const int count = parseHex(pattern_hex, bytes, sizeof(bytes));
+        animation_t anim;
+        if (count < 4 || !decodePattern(bytes, anim) || anim.length > count - 4)
+        {
+            fprintf(stderr, "malformed pattern\n");
+            return 2;
+        }
+
+        if (storage_backed)
+        {
+            // Storage::load() leaves the first chunk in the payload window.
+            memcpy(stored_payload, bytes + 4, count - 4);
+            memcpy(payload, stored_payload, 128);
+        }
+        else if (anim.length > 128)
+        {
+            fprintf(stderr, "RAM patterns are limited to 128 bytes; use --storage\n");
+            return 2;
+        }
+        else
+        {
+            memcpy(payload, bytes + 4, anim.length);
+        }
+        anim.data = payload;
+
+        if (storage_backed)
+        {
+            display.showFromStorage(&anim);
+        }
+        else
+        {
+            display.show(&anim);
+        }
+    }
+
+    uint8_t frame[8] = {0};
+    uint8_t shown[8];
+    memset(shown, 0xAA, sizeof(shown));
+    bool first = true;
+    unsigned long update_calls = 0;
+    uint64_t update_ns = 0;
+    uint64_t update_max_ns = 0;
+    uint64_t lit_ticks = 0;
+    uint64_t total_ticks = 0;
+    unsigned long isr_calls = 0;
+
+    for (unsigned long tick = 0; tick < refreshes * 8; ++tick)
+    {
+        // One column slot: the ISR may split it into a lit and a dark part.
+        uint32_t slot_ticks = 0;
+        do
+        {
+            Timer::callback();
+            isr_calls++;
+            const uint16_t period = timer_period_ticks;
+
+            // At most one column line is selected at a time.
+            for (uint8_t col = 0; col < 8; ++col)
+            {
+                if (PORTB == (1 << col))
+                {
+                    frame[col] = PORTD;
+                    lit_ticks += period;
+                }
+            }
+            slot_ticks += period;
+        } while (slot_ticks < column_ticks);
+        total_ticks += slot_ticks;
+
+        if ((tick & 7) == 7 && (first || memcmp(frame, shown, sizeof(frame)) != 0))
+        {
+            memcpy(shown, frame, sizeof(frame));
+            first = false;
+            printf("F %lu ", tick / 8);
+            for (uint8_t col = 0; col < 8; ++col)
+            {
+                printf("%02x", frame[col]);
+            }
+            printf("\n");
+        }
+
+        if ((tick % loop_every) == 0)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            display.update();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            const uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            update_calls++;
+            update_ns += ns;
+            if (ns > update_max_ns)
+            {
+                update_max_ns = ns;
+            }
+
+            if (display.consumeAnimationRepeatRequest())
+            {
+                printf("R %lu\n", tick / 8);
+            }
+        }
+    }
+
+    printf("U %lu %llu %llu\n", update_calls,
+           (unsigned long long)(update_calls ? update_ns / update_calls : 0),
+           (unsigned long long)update_max_ns);
+    printf("D %llu %llu %lu\n", (unsigned long long)lit_ticks, (unsigned long long)total_ticks, isr_calls);
+    printf("E %lu\n", refreshes);
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/io.h>
+
+#include "Display.h"
+#include "Modem.h"
+#include "Receiver.h" // Also brings in Storage.h, which has no include guard.
+#include "TwiBus.h"
+
+/*
+ * Host-side receive loopback probe. It links the real Modem.cpp,
+ * FECModem.cpp, Hamming.cpp, Receiver.cpp and Storage.cpp against a 24C64
+ * model and a recording display stub, then plays 10-bit ADC conversions read
+ * from stdin (uint16 little-endian) into the ADC interrupt handler, one call
+ * per conversion. ModemReceiver::process() runs every few conversions the way
+ * the receive task does on each main loop pass, and millis() follows the
+ * conversion count at the ADC rate. scripts/lib/loopback.mjs builds the input
+ * from transfer PCM and scores the output.
+ *
+ * Usage:
+ *   LoopbackHost [--rate HZ] [--process-every N]
+ *
+ * Output lines:
+ *   R <sample> <hex>          raw demodulated byte, before FEC
+ *   S <sample> <type> <len>   display.show() or showFromStorage() call
+ *   F <sample> <hex>...       frame complete; every stored pattern, header included
+ *   E <samples>               end of input
+ */
+
+volatile uint8_t PORTB;
+volatile uint8_t PORTD;
+volatile uint8_t DDRB;
+volatile uint8_t DDRD;
+volatile uint8_t SREG;
+volatile uint8_t DDRA;
+volatile uint8_t PORTA;
+volatile uint8_t ADMUX;
+volatile uint8_t ADCSRA;
+volatile uint8_t DIDR0;
+volatile uint16_t ADC;
+
+extern "C" void ADC_vect();
+
+static uint8_t eeprom[8192];
+static uint32_t sample_index = 0;
+static double adc_rate_hz = F_CPU / 32.0 / 13.0;
+
+TwiBus twiBus;
+
+void TwiBus::enable() {}
+
+TwiBus::Status TwiBus::waitReady(uint8_t)
+{
+    return OK;
+}
+
+TwiBus::Status TwiBus::read(uint8_t, uint8_t addrhi, uint8_t addrlo, uint8_t len, uint8_t *data)
+{
+    uint16_t addr = ((uint16_t)addrhi << 8) | addrlo;
+    for (uint8_t i = 0; i < len; ++i)
+    {
+        data[i] = eeprom[(addr + i) & 0x1FFF];
+    }
+    return OK;
+}
+
+TwiBus::Status TwiBus::write(uint8_t, uint8_t addrhi, uint8_t addrlo, uint8_t len, uint8_t *data)
+{
+    uint16_t addr = ((uint16_t)addrhi << 8) | addrlo;
+    uint16_t page = addr & 0x1FE0;
+    for (uint8_t i = 0; i < len; ++i)
+    {
+        eeprom[page | ((addr + i) & 0x1F)] = data[i];
+    }
+    return OK;
+}
+
+Display display;
+
+void Display::show(const animation_t *anim)
+{
+    printf("S %u %u %u\n", (unsigned)sample_index, (unsigned)anim->type, anim->length);
+}
+
+void Display::showFromStorage(const animation_t *anim)
+{
+    show(anim);
+}
+
+void Display::setIndicator(uint8_t, uint8_t, uint8_t) {}
+
+unsigned long millis()
+{
+    return (unsigned long)(sample_index * 1000.0 / adc_rate_hz);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)(sample_index * 1000000.0 / adc_rate_hz);
+}
+
+/**
+ * Print one stored pattern as the receiver left it: the four header bytes, then the payload.
+ *
+ * @param idx Pattern index.
+ */
+static void printStoredPattern(uint8_t idx)
+{
+    static uint8_t buf[132];
+    storage.load(idx, buf);
+    const uint16_t length = ((buf[0] & 0x0F) << 8) | buf[1];
+
+    printf(" ");
+    for (uint16_t i = 0; i < 4 + length && i < sizeof(buf); ++i)
+    {
+        printf("%02X", buf[i]);
+    }
+    // Storage hands out the payload after the first 128 bytes in 128-byte chunks.
+    for (uint16_t offset = 128; offset < length; offset += 128)
+    {
+        storage.loadChunk(offset / 128, buf);
+        for (uint16_t i = 0; i < 128 && offset + i < length; ++i)
+        {
+            printf("%02X", buf[i]);
+        }
+    }
+}
+
+/**
+ * Report a completed frame with every pattern it stored.
+ */
+static void printFrame()
+{
+    printf("F %u", (unsigned)sample_index);
+    for (uint8_t idx = 0; idx < storage.numPatterns(); ++idx)
+    {
+        printStoredPattern(idx);
+    }
+    printf("\n");
+}
+
+/**
+ * Run the receive stack over the ADC conversions on stdin.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments.
+ * @returns Process exit code.
+ */
+int main(int argc, char **argv)
+{
+    unsigned process_every = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--rate") && i + 1 < argc)
+        {
+            adc_rate_hz = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--process-every") && i + 1 < argc)
+        {
+            process_every = (unsigned)atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--rate HZ] [--process-every N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (adc_rate_hz <= 0 || process_every == 0)
+    {
+        fprintf(stderr, "rate and process interval must be positive\n");
+        return 2;
+    }
+
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    modemReceiver.begin();
+
+    static uint8_t input[4096];
+    size_t got;
+    while ((got = fread(input, 2, sizeof(input) / 2, stdin)) > 0)
+    {
+        for (size_t i = 0; i < got; ++i)
+        {
+            ADC = (uint16_t)(input[2 * i] | (input[2 * i + 1] << 8)) & 0x03FF;
+            ADC_vect();
+            sample_index++;
+
+            // The diagnostic ring holds every byte queued since it was last emptied, a start-marker lock's three included.
+            uint8_t recent[8];
+            const uint8_t n = g_modem.getRecentRaw(recent, sizeof(recent));
+            for (uint8_t k = 0; k < n; ++k)
+            {
+                printf("R %u %02X\n", (unsigned)sample_index, recent[k]);
+            }
+            g_modem.clearRecentRaw();
+
+            if (sample_index % process_every == 0)
+            {
+                modemReceiver.process();
+                if (modemReceiver.hasFrameComplete())
+                {
+                    printFrame();
+                }
+            }
+        }
+    }
+
+    modemReceiver.process();
+    if (modemReceiver.hasFrameComplete())
+    {
+        printFrame();
+    }
+    printf("E %u\n", (unsigned)sample_index);
+    return 0;
+}
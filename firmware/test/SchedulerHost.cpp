@@ -0,0 +1,155 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <Arduino.h>
+
+#include "Scheduler.h"
+#include "Trace.h"
+
+/*
+ * Host-side probe for the main loop scheduler. It links the real
+ * Scheduler.cpp against a simulated clock: every task advances the clock by
+ * its configured run time, and each pass starts on the next 256 us display
+ * column tick the way System::idle() wakes the loop. Build with
+ * -DSCHED_STATS=1 -DJP1_DEBUG_SERIAL so the trace records reach the stub
+ * below. test/scheduler.test.mjs checks the output.
+ *
+ * Output lines, one block per phase:
+ *   phase <name>
+ *   task <id> runs <n> worst <us> overruns <n> late <n>
+ *   busiest_pass <n>          most housekeeping tasks run in one pass
+ *   record <event> <arg>      trace records, as hexadecimal
+ */
+
+namespace
+{
+enum : uint8_t
+{
+    RECEIVE,
+    DISPLAY_UPDATE,
+    BUTTONS,
+    DRAIN,
+    SLEEPER,
+    kTasks
+};
+
+const sched::Task kTable[] PROGMEM = {
+    {RECEIVE, 0, 400},
+    {DISPLAY_UPDATE, 0, 400},
+    {BUTTONS, 10, 500},
+    {DRAIN, 2, 100},
+    {SLEEPER, 50, 100},
+};
+
+sched::TaskState states[kTasks];
+uint32_t now_us = 0;
+uint32_t cost_us[kTasks];
+uint32_t runs[kTasks];
+uint8_t housekeeping_this_pass = 0;
+uint8_t busiest_pass = 0;
+bool sleeper_sleeps = false;
+
+/**
+ * Scheduler callback: spend the task's run time on the simulated clock.
+ *
+ * @param id Task id.
+ */
+void runTask(uint8_t id)
+{
+    runs[id]++;
+    now_us += cost_us[id];
+    if (id != RECEIVE && id != DISPLAY_UPDATE)
+    {
+        housekeeping_this_pass++;
+    }
+    if (id == SLEEPER && sleeper_sleeps)
+    {
+        // Power down through one long pause, as System::sleepThroughPause_() does.
+        sleeper_sleeps = false;
+        now_us += 300000;
+        sched::resync();
+    }
+}
+
+/**
+ * Run passes on the column tick grid for a stretch of simulated time.
+ *
+ * @param name Phase name for the output.
+ * @param duration_us Simulated time to run.
+ */
+void runPhase(const char *name, uint32_t duration_us)
+{
+    memset(runs, 0, sizeof(runs));
+    busiest_pass = 0;
+    const uint32_t end = now_us + duration_us;
+    while (now_us < end)
+    {
+        housekeeping_this_pass = 0;
+        sched::runPass();
+        if (housekeeping_this_pass > busiest_pass)
+        {
+            busiest_pass = housekeeping_this_pass;
+        }
+        now_us = (now_us / 256 + 1) * 256;
+    }
+
+    printf("phase %s\n", name);
+    for (uint8_t id = 0; id < kTasks; ++id)
+    {
+        printf("task %u runs %u worst %u overruns %u late %u\n", id, (unsigned)runs[id], states[id].worst_us,
+               states[id].overruns, states[id].late);
+    }
+    printf("busiest_pass %u\n", busiest_pass);
+}
+} // namespace
+
+unsigned long millis()
+{
+    return now_us / 1000;
+}
+
+unsigned long micros()
+{
+    return now_us;
+}
+
+void trace::record(Event event, uint16_t arg)
+{
+    printf("record %02X %04X\n", event, arg);
+}
+
+/**
+ * Run the scheduler phases expected by test/scheduler.test.mjs.
+ *
+ * @returns Process exit code.
+ */
+int main()
+{
+    cost_us[RECEIVE] = 60;
+    cost_us[DISPLAY_UPDATE] = 40;
+    cost_us[BUTTONS] = 80;
+    cost_us[DRAIN] = 20;
+    cost_us[SLEEPER] = 10;
+    sched::begin(kTable, states, kTasks, runTask);
+
+    // Light load: every task keeps its period.
+    runPhase("steady", 1000000);
+
+    // One slow drain run sets a new worst time over budget.
+    cost_us[DRAIN] = 900;
+    runPhase("overrun", 3000);
+    cost_us[DRAIN] = 20;
+
+    // A 3 ms receive burst on every pass starves the 2 ms drain task.
+    cost_us[RECEIVE] = 3000;
+    runPhase("burst", 100000);
+    cost_us[RECEIVE] = 60;
+
+    // A task that sleeps for 300 ms is not charged for it, and nobody else is late afterwards.
+    sleeper_sleeps = true;
+    runPhase("sleep", 400000);
+
+    sched::report();
+    return 0;
+}
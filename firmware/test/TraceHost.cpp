@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "DebugSerial.h"
+#include "Trace.h"
+
+/*
+ * Host-side trace probe. It links the real Trace.cpp with a controllable
+ * millis() and a JP1 UART stub that copies every byte to stdout, then
+ * records a fixed event sequence. test/trace-ring.test.mjs decodes the output
+ * with scripts/lib/trace-decode.mjs. Build with -DTRACE_RING_SIZE=8.
+ */
+
+volatile uint8_t SREG;
+static unsigned long now_ms = 0;
+
+unsigned long millis()
+{
+    return now_ms;
+}
+
+void debuglog::write(uint8_t value)
+{
+    fputc(value, stdout);
+}
+
+uint8_t debuglog::txFree()
+{
+    return 0xFF;
+}
+
+void debuglog::flush() {}
+
+/**
+ * Send raw text the way the remaining string diagnostics do.
+ *
+ * @param text Text to copy to the capture.
+ */
+static void writeText(const char *text)
+{
+    while (*text)
+    {
+        debuglog::write((uint8_t)*text++);
+    }
+}
+
+/**
+ * Record the fixed event sequence expected by test/trace-ring.test.mjs.
+ *
+ * @returns Process exit code.
+ */
+int main()
+{
+    // Plain records with interleaved text.
+    now_ms = 100;
+    trace::record(trace::BOOT, 0x02);
+    now_ms = 150;
+    trace::record(trace::RX_BEGIN);
+    trace::flush();
+    writeText("HB\r\n");
+
+    // Overflow: 7 usable slots, so 3 of these 10 records are dropped.
+    now_ms = 1000;
+    for (uint16_t page = 0; page < 10; ++page)
+    {
+        trace::record(trace::STORAGE_APPEND, page);
+    }
+    if (!trace::drain())
+    {
+        return 1;
+    }
+    // The freed slot takes the overflow report, so this record is dropped too.
+    now_ms = 1200;
+    trace::record(trace::RX_FRAME);
+    trace::flush();
+    now_ms = 1300;
+    trace::record(trace::WAKE);
+    trace::flush();
+
+    // 16-bit timestamp wrap.
+    now_ms = 65000;
+    trace::record(trace::RX_END);
+    now_ms = 65536 + 200;
+    trace::record(trace::SHUTDOWN);
+    trace::flush();
+
+    return trace::drain() ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+ * Minimal Arduino.h stand-in for host-side firmware probes. It provides the
+ * fixed-width types, the clock constant, and the handful of port and status
+ * registers the display, button, trace and JP1 UART code touches. Probes that
+ * use the registers, millis() or micros() define them and observe the
+ * writes; the interrupt lock compiles away because host probes call the ISR
+ * handlers synchronously.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avr/pgmspace.h>
+
+#ifndef F_CPU
+#define F_CPU 8000000UL
+#endif
+
+#ifndef _BV
+#define _BV(bit) (1U << (bit))
+#endif
+
+extern volatile uint8_t PORTB;
+extern volatile uint8_t PORTD;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t DDRD;
+extern volatile uint8_t SREG;
+extern volatile uint8_t PINC;
+extern volatile uint8_t PORTC;
+extern volatile uint8_t DDRC;
+extern volatile uint8_t TCCR0A;
+extern volatile uint8_t TCNT0;
+extern volatile uint8_t OCR0A;
+extern volatile uint8_t TIMSK0;
+extern volatile uint8_t TIFR0;
+
+#define PC0 0
+#define PC3 3
+#define PC7 7
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define OCIE0A 1
+#define OCF0A 1
+#define SREG_I 7
+
+// Interrupt handlers become plain functions that a probe calls itself.
+#define ISR(vector) extern "C" void vector()
+
+unsigned long millis();
+unsigned long micros();
+
+static inline void cli() {}
+static inline void sei() {}
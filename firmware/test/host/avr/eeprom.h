@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+ * Host stand-in for avr/eeprom.h. EEMEM objects are ordinary memory on the
+ * host. Every byte write is counted, and host_eeprom_write_budget can cut the
+ * supply after a number of writes to model a brown-out.
+ */
+#include <stdint.h>
+
+#define EEMEM
+
+extern uint32_t host_eeprom_writes;
+extern int32_t host_eeprom_write_budget;
+
+inline uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+    return *addr;
+}
+
+inline void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+    if (host_eeprom_write_budget == 0)
+    {
+        return;
+    }
+    if (host_eeprom_write_budget > 0)
+    {
+        host_eeprom_write_budget--;
+    }
+    host_eeprom_writes++;
+    *addr = value;
+}
+
+inline void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+    if (*addr != value)
+    {
+        eeprom_write_byte(addr, value);
+    }
+}
+
+#define eeprom_is_ready() 1
+#define eeprom_busy_wait() \
+    do                     \
+    {                      \
+    } while (0)
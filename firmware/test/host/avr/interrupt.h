@@ -0,0 +1,7 @@
+#pragma once
+
+/*
+ * Host stand-in for avr/interrupt.h. ISR(), cli() and sei() already come from
+ * the Arduino.h stand-in.
+ */
+#include <Arduino.h>
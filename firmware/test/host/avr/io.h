@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+ * Host stand-in for avr/io.h. It declares the port A and ADC registers the
+ * modem touches, with the ATtiny88 bit positions. Probes that link Modem.cpp
+ * define the registers, write each conversion result to ADC and then call the
+ * ADC_vect handler themselves.
+ */
+#include <Arduino.h>
+
+extern volatile uint8_t DDRA;
+extern volatile uint8_t PORTA;
+extern volatile uint8_t ADMUX;
+extern volatile uint8_t ADCSRA;
+extern volatile uint8_t DIDR0;
+extern volatile uint16_t ADC;
+
+#define PA3 3
+
+#define REFS0 6
+
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define ADC4D 4
+#define ADC5D 5
+#define ADC6D 6
+#define ADC7D 7
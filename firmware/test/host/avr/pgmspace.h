@@ -0,0 +1,12 @@
+#pragma once
+
+/*
+ * Host stand-in for avr/pgmspace.h. Program memory is ordinary memory on the
+ * host, so the PROGMEM accessors become plain loads.
+ */
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_ptr(addr) (*(const void *const *)(addr))
@@ -0,0 +1,108 @@
+#include <string.h>
+
+#include "avr_twi.h"
+#include "sim_time.h"
+
+#include "Eeprom24c64.h"
+
+static const char *irq_names[2] = {
+    [TWI_IRQ_INPUT] = "8>24c64.out",
+    [TWI_IRQ_OUTPUT] = "32<24c64.in",
+};
+
+static void ack(eeprom_24c64_t *eeprom)
+{
+    avr_raise_irq(eeprom->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, eeprom->address_byte, 1));
+}
+
+/**
+ * Follow one TWI bus event from the AVR.
+ */
+static void bus_event(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    eeprom_24c64_t *eeprom = (eeprom_24c64_t *)param;
+    avr_twi_msg_irq_t message;
+    message.u.v = value;
+    (void)irq;
+
+    if (message.u.twi.msg & TWI_COND_STOP)
+    {
+        if (eeprom->selected && eeprom->written)
+        {
+            eeprom->busy_until = eeprom->avr->cycle + avr_usec_to_cycles(eeprom->avr, eeprom->write_cycle_us);
+            eeprom->write_cycles++;
+        }
+        eeprom->selected = 0;
+        eeprom->written = 0;
+    }
+
+    if (message.u.twi.msg & TWI_COND_ADDR)
+    {
+        eeprom->selected = 0;
+        if ((message.u.twi.addr & 0xFE) != eeprom->address_byte)
+        {
+            return;
+        }
+        // No acknowledge until the write cycle is over; TwiBus::waitReady() polls for this.
+        if (eeprom->avr->cycle < eeprom->busy_until)
+        {
+            eeprom->busy_nacks++;
+            return;
+        }
+        eeprom->selected = 1;
+        if (!(message.u.twi.addr & 0x01))
+        {
+            eeprom->address_count = 0;
+            eeprom->written = 0;
+        }
+        ack(eeprom);
+        return;
+    }
+
+    if (!eeprom->selected)
+    {
+        return;
+    }
+
+    if (message.u.twi.msg & TWI_COND_WRITE)
+    {
+        ack(eeprom);
+        if (eeprom->address_count < 2)
+        {
+            eeprom->word_address = (uint16_t)((eeprom->word_address << 8) | message.u.twi.data) & (EEPROM_24C64_SIZE - 1);
+            eeprom->address_count++;
+        }
+        else
+        {
+            eeprom->data[eeprom->word_address] = message.u.twi.data;
+            // Page writes wrap within the 32-byte page.
+            eeprom->word_address = (eeprom->word_address & ~(EEPROM_24C64_PAGE - 1))
+                | ((eeprom->word_address + 1) & (EEPROM_24C64_PAGE - 1));
+            eeprom->written = 1;
+        }
+    }
+
+    if (message.u.twi.msg & TWI_COND_READ)
+    {
+        avr_raise_irq(eeprom->irq + TWI_IRQ_INPUT,
+            avr_twi_irq_msg(TWI_COND_READ, eeprom->address_byte, eeprom->data[eeprom->word_address]));
+        eeprom->word_address = (eeprom->word_address + 1) & (EEPROM_24C64_SIZE - 1);
+    }
+}
+
+void eeprom_24c64_init(avr_t *avr, eeprom_24c64_t *eeprom, uint8_t address, uint32_t write_cycle_us)
+{
+    memset(eeprom, 0, sizeof(*eeprom));
+    memset(eeprom->data, 0xFF, sizeof(eeprom->data));
+    eeprom->avr = avr;
+    eeprom->address_byte = (uint8_t)(address << 1);
+    eeprom->write_cycle_us = write_cycle_us;
+    eeprom->irq = avr_alloc_irq(&avr->irq_pool, 0, 2, irq_names);
+    avr_irq_register_notify(eeprom->irq + TWI_IRQ_OUTPUT, bus_event, eeprom);
+}
+
+void eeprom_24c64_attach(avr_t *avr, eeprom_24c64_t *eeprom)
+{
+    avr_connect_irq(eeprom->irq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+    avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), eeprom->irq + TWI_IRQ_OUTPUT);
+}
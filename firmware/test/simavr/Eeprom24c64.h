@@ -0,0 +1,44 @@
+#ifndef EEPROM_24C64_H
+#define EEPROM_24C64_H
+
+#include <stdint.h>
+
+#include "sim_avr.h"
+#include "sim_irq.h"
+
+#define EEPROM_24C64_SIZE 8192
+#define EEPROM_24C64_PAGE 32
+
+/*
+ * 24C64 on the simavr TWI bus: two address bytes, 32-byte write pages that
+ * wrap within the page, sequential reads across the whole array, and a write
+ * cycle after each STOP during which the part does not acknowledge its
+ * address.
+ */
+typedef struct eeprom_24c64_t
+{
+    avr_irq_t *irq;
+    avr_t *avr;
+    uint8_t address_byte;  // 8-bit bus address, R/W bit clear
+    uint8_t selected;      // Addressed since the last START or STOP
+    uint8_t address_count; // Word address bytes received in this write
+    uint8_t written;       // Data bytes latched since the write was addressed
+    uint16_t word_address;
+    uint32_t write_cycle_us;
+    avr_cycle_count_t busy_until;
+    uint32_t write_cycles;  // Write cycles started
+    uint32_t busy_nacks;    // Addresses ignored during a write cycle
+    uint8_t data[EEPROM_24C64_SIZE];
+} eeprom_24c64_t;
+
+/**
+ * Set up an erased part at the 7-bit bus address `address`.
+ */
+void eeprom_24c64_init(avr_t *avr, eeprom_24c64_t *eeprom, uint8_t address, uint32_t write_cycle_us);
+
+/**
+ * Connect the part to the TWI module of `avr`.
+ */
+void eeprom_24c64_attach(avr_t *avr, eeprom_24c64_t *eeprom);
+
+#endif
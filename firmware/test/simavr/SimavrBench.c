@@ -0,0 +1,272 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avr_adc.h"
+#include "avr_ioport.h"
+#include "sim_avr.h"
+#include "sim_elf.h"
+
+#include "Eeprom24c64.h"
+#include "sim_tiny88.h"
+
+/*
+ * Cycle-accurate bench for the release firmware under simavr. It runs the
+ * unmodified .elf on the ATtiny88 core in sim_tiny88.c with a 24C64 on the
+ * TWI pins, and plays 10-bit ADC conversions read from stdin (uint16
+ * little-endian, at --rate) into the ADC input by simulated time, the same
+ * input LoopbackHost takes. The buttons on PC3 and PC7 are held released.
+ *
+ * Every column the display ISR drives is latched from PORTB (one-hot column)
+ * and PORTD (rows), and each change of the full 8-column picture is reported.
+ * Each interrupt is timed from its vector to the end of its reti, nested
+ * interrupts included. scripts/lib/simavr-bench.mjs builds the input and
+ * reads the output.
+ *
+ * Usage:
+ *   SimavrBench --elf FILE [--rate HZ] [--channel N] [--vcc MV] [--write-cycle-us US]
+ *
+ * Output lines:
+ *   F <cycle> <hex>                       display picture changed; eight column bytes
+ *   I <vector> <count> <min> <max> <sum>  cycles spent in one interrupt vector
+ *   T <writes> <nacks>                    24C64 write cycles and addresses it ignored while busy
+ *   M <hex>                               24C64 contents at the end
+ *   E <cycles>                            end of input
+ */
+
+#define F_CPU_HZ 8000000UL
+#define MAX_VECTORS 32
+#define MAX_NESTING 8
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} isr_stats_t;
+
+static uint16_t *conversions = NULL;
+static size_t conversion_count = 0;
+static double adc_rate_hz = F_CPU_HZ / 32.0 / 13.0;
+static uint32_t vcc_mv = 3000;
+static uint8_t adc_channel = 6;
+
+static uint8_t port_d = 0;
+static uint8_t columns[8];
+static uint8_t shown[8];
+static int shown_valid = 0;
+
+/**
+ * Read all of stdin into `conversions`.
+ */
+static int read_conversions(void)
+{
+    size_t capacity = 1 << 16;
+    conversions = malloc(capacity * sizeof(uint16_t));
+    uint8_t pair[2];
+    while (conversions && fread(pair, 1, 2, stdin) == 2)
+    {
+        if (conversion_count == capacity)
+        {
+            capacity *= 2;
+            conversions = realloc(conversions, capacity * sizeof(uint16_t));
+            if (!conversions)
+            {
+                break;
+            }
+        }
+        conversions[conversion_count++] = (uint16_t)(pair[0] | (pair[1] << 8)) & 0x03FF;
+    }
+    return conversions != NULL;
+}
+
+/**
+ * Put the conversion due at the current cycle on the ADC input as it starts sampling.
+ */
+static void adc_trigger(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    avr_t *avr = (avr_t *)param;
+    (void)irq;
+    (void)value;
+
+    size_t index = (size_t)((double)avr->cycle * adc_rate_hz / (double)avr->frequency);
+    uint32_t counts = index < conversion_count ? conversions[index] : 512;
+    // The middle of the code's voltage range, so rounding in simavr cannot move it to a neighbour.
+    uint32_t millivolts = (uint32_t)(((2 * counts + 1) * vcc_mv) / 2048);
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + adc_channel), millivolts);
+}
+
+static void port_d_changed(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    (void)irq;
+    (void)param;
+    port_d = (uint8_t)value;
+}
+
+/**
+ * Latch the rows when Display::multiplex() selects a column; report the picture after the last column.
+ */
+static void port_b_changed(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    avr_t *avr = (avr_t *)param;
+    (void)irq;
+
+    uint8_t select = (uint8_t)value;
+    if (!select || (select & (select - 1)))
+    {
+        return;
+    }
+    uint8_t column = 0;
+    while (!(select & 1))
+    {
+        select >>= 1;
+        column++;
+    }
+    columns[column] = port_d;
+
+    if (column == 7 && (!shown_valid || memcmp(columns, shown, sizeof(shown))))
+    {
+        memcpy(shown, columns, sizeof(shown));
+        shown_valid = 1;
+        printf("F %llu ", (unsigned long long)avr->cycle);
+        for (uint8_t i = 0; i < 8; ++i)
+        {
+            printf("%02x", shown[i]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *elf_path = NULL;
+    uint32_t write_cycle_us = 5000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--elf") && i + 1 < argc)
+        {
+            elf_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--rate") && i + 1 < argc)
+        {
+            adc_rate_hz = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--channel") && i + 1 < argc)
+        {
+            adc_channel = (uint8_t)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--vcc") && i + 1 < argc)
+        {
+            vcc_mv = (uint32_t)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--write-cycle-us") && i + 1 < argc)
+        {
+            write_cycle_us = (uint32_t)atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s --elf FILE [--rate HZ] [--channel N] [--vcc MV] [--write-cycle-us US]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!elf_path || adc_rate_hz <= 0 || adc_channel > 7 || vcc_mv == 0)
+    {
+        fprintf(stderr, "an .elf, a positive rate and VCC, and an ADC channel 0-7 are required\n");
+        return 2;
+    }
+    if (!read_conversions())
+    {
+        fprintf(stderr, "out of memory reading ADC input\n");
+        return 1;
+    }
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(elf_path, &firmware) != 0)
+    {
+        fprintf(stderr, "cannot load %s\n", elf_path);
+        return 1;
+    }
+
+    avr_t *avr = sim_tiny88_make();
+    if (!avr || avr_init(avr) != 0)
+    {
+        fprintf(stderr, "cannot create the ATtiny88 core\n");
+        return 1;
+    }
+    avr_load_firmware(avr, &firmware);
+    // A PlatformIO .elf carries no .mmcu section, so set the board clock and supply here.
+    avr->frequency = F_CPU_HZ;
+    avr->vcc = avr->avcc = vcc_mv;
+
+    static eeprom_24c64_t eeprom;
+    eeprom_24c64_init(avr, &eeprom, 0x50, write_cycle_us);
+    eeprom_24c64_attach(avr, &eeprom);
+
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_OUT_TRIGGER), adc_trigger, avr);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), IOPORT_IRQ_PIN_ALL), port_d_changed, avr);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), IOPORT_IRQ_PIN_ALL), port_b_changed, avr);
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 3), 1);
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 7), 1);
+
+    const uint8_t vector_count = sim_tiny88_vector_count();
+    const avr_flashaddr_t vector_end = (avr_flashaddr_t)vector_count * avr->vector_size;
+    static isr_stats_t stats[MAX_VECTORS];
+    uint8_t nested_vector[MAX_NESTING];
+    avr_cycle_count_t nested_entry[MAX_NESTING];
+    uint8_t depth = 0;
+    const avr_cycle_count_t end = (avr_cycle_count_t)((double)conversion_count / adc_rate_hz * (double)avr->frequency);
+
+    while (avr->cycle < end)
+    {
+        const avr_flashaddr_t pc = avr->pc;
+        const uint16_t opcode = (uint16_t)(avr->flash[pc] | (avr->flash[pc + 1] << 8));
+        const int reti = avr->state == cpu_Running && opcode == 0x9518;
+
+        const int state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed)
+        {
+            fprintf(stderr, "simulation stopped at pc 0x%04x, cycle %llu\n", avr->pc, (unsigned long long)avr->cycle);
+            return 1;
+        }
+
+        if (reti && depth > 0)
+        {
+            --depth;
+            isr_stats_t *entry = &stats[nested_vector[depth]];
+            const uint32_t cycles = (uint32_t)(avr->cycle - nested_entry[depth]);
+            entry->min = entry->count == 0 || cycles < entry->min ? cycles : entry->min;
+            entry->max = cycles > entry->max ? cycles : entry->max;
+            entry->sum += cycles;
+            entry->count++;
+        }
+        // The reset vector is only reached by a reset or __bad_interrupt, which are not interrupts to time.
+        if (avr->pc != pc && avr->pc >= avr->vector_size && avr->pc < vector_end
+            && avr->pc % avr->vector_size == 0 && depth < MAX_NESTING)
+        {
+            nested_vector[depth] = (uint8_t)(avr->pc / avr->vector_size);
+            nested_entry[depth] = avr->cycle;
+            depth++;
+        }
+    }
+
+    for (uint8_t vector = 1; vector < vector_count && vector < MAX_VECTORS; ++vector)
+    {
+        if (stats[vector].count)
+        {
+            printf("I %u %lu %lu %lu %llu\n", vector, (unsigned long)stats[vector].count,
+                (unsigned long)stats[vector].min, (unsigned long)stats[vector].max,
+                (unsigned long long)stats[vector].sum);
+        }
+    }
+    printf("T %lu %lu\n", (unsigned long)eeprom.write_cycles, (unsigned long)eeprom.busy_nacks);
+    printf("M ");
+    for (size_t i = 0; i < sizeof(eeprom.data); ++i)
+    {
+        printf("%02x", eeprom.data[i]);
+    }
+    printf("\nE %llu\n", (unsigned long long)avr->cycle);
+    return 0;
+}
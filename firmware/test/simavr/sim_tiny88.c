@@ -0,0 +1,235 @@
+/*
+ * ATtiny88 core for simavr, which ships no core for this part. It follows
+ * simavr's own cores (sim_megax8.h) and declares only the peripherals the
+ * firmware uses: ports A-D with pin change interrupts on port C, Timer0 for
+ * millis(), Timer1 for the display, the ADC, TWI and the watchdog.
+ *
+ * The ATtiny88 differs from the ATmega88 where it matters here: Timer0 has a
+ * single CTC0 bit and its clock select in TCCR0A, the ADC has only REFS0
+ * (internal 1.1 V or AVCC), and the vector table is laid out differently.
+ */
+#include "sim_avr.h"
+
+#define SIM_VECTOR_SIZE 2
+#define SIM_MMCU "attiny88"
+#define SIM_CORENAME mcu_tiny88
+
+// Register names as plain addresses, the way simavr's own cores include them.
+#define _AVR_IO_H_
+#define __ASSEMBLER__
+#include "avr/sfr_defs.h"
+#include "avr/iotn88.h"
+
+#include "sim_core_declare.h"
+#include "avr_adc.h"
+#include "avr_ioport.h"
+#include "avr_timer.h"
+#include "avr_twi.h"
+#include "avr_watchdog.h"
+
+#include "sim_tiny88.h"
+
+struct mcu_t
+{
+    avr_t core;
+    avr_watchdog_t watchdog;
+    avr_ioport_t porta, portb, portc, portd;
+    avr_timer_t timer0, timer1;
+    avr_adc_t adc;
+    avr_twi_t twi;
+};
+
+static void init(struct avr_t *avr)
+{
+    struct mcu_t *mcu = (struct mcu_t *)avr;
+
+    avr_watchdog_init(avr, &mcu->watchdog);
+    avr_ioport_init(avr, &mcu->porta);
+    avr_ioport_init(avr, &mcu->portb);
+    avr_ioport_init(avr, &mcu->portc);
+    avr_ioport_init(avr, &mcu->portd);
+    avr_timer_init(avr, &mcu->timer0);
+    avr_timer_init(avr, &mcu->timer1);
+    avr_adc_init(avr, &mcu->adc);
+    avr_twi_init(avr, &mcu->twi);
+}
+
+static void reset(struct avr_t *avr)
+{
+    (void)avr;
+}
+
+static const struct mcu_t SIM_CORENAME = {
+    .core = {
+        .mmcu = SIM_MMCU,
+        DEFAULT_CORE(SIM_VECTOR_SIZE),
+        .init = init,
+        .reset = reset,
+    },
+    .watchdog = {
+        .wdrf = AVR_IO_REGBIT(MCUSR, WDRF),
+        .wdce = AVR_IO_REGBIT(WDTCSR, WDCE),
+        .wde = AVR_IO_REGBIT(WDTCSR, WDE),
+        .wdp = {AVR_IO_REGBIT(WDTCSR, WDP0), AVR_IO_REGBIT(WDTCSR, WDP1),
+                AVR_IO_REGBIT(WDTCSR, WDP2), AVR_IO_REGBIT(WDTCSR, WDP3)},
+        .watchdog = {
+            .enable = AVR_IO_REGBIT(WDTCSR, WDIE),
+            .raised = AVR_IO_REGBIT(WDTCSR, WDIF),
+            .vector = WDT_vect_num,
+        },
+    },
+    .porta = {.name = 'A', .r_port = PORTA, .r_ddr = DDRA, .r_pin = PINA},
+    .portb = {.name = 'B', .r_port = PORTB, .r_ddr = DDRB, .r_pin = PINB},
+    // The buttons on PC3 and PC7 wake the badge through PCINT1.
+    .portc = {
+        .name = 'C',
+        .r_port = PORTC,
+        .r_ddr = DDRC,
+        .r_pin = PINC,
+        .pcint = {
+            .enable = AVR_IO_REGBIT(PCICR, PCIE1),
+            .raised = AVR_IO_REGBIT(PCIFR, PCIF1),
+            .vector = PCINT1_vect_num,
+        },
+        .r_pcint = PCMSK1,
+    },
+    .portd = {.name = 'D', .r_port = PORTD, .r_ddr = DDRD, .r_pin = PIND},
+    .timer0 = {
+        .name = '0',
+        .wgm = {AVR_IO_REGBIT(TCCR0A, CTC0)},
+        .wgm_op = {
+            [0] = AVR_TIMER_WGM_NORMAL8(),
+            [1] = AVR_TIMER_WGM_CTC(),
+        },
+        .cs = {AVR_IO_REGBIT(TCCR0A, CS00), AVR_IO_REGBIT(TCCR0A, CS01), AVR_IO_REGBIT(TCCR0A, CS02)},
+        .cs_div = {0, 0, 3 /* 8 */, 6 /* 64 */, 8 /* 256 */, 10 /* 1024 */},
+        .r_tcnt = TCNT0,
+        .overflow = {
+            .enable = AVR_IO_REGBIT(TIMSK0, TOIE0),
+            .raised = AVR_IO_REGBIT(TIFR0, TOV0),
+            .vector = TIMER0_OVF_vect_num,
+        },
+        .comp = {
+            [AVR_TIMER_COMPA] = {
+                .r_ocr = OCR0A,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK0, OCIE0A),
+                    .raised = AVR_IO_REGBIT(TIFR0, OCF0A),
+                    .vector = TIMER0_COMPA_vect_num,
+                },
+            },
+            [AVR_TIMER_COMPB] = {
+                .r_ocr = OCR0B,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK0, OCIE0B),
+                    .raised = AVR_IO_REGBIT(TIFR0, OCF0B),
+                    .vector = TIMER0_COMPB_vect_num,
+                },
+            },
+        },
+    },
+    .timer1 = {
+        .name = '1',
+        .disabled = AVR_IO_REGBIT(PRR, PRTIM1),
+        .wgm = {AVR_IO_REGBIT(TCCR1A, WGM10), AVR_IO_REGBIT(TCCR1A, WGM11),
+                AVR_IO_REGBIT(TCCR1B, WGM12), AVR_IO_REGBIT(TCCR1B, WGM13)},
+        .wgm_op = {
+            [0] = AVR_TIMER_WGM_NORMAL16(),
+            [4] = AVR_TIMER_WGM_CTC(),
+        },
+        .cs = {AVR_IO_REGBIT(TCCR1B, CS10), AVR_IO_REGBIT(TCCR1B, CS11), AVR_IO_REGBIT(TCCR1B, CS12)},
+        .cs_div = {0, 0, 3 /* 8 */, 6 /* 64 */, 8 /* 256 */, 10 /* 1024 */},
+        .r_tcnt = TCNT1L,
+        .r_tcnth = TCNT1H,
+        .overflow = {
+            .enable = AVR_IO_REGBIT(TIMSK1, TOIE1),
+            .raised = AVR_IO_REGBIT(TIFR1, TOV1),
+            .vector = TIMER1_OVF_vect_num,
+        },
+        .comp = {
+            [AVR_TIMER_COMPA] = {
+                .r_ocr = OCR1AL,
+                .r_ocrh = OCR1AH,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK1, OCIE1A),
+                    .raised = AVR_IO_REGBIT(TIFR1, OCF1A),
+                    .vector = TIMER1_COMPA_vect_num,
+                },
+            },
+            [AVR_TIMER_COMPB] = {
+                .r_ocr = OCR1BL,
+                .r_ocrh = OCR1BH,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK1, OCIE1B),
+                    .raised = AVR_IO_REGBIT(TIFR1, OCF1B),
+                    .vector = TIMER1_COMPB_vect_num,
+                },
+            },
+        },
+    },
+    .adc = {
+        .r_admux = ADMUX,
+        .mux = {AVR_IO_REGBIT(ADMUX, MUX0), AVR_IO_REGBIT(ADMUX, MUX1),
+                AVR_IO_REGBIT(ADMUX, MUX2), AVR_IO_REGBIT(ADMUX, MUX3)},
+        .ref = {AVR_IO_REGBIT(ADMUX, REFS0)},
+        .ref_values = {[0] = ADC_VREF_V110, [1] = ADC_VREF_AVCC},
+        .adlar = AVR_IO_REGBIT(ADMUX, ADLAR),
+        .r_adcsra = ADCSRA,
+        .aden = AVR_IO_REGBIT(ADCSRA, ADEN),
+        .adsc = AVR_IO_REGBIT(ADCSRA, ADSC),
+        .adate = AVR_IO_REGBIT(ADCSRA, ADATE),
+        .adps = {AVR_IO_REGBIT(ADCSRA, ADPS0), AVR_IO_REGBIT(ADCSRA, ADPS1), AVR_IO_REGBIT(ADCSRA, ADPS2)},
+        .r_adch = ADCH,
+        .r_adcl = ADCL,
+        .r_adcsrb = ADCSRB,
+        .adts = {AVR_IO_REGBIT(ADCSRB, ADTS0), AVR_IO_REGBIT(ADCSRB, ADTS1), AVR_IO_REGBIT(ADCSRB, ADTS2)},
+        .adts_op = {
+            [0] = avr_adts_free_running,
+        },
+        .muxmode = {
+            [0] = AVR_ADC_SINGLE(0), [1] = AVR_ADC_SINGLE(1),
+            [2] = AVR_ADC_SINGLE(2), [3] = AVR_ADC_SINGLE(3),
+            [4] = AVR_ADC_SINGLE(4), [5] = AVR_ADC_SINGLE(5),
+            [6] = AVR_ADC_SINGLE(6), [7] = AVR_ADC_SINGLE(7),
+            [14] = AVR_ADC_REF(1100),
+            [15] = AVR_ADC_REF(0),
+        },
+        .adc = {
+            .enable = AVR_IO_REGBIT(ADCSRA, ADIE),
+            .raised = AVR_IO_REGBIT(ADCSRA, ADIF),
+            .vector = ADC_vect_num,
+        },
+    },
+    .twi = {
+        .disabled = AVR_IO_REGBIT(PRR, PRTWI),
+        .r_twcr = TWCR,
+        .r_twsr = TWSR,
+        .r_twbr = TWBR,
+        .r_twdr = TWDR,
+        .r_twar = TWAR,
+        .r_twamr = TWAMR,
+        .twen = AVR_IO_REGBIT(TWCR, TWEN),
+        .twea = AVR_IO_REGBIT(TWCR, TWEA),
+        .twsta = AVR_IO_REGBIT(TWCR, TWSTA),
+        .twsto = AVR_IO_REGBIT(TWCR, TWSTO),
+        .twwc = AVR_IO_REGBIT(TWCR, TWWC),
+        .twsr = AVR_IO_REGBITS(TWSR, TWS3, 0x1f),
+        .twps = AVR_IO_REGBITS(TWSR, TWPS0, 0x3),
+        .twi = {
+            .enable = AVR_IO_REGBIT(TWCR, TWIE),
+            .raised = AVR_IO_REGBIT(TWCR, TWINT),
+            .raise_sticky = 1,
+            .vector = TWI_vect_num,
+        },
+    },
+};
+
+avr_t *sim_tiny88_make(void)
+{
+    return avr_core_allocate(&SIM_CORENAME.core, sizeof(struct mcu_t));
+}
+
+uint8_t sim_tiny88_vector_count(void)
+{
+    return _VECTORS_SIZE / SIM_VECTOR_SIZE;
+}
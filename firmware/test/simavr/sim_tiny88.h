@@ -0,0 +1,16 @@
+#ifndef SIM_TINY88_H
+#define SIM_TINY88_H
+
+#include "sim_avr.h"
+
+/**
+ * Allocate an ATtiny88 for avr_init().
+ */
+avr_t *sim_tiny88_make(void);
+
+/**
+ * Return the number of interrupt vectors, reset included.
+ */
+uint8_t sim_tiny88_vector_count(void);
+
+#endif
@@ -0,0 +1,222 @@
+#!/usr/bin/env node
+import { execFileSync } from 'node:child_process'
+import fs from 'node:fs'
+import { Writable } from 'node:stream'
+import { pipeline } from 'node:stream/promises'
+import { fileURLToPath } from 'node:url'
+import { parseArgs } from 'node:util'
+
+import {
+    TransferPcmStream,
+    createFramesPattern,
+    createTransferPcmBuffer,
+    createTransferPcmWriter
+} from './lib/transfer-tone.mjs'
+
+const USAGE = `Usage: npm run transfer:bench -- [options]
+
+  --sizes LIST        comma-separated pattern counts per transfer (default: 1,16,64,256)
+  --text-length N     payload bytes per pattern (default: 128)
+  --frames            send frame animations with that many column bytes instead of text
+  --modes LIST        buffer, chunk and/or stream (default: buffer,chunk,stream)
+  --out FILE          write chunk and stream output to FILE instead of discarding it
+  --json              print one JSON object per run instead of the table
+
+Every run happens in a fresh Node process, so the peak RSS belongs to that run alone.`
+
+const MODES = ['buffer', 'chunk', 'stream']
+const SAMPLES_PER_CHUNK = 4096
+
+/**
+ * Build a multi-pattern transfer of a fixed size.
+ *
+ * @param {number} count Number of patterns.
+ * @param {number} textLength Payload bytes per pattern.
+ * @param {boolean} frames `true` for frame animations, `false` for text.
+ * @returns {object[]} Patterns.
+ */
+function createBenchPatterns(count, textLength, frames) {
+    const patterns = []
+    for (let index = 0; index < count; index += 1) {
+        if (frames) {
+            const columns = Array.from({ length: textLength }, (_, offset) => (index + offset) & 0xff)
+            patterns.push(createFramesPattern({
+                frames: Array.from({ length: textLength / 8 }, (_, frame) => columns.slice(frame * 8, frame * 8 + 8))
+            }))
+            continue
+        }
+        patterns.push({
+            type: 'text',
+            text: `BENCH ${index} `.padEnd(textLength, 'X').slice(0, textLength),
+            speed: 0x0e,
+            delay: 0,
+            direction: 0,
+            repeat: 0,
+            brightness: 0
+        })
+    }
+    return patterns
+}
+
+/**
+ * Render one transfer in the requested mode and return the number of PCM bytes produced.
+ *
+ * @param {string} mode `buffer`, `chunk` or `stream`.
+ * @param {object[]} patterns Patterns to encode.
+ * @param {string|undefined} out Optional output file.
+ * @returns {Promise<number>} PCM byte count.
+ */
+async function render(mode, patterns, out) {
+    if (mode === 'buffer') {
+        return createTransferPcmBuffer(patterns).length
+    }
+
+    if (mode === 'chunk') {
+        // One chunk for the whole transfer; writeSync consumes it before the next read overwrites it.
+        const writer = createTransferPcmWriter(patterns)
+        const chunk = new Int16Array(SAMPLES_PER_CHUNK)
+        const bytes = new Uint8Array(chunk.buffer)
+        const fd = out ? fs.openSync(out, 'w') : null
+        let total = 0
+
+        for (let written = writer.read(chunk); written > 0; written = writer.read(chunk)) {
+            if (fd !== null) {
+                fs.writeSync(fd, bytes, 0, written * 2)
+            }
+            total += written * 2
+        }
+
+        if (fd !== null) {
+            fs.closeSync(fd)
+        }
+        return total
+    }
+
+    let total = 0
+    const sink = out
+        ? fs.createWriteStream(out)
+        : new Writable({
+            write(chunk, encoding, callback) {
+                callback()
+            }
+        })
+    const source = new TransferPcmStream(patterns, { samplesPerChunk: SAMPLES_PER_CHUNK })
+
+    source.on('data', (chunk) => {
+        total += chunk.length
+    })
+    await pipeline(source, sink)
+    return total
+}
+
+/**
+ * Run one measurement in this process and print it as JSON.
+ *
+ * @param {string} mode Render mode.
+ * @param {number} count Pattern count.
+ * @param {number} textLength Payload bytes per pattern.
+ * @param {boolean} frames `true` for frame animations.
+ * @param {string|undefined} out Optional output file.
+ */
+async function runChild(mode, count, textLength, frames, out) {
+    const patterns = createBenchPatterns(count, textLength, frames)
+    const start = process.hrtime.bigint()
+    const pcmBytes = await render(mode, patterns, out)
+    const seconds = Number(process.hrtime.bigint() - start) / 1e9
+
+    console.log(JSON.stringify({
+        mode,
+        patterns: count,
+        textBytes: count * textLength,
+        pcmBytes,
+        seconds,
+        mbPerSecond: pcmBytes / 1e6 / seconds,
+        peakRssMb: process.resourceUsage().maxRSS / 1024
+    }))
+}
+
+/**
+ * Format one run as a table row.
+ *
+ * @param {{mode: string, patterns: number, textBytes: number, pcmBytes: number, mbPerSecond: number, peakRssMb: number}} run Run result.
+ * @returns {string} Table row.
+ */
+function formatRow(run) {
+    return [
+        run.mode.padEnd(6),
+        String(run.patterns).padStart(8),
+        String(run.textBytes).padStart(10),
+        (run.pcmBytes / 1e6).toFixed(1).padStart(8),
+        run.mbPerSecond.toFixed(1).padStart(8),
+        run.peakRssMb.toFixed(1).padStart(10)
+    ].join('  ')
+}
+
+async function main() {
+    const { values } = parseArgs({
+        options: {
+            sizes: { type: 'string', default: '1,16,64,256' },
+            'text-length': { type: 'string', default: '128' },
+            modes: { type: 'string', default: MODES.join(',') },
+            frames: { type: 'boolean', default: false },
+            out: { type: 'string' },
+            json: { type: 'boolean', default: false },
+            child: { type: 'string' },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    const textLength = Number(values['text-length'])
+    if (!Number.isInteger(textLength) || textLength <= 0 || textLength > 0xfff) {
+        throw new RangeError('--text-length must be between 1 and 4095')
+    }
+    if (values.frames && textLength % 8 !== 0) {
+        throw new RangeError('--text-length must be a multiple of 8 with --frames')
+    }
+
+    if (values.child) {
+        const [mode, count] = values.child.split(':')
+        await runChild(mode, Number(count), textLength, values.frames, values.out)
+        return
+    }
+
+    const sizes = values.sizes.split(',').map(Number)
+    if (sizes.some((size) => !Number.isInteger(size) || size <= 0)) {
+        throw new RangeError('--sizes must list positive pattern counts')
+    }
+    const modes = values.modes.split(',')
+    for (const mode of modes) {
+        if (!MODES.includes(mode)) {
+            throw new RangeError(`unknown mode: ${mode}`)
+        }
+    }
+
+    if (!values.json) {
+        console.log('mode    patterns      text_B    PCM_MB      MB/s  peak_RSS_MB')
+    }
+
+    const script = fileURLToPath(import.meta.url)
+    for (const size of sizes) {
+        for (const mode of modes) {
+            const args = [script, '--child', `${mode}:${size}`, '--text-length', String(textLength)]
+            if (values.frames) {
+                args.push('--frames')
+            }
+            if (values.out) {
+                args.push('--out', values.out)
+            }
+            const line = execFileSync(process.execPath, args, { encoding: 'utf8' }).trim()
+            console.log(values.json ? line : formatRow(JSON.parse(line)))
+        }
+    }
+}
+
+main().catch((error) => {
+    console.error(`Transfer benchmark failed: ${error.message}`)
+    process.exitCode = 1
+})
@@ -0,0 +1,125 @@
+#!/usr/bin/env node
+import fs from 'node:fs'
+import { parseArgs } from 'node:util'
+
+import {
+    REFRESH_US,
+    encodeFramesPattern,
+    encodeGif,
+    encodePngStrip,
+    encodeTextPattern,
+    formatTimelineAscii,
+    frameHolds,
+    runDisplaySimulation
+} from './lib/display-sim.mjs'
+import { loadSpriteFrames } from './lib/sprite.mjs'
+
+const USAGE = `Usage: npm run display:sim -- [options]
+
+  --text TEXT         scroll TEXT (default: the boot message)
+  --pattern HEX       raw stored pattern bytes, header included
+  --image FILE        play a PNG sprite sheet or animated GIF of 8x8 frames
+  --image-scale N     pixels per LED in --image (default 1)
+  --image-gap N       pixels between --image cells (default 0)
+  --speed N           speed nibble 0-15 (default 14)
+  --delay N           pause nibble 0-15 (244 refreshes per step)
+  --direction N       0 = scroll left, 1 = scroll right
+  --repeat N          finite repeat count 0-15
+  --cap N             pattern brightness cap 1-7 (0 = follow the global level)
+  --brightness N      global brightness level 1-8 (default 8)
+  --storage           play through the 128-byte chunk streaming path
+  --refreshes N       simulated 2048 us refreshes (default 1000)
+  --loop-every N      call update() every N ticks to model a busy loop
+  --ascii             print the frame timeline
+  --png FILE          write the frames as a PNG strip
+  --gif FILE          write an animated GIF with real frame timing
+  --scale N           pixels per LED in images (default 4)`
+
+async function main() {
+    const { values } = parseArgs({
+        options: {
+            text: { type: 'string' },
+            pattern: { type: 'string' },
+            image: { type: 'string' },
+            'image-scale': { type: 'string', default: '1' },
+            'image-gap': { type: 'string', default: '0' },
+            speed: { type: 'string', default: '14' },
+            delay: { type: 'string', default: '0' },
+            direction: { type: 'string', default: '0' },
+            repeat: { type: 'string', default: '0' },
+            cap: { type: 'string', default: '0' },
+            brightness: { type: 'string', default: '0' },
+            storage: { type: 'boolean', default: false },
+            refreshes: { type: 'string', default: '1000' },
+            'loop-every': { type: 'string', default: '1' },
+            ascii: { type: 'boolean', default: false },
+            png: { type: 'string' },
+            gif: { type: 'string' },
+            scale: { type: 'string', default: '4' },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    let pattern
+    if (values.pattern) {
+        pattern = [...Buffer.from(values.pattern, 'hex')]
+    } else if (values.image) {
+        pattern = encodeFramesPattern({
+            frames: loadSpriteFrames(fs.readFileSync(values.image), {
+                scale: Number(values['image-scale']),
+                gap: Number(values['image-gap'])
+            }),
+            speed: Number(values.speed),
+            delay: Number(values.delay),
+            repeat: Number(values.repeat),
+            brightness: Number(values.cap)
+        })
+    } else if (values.text) {
+        pattern = encodeTextPattern({
+            text: values.text,
+            speed: Number(values.speed),
+            delay: Number(values.delay),
+            direction: Number(values.direction),
+            repeat: Number(values.repeat),
+            brightness: Number(values.cap)
+        })
+    }
+
+    const result = runDisplaySimulation({
+        pattern,
+        boot: pattern === undefined,
+        storage: values.storage,
+        refreshes: Number(values.refreshes),
+        loopEvery: Number(values['loop-every']),
+        brightness: Number(values.brightness)
+    })
+    const scale = Number(values.scale)
+
+    if (values.ascii) {
+        process.stdout.write(formatTimelineAscii(result))
+    }
+    if (values.png) {
+        fs.writeFileSync(values.png, encodePngStrip(result.frames.map((frame) => frame.columns), { scale }))
+    }
+    if (values.gif) {
+        fs.writeFileSync(values.gif, encodeGif(result, { scale }))
+    }
+
+    const holds = frameHolds(result).slice(1, -1)
+    const shortest = holds.length > 0 ? Math.min(...holds) : 0
+    console.log(`${result.frames.length} frames over ${result.refreshes} refreshes (${(result.refreshes * REFRESH_US) / 1000} ms)`)
+    console.log(`shortest interior hold: ${shortest} refreshes; repeat requests: ${result.repeats.length}`)
+    const duty = result.duty.totalTicks > 0 ? (100 * result.duty.litTicks) / result.duty.totalTicks : 0
+    console.log(`column duty: ${duty.toFixed(1)}%; multiplex ISR calls: ${result.duty.isrCalls}`)
+    console.log(`update(): ${result.update.calls} calls, mean ${result.update.meanNs} ns, max ${result.update.maxNs} ns (host wall time)`)
+}
+
+main().catch((error) => {
+    console.error(`Display simulation failed: ${error.message}`)
+    process.exitCode = 1
+})
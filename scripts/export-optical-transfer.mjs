@@ -0,0 +1,42 @@
+#!/usr/bin/env node
+import fs from 'node:fs'
+import { parseArgs } from 'node:util'
+
+import { OPTICAL_FPS, createOpticalPlayerHtml, encodeOpticalFrames } from './lib/optical-transfer.mjs'
+import { createTransferTestPattern, randomToken } from './lib/transfer-tone.mjs'
+
+const USAGE = `Usage: npm run transfer:optical -- [options]
+
+  --text TEXT         transmit a text pattern (repeatable; default: a transfer:test pattern)
+  --out FILE          write the flash player page here (default: optical-transfer.html)`
+
+async function main() {
+    const { values } = parseArgs({
+        options: {
+            text: { type: 'string', multiple: true },
+            out: { type: 'string', default: 'optical-transfer.html' },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    const patterns = values.text
+        ? values.text.map((text) => ({ ...createTransferTestPattern({ token: '' }), text }))
+        : [createTransferTestPattern({ token: randomToken(6) })]
+    const frames = encodeOpticalFrames(patterns)
+    fs.writeFileSync(values.out, createOpticalPlayerHtml(frames))
+
+    console.log(
+        `Wrote ${frames.length} frames (${(frames.length / OPTICAL_FPS).toFixed(1)} s at ${OPTICAL_FPS} fps) for `
+        + `${patterns.map((pattern) => `"${pattern.text}"`).join(', ')} -> ${values.out}`
+    )
+}
+
+main().catch((error) => {
+    console.error(`Optical export failed: ${error.message}`)
+    process.exitCode = 1
+})
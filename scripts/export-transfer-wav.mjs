@@ -0,0 +1,95 @@
+#!/usr/bin/env node
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { parseArgs } from 'node:util'
+
+import { generateBadges, parseManifest, planExport, runExport } from './lib/transfer-export.mjs'
+
+const USAGE = `Usage: npm run transfer:export -- [options] [MANIFEST]
+
+  MANIFEST            JSON badge manifest (see docs/bench-and-debug.md)
+  --generate N        export N single-pattern test badges instead of a manifest
+  --out-dir DIR       write one WAV per badge into DIR (default: wav)
+  --playlist FILE     write all badges into one WAV instead, separated by gaps
+  --gap SECONDS       silence between playlist entries (default: 2)
+  --seed SEED         derive {token} values from SEED so reruns are identical
+  --fast              send only the legacy format after a short sync (current firmware only)
+  --short-sync        cut the legacy sync to 12.5 ms; needs firmware with the start-marker correlator
+  --channels N        put N badges side by side in each WAV, one per output channel (default: 1)
+  --jobs N            worker threads (default: ${os.availableParallelism()})`
+
+async function main() {
+    const { values, positionals } = parseArgs({
+        allowPositionals: true,
+        options: {
+            generate: { type: 'string' },
+            'out-dir': { type: 'string', default: 'wav' },
+            playlist: { type: 'string' },
+            gap: { type: 'string', default: '2' },
+            seed: { type: 'string' },
+            fast: { type: 'boolean', default: false },
+            'short-sync': { type: 'boolean', default: false },
+            channels: { type: 'string', default: '1' },
+            jobs: { type: 'string', default: String(os.availableParallelism()) },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help || (positionals.length === 0) === (values.generate === undefined)) {
+        console.log(USAGE)
+        if (!values.help) {
+            process.exitCode = 1
+        }
+        return
+    }
+
+    const badges = values.generate === undefined
+        ? parseManifest(JSON.parse(fs.readFileSync(positionals[0], 'utf8')), {
+            seed: values.seed,
+            baseDir: path.dirname(positionals[0])
+        })
+        : generateBadges(Number(values.generate), { seed: values.seed })
+    const plan = planExport(badges, {
+        outDir: values['out-dir'],
+        playlist: values.playlist,
+        gapSeconds: Number(values.gap),
+        fast: values.fast,
+        shortSync: values['short-sync'],
+        channels: Number(values.channels)
+    })
+
+    const start = process.hrtime.bigint()
+    const workers = await runExport(plan, { jobs: Number(values.jobs) })
+    const seconds = Number(process.hrtime.bigint() - start) / 1e9
+
+    const samples = plan.jobs.reduce((sum, job) => sum + job.sampleCount, 0)
+    const bytes = samples * plan.channels * 2
+    const patternBytes = plan.jobs.reduce((sum, job) => sum + job.patternBytes, 0)
+    const audioSeconds = samples / plan.sampleRate
+
+    if (plan.playlist) {
+        // Cue list for looping the playlist at a provisioning station.
+        for (const job of plan.jobs) {
+            console.log(
+                `${(job.startSample / plan.sampleRate).toFixed(3).padStart(10)}s  `
+                + `${(job.sampleCount / plan.sampleRate).toFixed(3).padStart(8)}s  ${job.name}`
+            )
+        }
+    }
+
+    console.log(
+        `Rendered ${badges.length} badges, ${audioSeconds.toFixed(1)} s of audio on ${plan.channels} channel(s), `
+        + `in ${seconds.toFixed(2)} s with ${workers} workers (${(bytes / 1e6 / seconds).toFixed(1)} MB/s, `
+        + `${(audioSeconds / seconds).toFixed(0)}x real time) -> ${plan.playlist ? plan.playlist.path : values['out-dir']}`
+    )
+    console.log(
+        `Playback moves ${patternBytes} pattern bytes at ${(patternBytes / audioSeconds).toFixed(1)} B/s `
+        + `(${values.fast ? 'fast' : 'both formats'}, gaps excluded)`
+    )
+}
+
+main().catch((error) => {
+    console.error(`Transfer export failed: ${error.message}`)
+    process.exitCode = 1
+})
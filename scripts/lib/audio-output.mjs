@@ -1,18 +1,23 @@
 import Speaker from 'speaker'
 
 /**
- * Build the mono 16-bit speaker configuration used by the bench utilities.
+ * Build the 16-bit speaker configuration used by the bench utilities.
  *
  * @param {number} sampleRate PCM sample rate in hertz.
+ * @param {number} [channels=1] Interleaved output channels.
  * @returns {{channels: number, bitDepth: number, sampleRate: number, signed: boolean, float: boolean}} Speaker options.
  */
-export function createMonoSpeakerOptions(sampleRate) {
+export function createSpeakerOptions(sampleRate, channels = 1) {
     if (!Number.isInteger(sampleRate) || sampleRate <= 0) {
         throw new RangeError('sampleRate must be a positive integer')
     }
 
+    if (!Number.isInteger(channels) || channels <= 0) {
+        throw new RangeError('channels must be a positive integer')
+    }
+
     return {
-        channels: 1,
+        channels,
         bitDepth: 16,
         sampleRate,
         signed: true,
@@ -20,6 +25,16 @@ export function createMonoSpeakerOptions(sampleRate) {
     }
 }
 
+/**
+ * Build the mono 16-bit speaker configuration used by the bench utilities.
+ *
+ * @param {number} sampleRate PCM sample rate in hertz.
+ * @returns {{channels: number, bitDepth: number, sampleRate: number, signed: boolean, float: boolean}} Speaker options.
+ */
+export function createMonoSpeakerOptions(sampleRate) {
+    return createSpeakerOptions(sampleRate, 1)
+}
+
 /**
  * Create a mono speaker instance for raw PCM playback.
  *
@@ -32,20 +47,21 @@ export function createMonoSpeaker(sampleRate, SpeakerClass = Speaker) {
 }
 
 /**
- * Play a PCM buffer once and resolve when the speaker finishes or closes.
+ * Play a PCM buffer or stream once and resolve when the speaker finishes or closes.
  *
- * @param {Buffer} buffer PCM payload to play.
- * @param {{sampleRate: number, SpeakerClass?: typeof Speaker}} [options={}] Playback options.
+ * @param {Buffer|import('node:stream').Readable} buffer PCM payload to play, or a stream that produces it.
+ * @param {{sampleRate: number, channels?: number, SpeakerClass?: typeof Speaker}} [options={}] Playback options;
+ *     `channels` is the interleaved channel count of the PCM (default 1).
  * @returns {Promise<void>} Resolves after playback finishes.
  */
-export function playBufferOnce(buffer, { sampleRate, SpeakerClass = Speaker } = {}) {
+export function playBufferOnce(buffer, { sampleRate, channels = 1, SpeakerClass = Speaker } = {}) {
     return new Promise((resolve, reject) => {
         let settled = false
         let speaker
 
         try {
             // Allow Speaker injection so the CLI can be tested without opening a real audio device.
-            speaker = createMonoSpeaker(sampleRate, SpeakerClass)
+            speaker = new SpeakerClass(createSpeakerOptions(sampleRate, channels))
         } catch (error) {
             reject(error)
             return
@@ -76,6 +92,13 @@ export function playBufferOnce(buffer, { sampleRate, SpeakerClass = Speaker } =
         speaker.once('error', fail)
         speaker.once('close', finish)
         speaker.once('finish', finish)
-        speaker.end(buffer)
+        if (Buffer.isBuffer(buffer)) {
+            speaker.end(buffer)
+            return
+        }
+
+        // Streams are piped so long transfers play without rendering the whole waveform first.
+        buffer.once('error', fail)
+        buffer.pipe(speaker)
     })
 }
@@ -0,0 +1,442 @@
+import { spawnSync } from 'node:child_process'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+import { deflateSync } from 'node:zlib'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..', '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+
+// One full 8-column multiplex refresh at the 256 us TIMER1 tick.
+export const REFRESH_US = 2048
+
+const PNG_SIGNATURE = Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a])
+// Palette: gap between frames, unlit LED, lit LED.
+const PALETTE = [
+    [0x10, 0x10, 0x10],
+    [0x30, 0x08, 0x00],
+    [0xff, 0x30, 0x00],
+    [0x00, 0x00, 0x00]
+]
+
+let simulatorPath = null
+
+/**
+ * Build the two-byte length header shared by text and frame patterns.
+ *
+ * @param {number} type Pattern type nibble (1 = text, 2 = frames).
+ * @param {number} length Payload length in bytes.
+ * @returns {number[]} Header bytes.
+ */
+function createLengthHeader(type, length) {
+    if (length < 1 || length > 0x0fff) {
+        throw new RangeError(`pattern length ${length} is out of range`)
+    }
+    return [(type << 4) | (length >> 8), length & 0xff]
+}
+
+/**
+ * Encode a text pattern in the stored four-byte-header layout read by the firmware.
+ *
+ * @param {{text: string, speed?: number, delay?: number, direction?: number, repeat?: number, brightness?: number}} pattern
+ *     Text and raw header fields. `delay` counts `244`-refresh pause steps;
+ *     `brightness` 1-7 caps the display level, 0 follows the global level.
+ * @returns {number[]} Stored pattern bytes.
+ */
+export function encodeTextPattern({ text, speed = 0x0e, delay = 0, direction = 0, repeat = 0, brightness = 0 }) {
+    const data = [...Buffer.from(text, 'ascii')]
+    return [
+        ...createLengthHeader(1, data.length),
+        ((speed & 0x0f) << 4) | (delay & 0x0f),
+        ((brightness & 0x07) << 5) | ((direction & 0x01) << 4) | (repeat & 0x0f),
+        ...data
+    ]
+}
+
+/**
+ * Encode a frame animation in the stored four-byte-header layout read by the firmware.
+ *
+ * @param {{frames: number[][], speed?: number, delay?: number, repeat?: number, brightness?: number}} pattern
+ *     Frames as eight column bytes each (bit set = LED lit) and raw header
+ *     fields; `brightness` works as for text patterns.
+ * @returns {number[]} Stored pattern bytes.
+ */
+export function encodeFramesPattern({ frames, speed = 0x0e, delay = 0, repeat = 0, brightness = 0 }) {
+    const data = frames.flatMap((columns) => {
+        if (columns.length !== 8) {
+            throw new RangeError('each frame needs exactly 8 columns')
+        }
+        return columns.map((column) => column & 0xff)
+    })
+    return [
+        ...createLengthHeader(2, data.length),
+        ((brightness & 0x07) << 4) | (speed & 0x0f),
+        ((delay & 0x0f) << 4) | (repeat & 0x0f),
+        ...data
+    ]
+}
+
+/**
+ * Compile the host display simulator once per process.
+ *
+ * @returns {string} Path to the simulator binary.
+ */
+export function buildDisplaySimulator() {
+    if (simulatorPath) {
+        return simulatorPath
+    }
+
+    const output = path.join(os.tmpdir(), `blinkenstar-display-sim-${process.pid}`)
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-O2',
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'Display'),
+            '-I', path.join(firmwareRoot, 'lib', 'Buttons'),
+            '-I', path.join(firmwareRoot, 'lib', 'Storage'),
+            '-I', path.join(firmwareRoot, 'lib', 'TwiBus'),
+            '-I', path.join(firmwareRoot, 'lib', 'Timer'),
+            '-I', path.join(firmwareRoot, 'lib', 'System'),
+            path.join(firmwareRoot, 'test', 'DisplaySimHost.cpp'),
+            path.join(firmwareRoot, 'lib', 'Display', 'Display.cpp'),
+            path.join(firmwareRoot, 'lib', 'Buttons', 'Buttons.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+
+    if (compile.status !== 0) {
+        throw new Error(`display simulator build failed:\n${compile.stderr || compile.stdout}`)
+    }
+
+    simulatorPath = output
+    return output
+}
+
+/**
+ * Run the display simulator and parse its frame log.
+ *
+ * @param {{pattern?: number[], boot?: boolean, storage?: boolean, refreshes?: number, loopEvery?: number, brightness?: number}} options
+ *     Pattern bytes or the boot message, run length in refreshes, the
+ *     main-loop period in 256 us ticks, and the global brightness level.
+ * @returns {{frames: {refresh: number, columns: number[]}[], repeats: number[], refreshes: number,
+ *     update: {calls: number, meanNs: number, maxNs: number},
+ *     duty: {litTicks: number, totalTicks: number, isrCalls: number}}} Parsed simulation result.
+ */
+export function runDisplaySimulation({ pattern, boot = false, storage = false, refreshes = 1000, loopEvery = 1, brightness = 0 } = {}) {
+    const args = ['--refreshes', String(refreshes), '--loop-every', String(loopEvery)]
+    if (brightness) {
+        args.push('--brightness', String(brightness))
+    }
+    if (boot) {
+        args.push('--boot')
+    } else {
+        args.push('--pattern', Buffer.from(pattern).toString('hex'))
+    }
+    if (storage) {
+        args.push('--storage')
+    }
+
+    const run = spawnSync(buildDisplaySimulator(), args, { encoding: 'utf8', maxBuffer: 64 * 1024 * 1024 })
+    if (run.status !== 0) {
+        throw new Error(`display simulator failed: ${run.stderr || run.stdout}`)
+    }
+
+    const result = {
+        frames: [],
+        repeats: [],
+        refreshes,
+        update: { calls: 0, meanNs: 0, maxNs: 0 },
+        duty: { litTicks: 0, totalTicks: 0, isrCalls: 0 }
+    }
+    for (const line of run.stdout.split('\n')) {
+        const [kind, ...fields] = line.split(' ')
+        if (kind === 'F') {
+            const columns = []
+            for (let i = 0; i < 16; i += 2) {
+                columns.push(parseInt(fields[1].slice(i, i + 2), 16))
+            }
+            result.frames.push({ refresh: Number(fields[0]), columns })
+        } else if (kind === 'R') {
+            result.repeats.push(Number(fields[0]))
+        } else if (kind === 'U') {
+            result.update = { calls: Number(fields[0]), meanNs: Number(fields[1]), maxNs: Number(fields[2]) }
+        } else if (kind === 'D') {
+            result.duty = { litTicks: Number(fields[0]), totalTicks: Number(fields[1]), isrCalls: Number(fields[2]) }
+        }
+    }
+    return result
+}
+
+/**
+ * Return how many refreshes each captured frame stayed on the matrix.
+ *
+ * @param {{frames: {refresh: number}[], refreshes: number}} result Simulation result.
+ * @returns {number[]} Hold time per frame in refreshes.
+ */
+export function frameHolds(result) {
+    return result.frames.map((frame, i) => {
+        const next = i + 1 < result.frames.length ? result.frames[i + 1].refresh : result.refreshes
+        return next - frame.refresh
+    })
+}
+
+/**
+ * Find frames that were only visible for part of an animation step. A frame
+ * written while the multiplexer is mid-scan shows up as a short-lived mix of
+ * two steps, so any interior frame held for fewer refreshes than the step
+ * threshold is reported.
+ *
+ * @param {{frames: {refresh: number}[], refreshes: number}} result Simulation result.
+ * @param {number} minHold Shortest legitimate hold in refreshes.
+ * @returns {number[]} Refresh indices of the suspicious frames.
+ */
+export function findTornFrames(result, minHold) {
+    const holds = frameHolds(result)
+    const torn = []
+    for (let i = 1; i < holds.length - 1; i++) {
+        if (holds[i] < minHold) {
+            torn.push(result.frames[i].refresh)
+        }
+    }
+    return torn
+}
+
+/**
+ * Check whether one LED is lit in an active-low column byte.
+ *
+ * @param {number} column Active-low row mask as driven on PORTD.
+ * @param {number} row Row index.
+ * @returns {boolean} `true` when the LED is lit.
+ */
+function isLit(column, row) {
+    return (column & (1 << row)) === 0
+}
+
+/**
+ * Render one 8x8 frame as text, `#` for lit and `.` for dark LEDs.
+ *
+ * @param {number[]} columns Eight active-low column bytes.
+ * @returns {string} Eight lines, row 0 first.
+ */
+export function formatFrameAscii(columns) {
+    const lines = []
+    for (let row = 0; row < 8; row++) {
+        lines.push(columns.map((column) => (isLit(column, row) ? '#' : '.')).join(''))
+    }
+    return lines.join('\n')
+}
+
+/**
+ * Render a simulation result as a text timeline for golden comparisons.
+ *
+ * @param {{frames: {refresh: number, columns: number[]}[], repeats: number[]}} result Simulation result.
+ * @returns {string} `@<refresh>` headers followed by each frame, plus `repeat @<refresh>` markers.
+ */
+export function formatTimelineAscii(result) {
+    const events = [
+        ...result.frames.map((frame) => ({ refresh: frame.refresh, order: 0, text: `@${frame.refresh}\n${formatFrameAscii(frame.columns)}` })),
+        ...result.repeats.map((refresh) => ({ refresh, order: 1, text: `repeat @${refresh}` }))
+    ]
+    events.sort((a, b) => a.refresh - b.refresh || a.order - b.order)
+    return `${events.map((event) => event.text).join('\n')}\n`
+}
+
+/**
+ * Rasterize frames into palette indices.
+ *
+ * @param {number[][]} frameColumns Frames as eight active-low column bytes each.
+ * @param {number} scale Pixels per LED.
+ * @param {boolean} strip `true` to lay the frames out side by side with a gap.
+ * @returns {{width: number, height: number, pixels: Uint8Array[]}} One index image per frame, or one strip.
+ */
+function rasterize(frameColumns, scale, strip) {
+    const cell = 8 * scale
+    const gap = strip ? scale : 0
+    const width = strip ? frameColumns.length * (cell + gap) - gap : cell
+    const height = cell
+    const images = strip ? [new Uint8Array(width * height)] : frameColumns.map(() => new Uint8Array(width * height))
+
+    frameColumns.forEach((columns, index) => {
+        const image = strip ? images[0] : images[index]
+        const left = strip ? index * (cell + gap) : 0
+        for (let col = 0; col < 8; col++) {
+            for (let row = 0; row < 8; row++) {
+                const value = isLit(columns[col], row) ? 2 : 1
+                for (let y = 0; y < scale; y++) {
+                    const base = (row * scale + y) * width + left + col * scale
+                    image.fill(value, base, base + scale)
+                }
+            }
+        }
+    })
+
+    return { width, height, pixels: images }
+}
+
+/**
+ * Compute the CRC-32 used by PNG chunks.
+ *
+ * @param {Buffer} buffer Input bytes.
+ * @returns {number} Unsigned CRC.
+ */
+function crc32(buffer) {
+    let crc = 0xffffffff
+    for (const byte of buffer) {
+        crc ^= byte
+        for (let bit = 0; bit < 8; bit++) {
+            crc = (crc >>> 1) ^ (0xedb88320 & -(crc & 1))
+        }
+    }
+    return (crc ^ 0xffffffff) >>> 0
+}
+
+/**
+ * Build one PNG chunk.
+ *
+ * @param {string} type Four-character chunk type.
+ * @param {Buffer} data Chunk payload.
+ * @returns {Buffer} Length, type, payload and CRC.
+ */
+function pngChunk(type, data) {
+    const head = Buffer.alloc(8)
+    head.writeUInt32BE(data.length, 0)
+    head.write(type, 4, 'ascii')
+    const crc = Buffer.alloc(4)
+    crc.writeUInt32BE(crc32(Buffer.concat([head.subarray(4), data])), 0)
+    return Buffer.concat([head, data, crc])
+}
+
+/**
+ * Encode frames as a horizontal PNG strip.
+ *
+ * @param {number[][]} frameColumns Frames as eight active-low column bytes each.
+ * @param {{scale?: number}} [options={}] Pixels per LED.
+ * @returns {Buffer} PNG file contents.
+ */
+export function encodePngStrip(frameColumns, { scale = 4 } = {}) {
+    const { width, height, pixels } = rasterize(frameColumns, scale, true)
+    const header = Buffer.alloc(13)
+    header.writeUInt32BE(width, 0)
+    header.writeUInt32BE(height, 4)
+    header[8] = 8 // bit depth
+    header[9] = 3 // indexed color
+
+    const raw = Buffer.alloc((width + 1) * height)
+    for (let y = 0; y < height; y++) {
+        raw.set(pixels[0].subarray(y * width, (y + 1) * width), y * (width + 1) + 1)
+    }
+
+    return Buffer.concat([
+        PNG_SIGNATURE,
+        pngChunk('IHDR', header),
+        pngChunk('PLTE', Buffer.from(PALETTE.flat())),
+        pngChunk('IDAT', deflateSync(raw)),
+        pngChunk('IEND', Buffer.alloc(0))
+    ])
+}
+
+/**
+ * LZW-compress palette indices for a GIF image block.
+ *
+ * @param {Uint8Array} indices Pixel indices.
+ * @param {number} minCodeSize GIF minimum code size.
+ * @returns {number[]} Packed code stream bytes.
+ */
+function gifLzw(indices, minCodeSize) {
+    const clearCode = 1 << minCodeSize
+    const endCode = clearCode + 1
+    const out = []
+    let bits = 0
+    let bitCount = 0
+    let codeSize = minCodeSize + 1
+    let nextCode = endCode + 1
+    let table = new Map()
+
+    const emit = (code) => {
+        bits |= code << bitCount
+        bitCount += codeSize
+        while (bitCount >= 8) {
+            out.push(bits & 0xff)
+            bits >>>= 8
+            bitCount -= 8
+        }
+    }
+
+    emit(clearCode)
+    let prefix = indices[0]
+    for (let i = 1; i < indices.length; i++) {
+        const key = (prefix << 8) | indices[i]
+        const code = table.get(key)
+        if (code !== undefined) {
+            prefix = code
+            continue
+        }
+
+        emit(prefix)
+        if (nextCode === 4096) {
+            emit(clearCode)
+            table = new Map()
+            codeSize = minCodeSize + 1
+            nextCode = endCode + 1
+        } else {
+            if (nextCode >= 1 << codeSize) {
+                codeSize++
+            }
+            table.set(key, nextCode++)
+        }
+        prefix = indices[i]
+    }
+    emit(prefix)
+    emit(endCode)
+    if (bitCount > 0) {
+        out.push(bits & 0xff)
+    }
+    return out
+}
+
+/**
+ * Encode a simulation result as a looping animated GIF with real frame timing.
+ *
+ * @param {{frames: {refresh: number, columns: number[]}[], refreshes: number}} result Simulation result.
+ * @param {{scale?: number}} [options={}] Pixels per LED.
+ * @returns {Buffer} GIF file contents.
+ */
+export function encodeGif(result, { scale = 4 } = {}) {
+    const { width, height, pixels } = rasterize(result.frames.map((frame) => frame.columns), scale, false)
+    const holds = frameHolds(result)
+    const bytes = [...Buffer.from('GIF89a', 'ascii')]
+    const word = (value) => bytes.push(value & 0xff, value >> 8)
+
+    word(width)
+    word(height)
+    bytes.push(0xf1, 0, 0) // global 4-entry palette
+    bytes.push(...PALETTE.flat())
+    bytes.push(0x21, 0xff, 0x0b, ...Buffer.from('NETSCAPE2.0', 'ascii'), 0x03, 0x01, 0x00, 0x00, 0x00)
+
+    pixels.forEach((image, index) => {
+        const centiseconds = Math.max(2, Math.round((holds[index] * REFRESH_US) / 10000))
+        bytes.push(0x21, 0xf9, 0x04, 0x00)
+        word(centiseconds)
+        bytes.push(0x00, 0x00)
+
+        bytes.push(0x2c)
+        word(0)
+        word(0)
+        word(width)
+        word(height)
+        bytes.push(0x00, 2)
+        const data = gifLzw(image, 2)
+        for (let offset = 0; offset < data.length; offset += 255) {
+            const block = data.slice(offset, offset + 255)
+            bytes.push(block.length, ...block)
+        }
+        bytes.push(0x00)
+    })
+
+    bytes.push(0x3b)
+    return Buffer.from(bytes)
+}
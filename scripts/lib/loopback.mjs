@@ -0,0 +1,376 @@
+import { spawnSync } from 'node:child_process'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { createLightSamples, encodeOpticalFrames } from './optical-transfer.mjs'
+import { SAMPLE_RATE, createTransferPcmBuffer, createTransferPcmWriter, encodeTransferPayloads } from './transfer-tone.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..', '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+
+// Free-running ADC at F_CPU / 32 prescaler / 13 cycles per conversion, as Modem::begin() sets it up in release builds.
+export const ADC_RATE_HZ = 8000000 / 32 / 13
+
+// The release environment's receive flags; extra defines are appended after these.
+const RELEASE_DEFINES = ['ENABLE_MODEM', 'RX_ALWAYS_ON', 'MODEM_ADC_CHANNEL=6']
+
+// What env:optical in platformio.ini adds to the release flags; the ADC channel makes no difference on the host.
+export const OPTICAL_DEFINES = ['MODEM_OPTICAL', 'MODEM_NUMBER_OF_SAMPLES=64', 'MODEM_BITLEN_THRESHOLD=18', 'MODEM_DISABLE_FRONTEND_BIAS']
+
+// The last legacy symbol only closes on the next level change, which is the start of the alternate section.
+const FORMAT_BOUNDARY_MARGIN_S = 0.05
+
+export const DEFAULT_CHANNEL = Object.freeze({
+    level: 300,
+    bias: 512,
+    noise: 0,
+    clip: 1,
+    driftPpm: 0,
+    dropoutsPerSecond: 0,
+    dropoutMs: 20,
+    leadSeconds: 0.1,
+    tailSeconds: 0.5,
+    seed: 1
+})
+
+const probePaths = new Map()
+
+/**
+ * Compile the host loopback probe once per process and define set.
+ *
+ * @param {string[]} [defines=[]] Extra firmware build flags as `NAME` or `NAME=VALUE`.
+ * @returns {string} Path to the probe binary.
+ */
+export function buildLoopbackProbe(defines = []) {
+    const key = defines.join(' ')
+    if (probePaths.has(key)) {
+        return probePaths.get(key)
+    }
+
+    const output = path.join(os.tmpdir(), `blinkenstar-loopback-${process.pid}-${probePaths.size}`)
+    const lib = (name) => path.join(firmwareRoot, 'lib', name)
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-O2',
+            ...[...RELEASE_DEFINES, ...defines].map((define) => `-D${define}`),
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            ...['Modem', 'Hamming', 'Display', 'Storage', 'TwiBus', 'System', 'Trace'].flatMap((name) => ['-I', lib(name)]),
+            path.join(firmwareRoot, 'test', 'LoopbackHost.cpp'),
+            path.join(lib('Modem'), 'Modem.cpp'),
+            path.join(lib('Modem'), 'FECModem.cpp'),
+            path.join(lib('Modem'), 'Receiver.cpp'),
+            path.join(lib('Hamming'), 'Hamming.cpp'),
+            path.join(lib('Storage'), 'Storage.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+
+    if (compile.status !== 0) {
+        throw new Error(`loopback probe build failed:\n${compile.stderr || compile.stdout}`)
+    }
+
+    probePaths.set(key, output)
+    return output
+}
+
+/**
+ * Create a small seeded PRNG so channel impairments repeat exactly for a given seed.
+ *
+ * @param {number} seed Integer seed.
+ * @returns {() => number} Uniform generator on [0, 1).
+ */
+function createRandom(seed) {
+    let state = seed >>> 0
+    return () => {
+        // mulberry32
+        state = (state + 0x6d2b79f5) >>> 0
+        let value = state
+        value = Math.imul(value ^ (value >>> 15), value | 1)
+        value ^= value + Math.imul(value ^ (value >>> 7), value | 61)
+        return ((value ^ (value >>> 14)) >>> 0) / 4294967296
+    }
+}
+
+/**
+ * Run PCM through the analog channel model and sample it the way the ADC does.
+ *
+ * The signal is resampled to the ADC rate with a clock mismatch of `driftPpm` and overdriven so that it saturates at
+ * `clip` of full scale (1 = no clipping). It then spans `level` ADC counts either side of `bias`. It is muted during
+ * random dropouts and gets Gaussian noise of `noise` counts RMS.
+ *
+ * @param {Int16Array} samples Transmitted PCM.
+ * @param {number} sampleRate PCM sample rate in hertz.
+ * @param {Partial<typeof DEFAULT_CHANNEL>} [channel={}] Channel parameters.
+ * @returns {Uint16Array} 10-bit ADC conversions.
+ */
+export function sampleAdc(samples, sampleRate, channel = {}) {
+    const { level, bias, noise, clip, driftPpm, dropoutsPerSecond, dropoutMs, leadSeconds, tailSeconds, seed } = {
+        ...DEFAULT_CHANNEL,
+        ...channel
+    }
+    const random = createRandom(seed)
+    const step = (sampleRate / ADC_RATE_HZ) * (1 + driftPpm * 1e-6)
+    const lead = Math.round(leadSeconds * ADC_RATE_HZ)
+    const count = lead + Math.ceil(samples.length / step) + Math.round(tailSeconds * ADC_RATE_HZ)
+    const dropoutStart = dropoutsPerSecond / ADC_RATE_HZ
+    const dropoutLength = Math.round((dropoutMs / 1000) * ADC_RATE_HZ)
+    const adc = new Uint16Array(count)
+    let muted = 0
+
+    for (let index = 0; index < count; index += 1) {
+        let value = 0
+        const position = (index - lead) * step
+        if (position >= 0 && position < samples.length - 1) {
+            const base = Math.floor(position)
+            const fraction = position - base
+            value = (samples[base] * (1 - fraction) + samples[base + 1] * fraction) / 32767
+        }
+
+        if (muted > 0) {
+            muted -= 1
+            value = 0
+        } else if (dropoutStart > 0 && random() < dropoutStart) {
+            muted = dropoutLength
+        }
+
+        value = Math.max(-1, Math.min(1, value / clip)) * level + bias
+        if (noise > 0) {
+            // Box-Muller; 1 - random() keeps the logarithm finite.
+            value += noise * Math.sqrt(-2 * Math.log(1 - random())) * Math.cos(2 * Math.PI * random())
+        }
+        adc[index] = Math.max(0, Math.min(1023, Math.round(value)))
+    }
+
+    return adc
+}
+
+/**
+ * Run ADC conversions through the firmware receive stack.
+ *
+ * @param {Uint16Array} adc ADC conversions.
+ * @param {{defines?: string[], processEvery?: number}} [options={}] Probe options.
+ * @returns {{raw: Array<{sample: number, byte: number}>, frames: Array<{sample: number, patterns: number[][]}>, shows: Array<{sample: number, type: number, length: number}>, samples: number}}
+ *     Raw demodulated bytes, completed frames with every stored pattern, and display calls, by ADC sample index.
+ */
+export function runLoopbackProbe(adc, { defines = [], processEvery = 5 } = {}) {
+    const probe = buildLoopbackProbe(defines)
+    const run = spawnSync(probe, ['--rate', String(ADC_RATE_HZ), '--process-every', String(processEvery)], {
+        input: Buffer.from(adc.buffer, adc.byteOffset, adc.byteLength),
+        encoding: 'utf8',
+        maxBuffer: 256 * 1024 * 1024
+    })
+
+    if (run.status !== 0) {
+        throw new Error(`loopback probe failed:\n${run.stderr}`)
+    }
+
+    const result = { raw: [], frames: [], shows: [], samples: 0 }
+    for (const line of run.stdout.split('\n')) {
+        const [kind, sample, ...fields] = line.split(' ')
+        if (kind === 'R') {
+            result.raw.push({ sample: Number(sample), byte: parseInt(fields[0], 16) })
+        } else if (kind === 'F') {
+            result.frames.push({ sample: Number(sample), patterns: fields.map((hex) => [...Buffer.from(hex, 'hex')]) })
+        } else if (kind === 'S') {
+            result.shows.push({ sample: Number(sample), type: Number(fields[0]), length: Number(fields[1]) })
+        } else if (kind === 'E') {
+            result.samples = Number(sample)
+        }
+    }
+    return result
+}
+
+/**
+ * Count differing bits between two bytes.
+ *
+ * @param {number} value XOR of the two bytes.
+ * @returns {number} Set bit count.
+ */
+function popcount(value) {
+    let count = 0
+    for (let bits = value; bits; bits &= bits - 1) {
+        count += 1
+    }
+    return count
+}
+
+/**
+ * Align the received raw bytes with the transmitted FEC bytes and count bit errors.
+ *
+ * Every shift of the expected sequence against the received one is tried and the best is kept. Expected bytes with
+ * no received counterpart count as eight errors each, so a lost byte never looks better than a wrong one.
+ *
+ * @param {number[]} received Raw demodulated bytes.
+ * @param {number[]} expected Transmitted FEC bytes.
+ * @returns {number} Bit errors at the best alignment.
+ */
+export function alignedBitErrors(received, expected) {
+    let best = expected.length * 8
+
+    for (let shift = -expected.length + 1; shift < received.length; shift += 1) {
+        let errors = 0
+        for (let index = 0; index < expected.length && errors < best; index += 1) {
+            const at = index + shift
+            errors += at >= 0 && at < received.length ? popcount(received[at] ^ expected[index]) : 8
+        }
+        best = Math.min(best, errors)
+    }
+
+    return best
+}
+
+/**
+ * Build the pattern bytes the receiver should store for one transfer format.
+ *
+ * @param {number[]} rawBytes Raw frame bytes of that format, markers included.
+ * @param {number} startLength Start marker length.
+ * @returns {number[][]} Header, metadata and payload of each pattern.
+ */
+function expectedStoredPatterns(rawBytes, startLength) {
+    const patterns = []
+    // Each block is two marker bytes, a 12-bit length header, two metadata bytes and the payload.
+    for (let offset = startLength; offset + 4 <= rawBytes.length;) {
+        const length = ((rawBytes[offset + 2] & 0x0f) << 8) | rawBytes[offset + 3]
+        if ((rawBytes[offset + 2] >> 4) === 0) {
+            break
+        }
+        patterns.push(rawBytes.slice(offset + 2, offset + 6 + length))
+        offset += 6 + length
+    }
+    return patterns
+}
+
+/**
+ * Score one loopback run against the transfer that produced it.
+ *
+ * Frames and raw bytes are attributed to a format by when they arrived: the alternate section starts
+ * `legacySamples` PCM samples after `leadSeconds`, and the legacy section keeps a short margin past that.
+ *
+ * @param {ReturnType<typeof runLoopbackProbe>} result Probe output.
+ * @param {object[]} patterns Transmitted patterns.
+ * @param {{legacySamples: number, sampleRate: number, leadSeconds: number, driftPpm?: number, fast?: boolean}} timing
+ *     Transfer timing; `fast` for a single-format transfer, which only has the legacy section.
+ * @returns {Array<{format: string, rawBits: number, rawBitErrors: number, rawBer: number, frameOk: boolean, payloadBitErrors: number|null}>}
+ *     One score per format sent.
+ */
+export function scoreLoopback(result, patterns, { legacySamples, sampleRate, leadSeconds, driftPpm = 0, fast = false }) {
+    const payloads = encodeTransferPayloads(patterns)
+    const legacySeconds = legacySamples / sampleRate / (1 + driftPpm * 1e-6)
+    const boundary = Math.round((leadSeconds + legacySeconds + FORMAT_BOUNDARY_MARGIN_S) * ADC_RATE_HZ)
+    const formats = [
+        { format: 'legacy', fec: payloads.legacyFecBytes, stored: expectedStoredPatterns(payloads.legacyRawBytes, 4), from: 0, to: boundary },
+        { format: 'alternate', fec: payloads.modernFecBytes, stored: expectedStoredPatterns(payloads.modernRawBytes, 2), from: boundary, to: Infinity }
+    ]
+
+    return formats.slice(0, fast ? 1 : formats.length).map(({ format, fec, stored, from, to }) => {
+        const received = result.raw.filter((entry) => entry.sample >= from && entry.sample < to).map((entry) => entry.byte)
+        const rawBitErrors = alignedBitErrors(received, fec)
+        const frame = result.frames.find((entry) => entry.sample >= from && entry.sample < to)
+        let payloadBitErrors = null
+
+        if (frame) {
+            const got = frame.patterns.flat()
+            const want = stored.flat()
+            payloadBitErrors = Math.abs(got.length - want.length) * 8
+            for (let index = 0; index < Math.min(got.length, want.length); index += 1) {
+                payloadBitErrors += popcount(got[index] ^ want[index])
+            }
+        }
+
+        return {
+            format,
+            rawBits: fec.length * 8,
+            rawBitErrors,
+            rawBer: rawBitErrors / (fec.length * 8),
+            frameOk: payloadBitErrors === 0,
+            payloadBitErrors
+        }
+    })
+}
+
+/**
+ * Pass PCM through the channel model and the firmware receive stack.
+ *
+ * @param {Int16Array} samples Transmitted or recorded PCM.
+ * @param {number} sampleRate PCM sample rate in hertz.
+ * @param {Partial<typeof DEFAULT_CHANNEL>} [channel={}] Channel parameters.
+ * @param {{defines?: string[], processEvery?: number}} [options={}] Probe options.
+ * @returns {{result: ReturnType<typeof runLoopbackProbe>, audioSeconds: number, wallSeconds: number}}
+ *     Probe output and the audio and wall-clock durations.
+ */
+export function loopbackPcm(samples, sampleRate, channel = {}, options = {}) {
+    // Build first so the one-off compile does not count against the real-time factor.
+    buildLoopbackProbe(options.defines)
+    const start = process.hrtime.bigint()
+    const adc = sampleAdc(samples, sampleRate, channel)
+    const result = runLoopbackProbe(adc, options)
+
+    return {
+        result,
+        audioSeconds: adc.length / ADC_RATE_HZ,
+        wallSeconds: Number(process.hrtime.bigint() - start) / 1e9
+    }
+}
+
+/**
+ * Render a transfer, pass it through the channel model and the firmware receive stack, and score the result.
+ *
+ * @param {object[]} patterns Patterns to transmit.
+ * @param {Partial<typeof DEFAULT_CHANNEL>} [channel={}] Channel parameters.
+ * @param {{defines?: string[], processEvery?: number, fast?: boolean, shortSync?: boolean}} [options={}] Probe options,
+ *     and the transfer options `fast` and `shortSync` as for createTransferPcmWriter().
+ * @returns {{scores: ReturnType<typeof scoreLoopback>, result: ReturnType<typeof runLoopbackProbe>, audioSeconds: number, wallSeconds: number}}
+ *     Scores per format, the raw probe output, and the audio and wall-clock durations.
+ */
+export function loopbackTransfer(patterns, channel = {}, options = {}) {
+    const settings = { ...DEFAULT_CHANNEL, ...channel }
+    const fast = options.fast ?? false
+    const transfer = { fast, shortSync: options.shortSync ?? false }
+    const pcm = createTransferPcmBuffer(patterns, transfer)
+    const run = loopbackPcm(new Int16Array(pcm.buffer, pcm.byteOffset, pcm.length / 2), SAMPLE_RATE, settings, options)
+
+    return {
+        scores: scoreLoopback(run.result, patterns, {
+            legacySamples: createTransferPcmWriter(patterns, transfer).legacySampleCount,
+            sampleRate: SAMPLE_RATE,
+            leadSeconds: settings.leadSeconds,
+            driftPpm: settings.driftPpm,
+            fast
+        }),
+        ...run
+    }
+}
+
+/**
+ * Flash a transfer on a modelled screen, pass the light sensor output through the optical receive build, and score it.
+ *
+ * The light model pads the transfer with idle screen itself, so the channel adds no lead or tail of its own.
+ *
+ * @param {object[]} patterns Patterns to transmit.
+ * @param {Parameters<typeof createLightSamples>[1]} [light={}] Display and room model.
+ * @param {Partial<typeof DEFAULT_CHANNEL>} [channel={}] Channel parameters.
+ * @param {{defines?: string[], processEvery?: number}} [options={}] Probe options; `defines` add to OPTICAL_DEFINES.
+ * @returns {{scores: ReturnType<typeof scoreLoopback>, result: ReturnType<typeof runLoopbackProbe>, audioSeconds: number, wallSeconds: number}}
+ *     Score of the legacy stream the frames carry, the raw probe output, and the signal and wall-clock durations.
+ */
+export function loopbackOptical(patterns, light = {}, channel = {}, options = {}) {
+    const settings = { ...DEFAULT_CHANNEL, ...channel, leadSeconds: 0, tailSeconds: 0 }
+    const samples = createLightSamples(encodeOpticalFrames(patterns), { ...light, sampleRate: SAMPLE_RATE })
+    const run = loopbackPcm(samples, SAMPLE_RATE, settings, { ...options, defines: [...OPTICAL_DEFINES, ...(options.defines ?? [])] })
+
+    return {
+        scores: scoreLoopback(run.result, patterns, {
+            legacySamples: samples.length,
+            sampleRate: SAMPLE_RATE,
+            leadSeconds: 0,
+            driftPpm: settings.driftPpm,
+            fast: true
+        }),
+        ...run
+    }
+}
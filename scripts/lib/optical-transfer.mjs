@@ -0,0 +1,166 @@
+import { SAMPLE_RATE, encodeTransferPayloads } from './transfer-tone.mjs'
+
+const INT16_MAX = 32767
+
+// The flash player paces frames by time, so any display refreshing at least this often shows every frame.
+export const OPTICAL_FPS = 60
+
+// Frames per legacy symbol. The optical build sums 64 conversions per window, 3.3 ms, so at 60 fps a short symbol is
+// 10 windows and a long one 25. A late frame moves a symbol edge by one frame, 5 windows, either way: a short symbol
+// stays at or below 15 windows and a long one at or above 20, either side of the 18-window bit threshold.
+const SHORT_FRAMES = 2
+const LONG_FRAMES = 5
+
+// The modem restarts byte alignment after 72 idle windows, 240 ms; half a second also lets the page settle.
+const SYNC_FRAMES = 30
+const TAIL_FRAMES = 6
+
+/**
+ * Encode patterns as a sequence of display frames for the optical receive build.
+ *
+ * The frames carry the legacy FEC stream with the audio transfer's symbol rules: bits go least significant first,
+ * every symbol toggles between a dark gap and a lit pulse, and a bit 1 lasts 2.5 times as long as a bit 0. The sequence
+ * starts with a dark sync, and a short closing pulse ends the last gap.
+ *
+ * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+ * @returns {Uint8Array} One entry per frame, 1 for a lit screen.
+ */
+export function encodeOpticalFrames(patterns) {
+    const { legacyFecBytes } = encodeTransferPayloads(patterns)
+    const frames = [Array(SYNC_FRAMES).fill(0)]
+    let lit = 0
+
+    for (const byte of legacyFecBytes) {
+        for (let bit = 0; bit < 8; bit += 1) {
+            lit ^= 1
+            frames.push(Array((byte >> bit) & 1 ? LONG_FRAMES : SHORT_FRAMES).fill(lit))
+        }
+    }
+
+    if (!lit) {
+        frames.push(Array(SHORT_FRAMES).fill(1))
+    }
+    frames.push(Array(TAIL_FRAMES).fill(0))
+
+    return Uint8Array.from(frames.flat())
+}
+
+/**
+ * Build a standalone web page that flashes the encoded frames full screen.
+ *
+ * The page stays dark until clicked, then shows frame `floor(t * fps)` on every animation frame, so a display that
+ * refreshes faster than `fps` holds each frame for several refreshes and a late refresh only delays the next edge.
+ *
+ * @param {Uint8Array} frames Frames from encodeOpticalFrames().
+ * @param {{fps?: number, title?: string}} [options={}] Player frame rate and page title.
+ * @returns {string} HTML document.
+ */
+export function createOpticalPlayerHtml(frames, { fps = OPTICAL_FPS, title = 'Blinkenstar optical transfer' } = {}) {
+    const seconds = (frames.length / fps).toFixed(1)
+    const escapedTitle = title.replace(/[&<>"]/g, (char) => `&#${char.charCodeAt(0)};`)
+
+    return `<!doctype html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>${escapedTitle}</title>
+<style>
+html, body { margin: 0; height: 100%; background: #000; color: #888; font: 16px sans-serif; cursor: pointer; }
+#status { position: fixed; inset: 0; display: flex; align-items: center; justify-content: center; text-align: center; }
+</style>
+</head>
+<body>
+<div id="status">Hold the badge light sensors against the screen, then click to send (${seconds} s).</div>
+<script>
+const frames = '${Array.from(frames).join('')}'
+const fps = ${fps}
+const status = document.getElementById('status')
+let start = null
+
+function step(now) {
+    if (start === null) {
+        start = now
+    }
+    const index = Math.floor(((now - start) * fps) / 1000)
+    if (index >= frames.length) {
+        document.body.style.background = '#000'
+        status.textContent = 'Sent. Click to send again.'
+        start = null
+        return
+    }
+    document.body.style.background = frames[index] === '1' ? '#fff' : '#000'
+    requestAnimationFrame(step)
+}
+
+document.addEventListener('click', () => {
+    if (start !== null || status.textContent === '') {
+        return
+    }
+    status.textContent = ''
+    document.documentElement.requestFullscreen?.().catch(() => {})
+    requestAnimationFrame(step)
+})
+</script>
+</body>
+</html>
+`
+}
+
+/**
+ * Model the light sensor output for a sequence of displayed frames.
+ *
+ * The sensor sees `ambient` light plus `contrast` while the screen is lit. The screen moves toward each new frame
+ * with a first-order response of `responseMs`, and the ambient light can flicker by the fraction `flicker` at
+ * `flickerHz`, as mains lighting does. With `stutterEvery`, every so many frames one is shown for an extra frame, as
+ * a player that counts refreshes does when one comes late. With `skipEvery`, every so many frames one is never shown
+ * and the frame before it stays up in its place, as the time-paced player does when an animation frame comes late;
+ * at a symbol edge that lengthens one symbol and shortens the next. Idle frames pad the sequence by `leadSeconds`
+ * and `tailSeconds`. More light pulls the phototransistor's pull-up node lower, so the waveform is negative.
+ *
+ * @param {Uint8Array} frames Frames from encodeOpticalFrames().
+ * @param {{fps?: number, sampleRate?: number, ambient?: number, contrast?: number, responseMs?: number, flicker?: number, flickerHz?: number, stutterEvery?: number, skipEvery?: number, leadSeconds?: number, tailSeconds?: number}} [options={}]
+ *     Display and room model; levels are fractions of PCM full scale.
+ * @returns {Int16Array} Sensor waveform as PCM for sampleAdc().
+ */
+export function createLightSamples(frames, {
+    fps = OPTICAL_FPS,
+    sampleRate = SAMPLE_RATE,
+    ambient = 0.2,
+    contrast = 0.6,
+    responseMs = 5,
+    flicker = 0,
+    flickerHz = 100,
+    stutterEvery = 0,
+    skipEvery = 0,
+    leadSeconds = 0.5,
+    tailSeconds = 0.5
+} = {}) {
+    const shown = []
+    for (let index = 0; index < frames.length; index += 1) {
+        shown.push(frames[index])
+        if (stutterEvery > 0 && (index + 1) % stutterEvery === 0) {
+            shown.push(frames[index])
+        }
+    }
+    if (skipEvery > 0) {
+        for (let index = skipEvery - 1; index < shown.length; index += skipEvery) {
+            shown[index] = shown[index - 1] ?? 0
+        }
+    }
+
+    const lead = Math.round(leadSeconds * sampleRate)
+    const body = Math.round((shown.length / fps) * sampleRate)
+    const samples = new Int16Array(lead + body + Math.round(tailSeconds * sampleRate))
+    const follow = 1 - Math.exp(-1000 / (responseMs * sampleRate))
+    let screen = 0
+
+    for (let index = 0; index < samples.length; index += 1) {
+        const frame = Math.floor(((index - lead) * fps) / sampleRate)
+        const target = frame >= 0 && frame < shown.length ? shown[frame] : 0
+        screen += (target - screen) * (responseMs > 0 ? follow : 1)
+        const room = ambient * (1 + flicker * Math.sin((2 * Math.PI * flickerHz * index) / sampleRate))
+        samples[index] = Math.round(-Math.min(1, room + contrast * screen) * INT16_MAX)
+    }
+
+    return samples
+}
@@ -0,0 +1,223 @@
+import { spawnSync } from 'node:child_process'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { ADC_RATE_HZ, DEFAULT_CHANNEL, sampleAdc } from './loopback.mjs'
+import { SAMPLE_RATE, createTransferPcmBuffer } from './transfer-tone.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..', '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+const benchRoot = path.join(firmwareRoot, 'test', 'simavr')
+
+export const RELEASE_ELF = path.join(firmwareRoot, '.pio', 'build', 'release', 'firmware.elf')
+
+// Vector numbers of the ATtiny88 interrupts the release firmware uses.
+export const VECTOR_NAMES = Object.freeze({
+    4: 'PCINT1',
+    7: 'WDT',
+    9: 'TIMER1_COMPA',
+    12: 'TIMER0_COMPA',
+    14: 'TIMER0_OVF',
+    16: 'ADC',
+    19: 'TWI'
+})
+
+// Boot, including the boot message, takes longer than the loopback probe's lead.
+const BENCH_CHANNEL = Object.freeze({ leadSeconds: 1.5, tailSeconds: 1 })
+
+let benchPath = null
+
+/**
+ * Return the first directory in `candidates` that holds `file`.
+ *
+ * @param {string[]} candidates Directories to try in order.
+ * @param {string} file Relative path to look for.
+ * @returns {string|null} Matching directory.
+ */
+function findDirectory(candidates, file) {
+    return candidates.find((dir) => dir && fs.existsSync(path.join(dir, file))) ?? null
+}
+
+/**
+ * Locate simavr and the avr-libc register headers the ATtiny88 core is declared from.
+ *
+ * `SIMAVR_DIR` points at a simavr install prefix and `AVR_INCLUDE` at an avr-libc include
+ * directory; otherwise the usual system and PlatformIO locations are tried.
+ *
+ * @param {NodeJS.ProcessEnv} [env=process.env] Environment to read the overrides from.
+ * @returns {{ok: true, simavrInclude: string, simavrLib: string|null, avrInclude: string}|{ok: false, reason: string}}
+ *     Compiler paths, or why the bench cannot be built here.
+ */
+export function findSimavr(env = process.env) {
+    const prefixes = env.SIMAVR_DIR ? [env.SIMAVR_DIR] : ['/usr', '/usr/local', '/opt/homebrew']
+    const simavrInclude = findDirectory(prefixes.map((prefix) => path.join(prefix, 'include', 'simavr')), 'sim_avr.h')
+    if (!simavrInclude) {
+        return { ok: false, reason: `simavr headers not found${env.SIMAVR_DIR ? ` under ${env.SIMAVR_DIR}` : ''} (set SIMAVR_DIR)` }
+    }
+
+    // Left to the linker's search path when it is not next to the headers.
+    const simavrLib = findDirectory(prefixes.map((prefix) => path.join(prefix, 'lib')), 'libsimavr.a')
+        ?? findDirectory(prefixes.map((prefix) => path.join(prefix, 'lib')), `libsimavr.${process.platform === 'darwin' ? 'dylib' : 'so'}`)
+
+    const avrInclude = findDirectory(
+        [
+            env.AVR_INCLUDE,
+            path.join(os.homedir(), '.platformio', 'packages', 'toolchain-atmelavr', 'avr', 'include'),
+            '/usr/lib/avr/include',
+            '/usr/avr/include',
+            '/usr/local/avr/include',
+            '/opt/homebrew/opt/avr-gcc/avr/include'
+        ],
+        path.join('avr', 'iotn88.h')
+    )
+    if (!avrInclude) {
+        return { ok: false, reason: 'avr-libc headers with avr/iotn88.h not found (install avr-libc or set AVR_INCLUDE)' }
+    }
+
+    return { ok: true, simavrInclude, simavrLib, avrInclude }
+}
+
+/**
+ * Compile the simavr bench once per process.
+ *
+ * @param {ReturnType<typeof findSimavr> & {ok: true}} paths Result of findSimavr().
+ * @returns {string} Path to the bench binary.
+ */
+export function buildSimavrBench(paths) {
+    if (benchPath) {
+        return benchPath
+    }
+
+    const output = path.join(os.tmpdir(), `blinkenstar-simavr-bench-${process.pid}`)
+    const compile = spawnSync(
+        'cc',
+        [
+            '-std=gnu99',
+            '-O2',
+            '-I', paths.simavrInclude,
+            // After the system headers, so avr-libc's own stdint.h and friends do not shadow them.
+            '-idirafter', paths.avrInclude,
+            path.join(benchRoot, 'SimavrBench.c'),
+            path.join(benchRoot, 'Eeprom24c64.c'),
+            path.join(benchRoot, 'sim_tiny88.c'),
+            ...(paths.simavrLib ? ['-L', paths.simavrLib] : []),
+            '-lsimavr',
+            '-lelf',
+            '-lm',
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+
+    if (compile.status !== 0) {
+        throw new Error(`simavr bench build failed:\n${compile.stderr || compile.stdout}`)
+    }
+
+    benchPath = output
+    return output
+}
+
+/**
+ * Read the stored patterns back out of a 24C64 image in the Storage layout.
+ *
+ * @param {Buffer} image EEPROM contents.
+ * @returns {number[][]} Header, metadata and payload of each pattern.
+ */
+export function readStoredPatterns(image) {
+    const count = image[0] === 0xff ? 0 : image[0]
+    const patterns = []
+    for (let index = 0; index < count; index += 1) {
+        // Pattern pages start after the 256-byte metadata area.
+        const offset = 256 + image[1 + index] * 32
+        const length = ((image[offset] & 0x0f) << 8) | image[offset + 1]
+        patterns.push([...image.subarray(offset, offset + 4 + length)])
+    }
+    return patterns
+}
+
+/**
+ * Return why the bench cannot run here, or null when it can.
+ *
+ * With `SIMAVR_BENCH_REQUIRED=1` in the environment, as in CI, a missing simavr install or
+ * .elf is an error instead of a reason to skip.
+ *
+ * @param {string} elf Firmware image to run.
+ * @param {NodeJS.ProcessEnv} env Environment for findSimavr().
+ * @returns {{paths: ReturnType<typeof findSimavr>, skipped: string|null}} Compiler paths and the skip reason.
+ */
+export function checkSimavrBench(elf, env = process.env) {
+    const paths = findSimavr(env)
+    let skipped = null
+    if (!paths.ok) {
+        skipped = paths.reason
+    } else if (!fs.existsSync(elf)) {
+        skipped = `${path.relative(repoRoot, elf)} not found (run pio run -e release in firmware/)`
+    }
+    if (skipped && env.SIMAVR_BENCH_REQUIRED === '1') {
+        throw new Error(`required by SIMAVR_BENCH_REQUIRED but cannot run: ${skipped}`)
+    }
+    return { paths, skipped }
+}
+
+/**
+ * Run ADC conversions through the release .elf under simavr and parse the bench output.
+ *
+ * @param {Uint16Array} adc ADC conversions at ADC_RATE_HZ.
+ * @param {{elf?: string, env?: NodeJS.ProcessEnv}} [options={}] Firmware image and environment for checkSimavrBench().
+ * @returns {{skipped: string}|{frames: Array<{cycle: number, columns: number[]}>, isrs: Array<{vector: number, name: string, count: number, min: number, max: number, mean: number}>,
+ *     eeprom: {writeCycles: number, busyNacks: number, image: Buffer, patterns: number[][]}, cycles: number}}
+ *     Why the bench was skipped, or the display pictures, cycles per interrupt vector, 24C64 state and run length.
+ */
+export function runSimavrBench(adc, { elf = RELEASE_ELF, env = process.env } = {}) {
+    const { paths, skipped } = checkSimavrBench(elf, env)
+    if (skipped) {
+        return { skipped }
+    }
+
+    const run = spawnSync(buildSimavrBench(paths), ['--elf', elf, '--rate', String(ADC_RATE_HZ)], {
+        input: Buffer.from(adc.buffer, adc.byteOffset, adc.byteLength),
+        encoding: 'utf8',
+        maxBuffer: 256 * 1024 * 1024
+    })
+    if (run.status !== 0) {
+        throw new Error(`simavr bench failed:\n${run.stderr}`)
+    }
+
+    const result = { frames: [], isrs: [], eeprom: { writeCycles: 0, busyNacks: 0, image: Buffer.alloc(0), patterns: [] }, cycles: 0 }
+    for (const line of run.stdout.split('\n')) {
+        const [kind, ...fields] = line.split(' ')
+        if (kind === 'F') {
+            result.frames.push({ cycle: Number(fields[0]), columns: [...Buffer.from(fields[1], 'hex')] })
+        } else if (kind === 'I') {
+            const [vector, count, min, max, sum] = fields.map(Number)
+            result.isrs.push({ vector, name: VECTOR_NAMES[vector] ?? `vector ${vector}`, count, min, max, mean: sum / count })
+        } else if (kind === 'T') {
+            result.eeprom.writeCycles = Number(fields[0])
+            result.eeprom.busyNacks = Number(fields[1])
+        } else if (kind === 'M') {
+            result.eeprom.image = Buffer.from(fields[0], 'hex')
+            result.eeprom.patterns = readStoredPatterns(result.eeprom.image)
+        } else if (kind === 'E') {
+            result.cycles = Number(fields[0])
+        }
+    }
+    return result
+}
+
+/**
+ * Render a transfer and play it into the release .elf under simavr.
+ *
+ * @param {object[]} patterns Patterns to transmit.
+ * @param {Partial<typeof DEFAULT_CHANNEL>} [channel={}] Channel parameters, as for sampleAdc().
+ * @param {{elf?: string, env?: NodeJS.ProcessEnv, fast?: boolean}} [options={}] Bench options, and `fast` as for
+ *     createTransferPcmBuffer().
+ * @returns {ReturnType<typeof runSimavrBench>} Bench result, or why it was skipped.
+ */
+export function simavrTransfer(patterns, channel = {}, { fast = true, ...options } = {}) {
+    const pcm = createTransferPcmBuffer(patterns, { fast })
+    const samples = new Int16Array(pcm.buffer, pcm.byteOffset, pcm.length / 2)
+    return runSimavrBench(sampleAdc(samples, SAMPLE_RATE, { ...DEFAULT_CHANNEL, ...BENCH_CHANNEL, ...channel }), options)
+}
@@ -0,0 +1,419 @@
+import { inflateSync } from 'node:zlib'
+
+const PNG_SIGNATURE = Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a])
+const PNG_CHANNELS = { 0: 1, 2: 3, 3: 1, 4: 2, 6: 4 }
+// GIF interlaced rows come in four passes: start row and row step of each.
+const GIF_INTERLACE_PASSES = [[0, 8], [4, 8], [2, 4], [1, 2]]
+// A pixel counts as a lit LED from this alpha and brightest colour channel up.
+const LIT_THRESHOLD = 128
+
+/**
+ * Undo the per-scanline PNG filters in place.
+ *
+ * @param {Buffer} data Inflated IDAT data, one filter byte per scanline.
+ * @param {number} height Scanline count.
+ * @param {number} stride Bytes per scanline without the filter byte.
+ * @param {number} bpp Bytes per complete pixel, at least 1.
+ * @returns {Uint8Array} Unfiltered scanlines, back to back.
+ */
+function unfilterPng(data, height, stride, bpp) {
+    const out = new Uint8Array(height * stride)
+
+    for (let y = 0; y < height; y++) {
+        const filter = data[y * (stride + 1)]
+        const line = data.subarray(y * (stride + 1) + 1, (y + 1) * (stride + 1))
+        const row = y * stride
+        for (let x = 0; x < stride; x++) {
+            const left = x >= bpp ? out[row + x - bpp] : 0
+            const up = y > 0 ? out[row - stride + x] : 0
+            const upLeft = y > 0 && x >= bpp ? out[row - stride + x - bpp] : 0
+            let predictor = 0
+            if (filter === 1) {
+                predictor = left
+            } else if (filter === 2) {
+                predictor = up
+            } else if (filter === 3) {
+                predictor = (left + up) >> 1
+            } else if (filter === 4) {
+                const p = left + up - upLeft
+                const pa = Math.abs(p - left)
+                const pb = Math.abs(p - up)
+                const pc = Math.abs(p - upLeft)
+                predictor = pa <= pb && pa <= pc ? left : pb <= pc ? up : upLeft
+            } else if (filter !== 0) {
+                throw new Error(`PNG uses unknown filter ${filter}`)
+            }
+            out[row + x] = (line[x] + predictor) & 0xff
+        }
+    }
+
+    return out
+}
+
+/**
+ * Decode a non-interlaced PNG to RGBA.
+ *
+ * @param {Buffer} buffer PNG file contents.
+ * @returns {{width: number, height: number, frames: Uint8Array[]}} One RGBA image.
+ */
+export function decodePng(buffer) {
+    if (!buffer.subarray(0, 8).equals(PNG_SIGNATURE)) {
+        throw new Error('not a PNG file')
+    }
+
+    let header = null
+    let palette = null
+    let transparency = null
+    const idat = []
+    for (let offset = 8; offset + 8 <= buffer.length;) {
+        const length = buffer.readUInt32BE(offset)
+        const type = buffer.toString('ascii', offset + 4, offset + 8)
+        const data = buffer.subarray(offset + 8, offset + 8 + length)
+        if (type === 'IHDR') {
+            header = {
+                width: data.readUInt32BE(0),
+                height: data.readUInt32BE(4),
+                bitDepth: data[8],
+                colorType: data[9],
+                interlace: data[12]
+            }
+        } else if (type === 'PLTE') {
+            palette = data
+        } else if (type === 'tRNS') {
+            transparency = data
+        } else if (type === 'IDAT') {
+            idat.push(data)
+        } else if (type === 'IEND') {
+            break
+        }
+        // Length, type, data and CRC.
+        offset += 12 + length
+    }
+
+    if (!header || PNG_CHANNELS[header.colorType] === undefined) {
+        throw new Error('PNG has no supported IHDR')
+    }
+    if (header.interlace !== 0) {
+        throw new Error('interlaced PNG is not supported')
+    }
+
+    const { width, height, bitDepth, colorType } = header
+    const channels = PNG_CHANNELS[colorType]
+    const stride = Math.ceil((width * channels * bitDepth) / 8)
+    const pixels = unfilterPng(inflateSync(Buffer.concat(idat)), height, stride, Math.max(1, (channels * bitDepth) >> 3))
+    const maxSample = (1 << Math.min(bitDepth, 8)) - 1
+    const rgba = new Uint8Array(width * height * 4)
+
+    // Read one channel sample scaled to 8 bits; 16-bit samples keep their high byte.
+    const sample = (row, index) => {
+        if (bitDepth === 16) {
+            return pixels[row + index * 2]
+        }
+        if (bitDepth === 8) {
+            return pixels[row + index]
+        }
+        const bit = index * bitDepth
+        return (pixels[row + (bit >> 3)] >> (8 - bitDepth - (bit & 7))) & maxSample
+    }
+
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            const out = (y * width + x) * 4
+            const row = y * stride
+            if (colorType === 3) {
+                const index = sample(row, x)
+                rgba.set(palette.subarray(index * 3, index * 3 + 3), out)
+                rgba[out + 3] = transparency && index < transparency.length ? transparency[index] : 0xff
+                continue
+            }
+
+            const values = []
+            for (let c = 0; c < channels; c++) {
+                values.push(bitDepth < 8 ? Math.round((sample(row, x * channels + c) * 255) / maxSample) : sample(row, x * channels + c))
+            }
+            const [r, g, b] = colorType === 0 || colorType === 4 ? [values[0], values[0], values[0]] : values
+            rgba[out] = r
+            rgba[out + 1] = g
+            rgba[out + 2] = b
+            rgba[out + 3] = colorType === 4 ? values[1] : colorType === 6 ? values[3] : 0xff
+        }
+    }
+
+    return { width, height, frames: [rgba] }
+}
+
+/**
+ * Decompress one GIF image's LZW code stream into palette indices.
+ *
+ * @param {Uint8Array} data Concatenated sub-block data.
+ * @param {number} minCodeSize GIF minimum code size.
+ * @param {number} pixelCount Pixels in the image.
+ * @returns {Uint8Array} Palette indices; missing trailing pixels stay 0.
+ */
+function gifLzwDecode(data, minCodeSize, pixelCount) {
+    const clearCode = 1 << minCodeSize
+    const endCode = clearCode + 1
+    const prefix = new Uint16Array(4096)
+    const suffix = new Uint8Array(4096)
+    const first = new Uint8Array(4096)
+    const stack = new Uint8Array(4097)
+    const out = new Uint8Array(pixelCount)
+    let codeSize = minCodeSize + 1
+    let nextCode = endCode + 1
+    let previous = -1
+    let bits = 0
+    let bitCount = 0
+    let position = 0
+    let written = 0
+
+    for (let code = 0; code < clearCode; code++) {
+        suffix[code] = code
+        first[code] = code
+    }
+
+    while (written < pixelCount) {
+        while (bitCount < codeSize && position < data.length) {
+            bits |= data[position++] << bitCount
+            bitCount += 8
+        }
+        if (bitCount < codeSize) {
+            break
+        }
+        const code = bits & ((1 << codeSize) - 1)
+        bits >>>= codeSize
+        bitCount -= codeSize
+
+        if (code === clearCode) {
+            codeSize = minCodeSize + 1
+            nextCode = endCode + 1
+            previous = -1
+            continue
+        }
+        if (code === endCode) {
+            break
+        }
+        if (previous === -1) {
+            out[written++] = suffix[code]
+            previous = code
+            continue
+        }
+
+        // A code one past the table is the previous string plus its own first byte.
+        let sp = 0
+        let current = code
+        if (code >= nextCode) {
+            stack[sp++] = first[previous]
+            current = previous
+        }
+        while (current >= clearCode) {
+            stack[sp++] = suffix[current]
+            current = prefix[current]
+        }
+        stack[sp++] = current
+        while (sp > 0 && written < pixelCount) {
+            out[written++] = stack[--sp]
+        }
+
+        if (nextCode < 4096) {
+            prefix[nextCode] = previous
+            suffix[nextCode] = current
+            first[nextCode] = first[previous]
+            nextCode++
+            if (nextCode === 1 << codeSize && codeSize < 12) {
+                codeSize++
+            }
+        }
+        previous = code
+    }
+
+    return out
+}
+
+/**
+ * Decode every frame of a GIF to full-canvas RGBA, applying frame offsets, transparency and disposal.
+ *
+ * @param {Buffer} buffer GIF file contents.
+ * @returns {{width: number, height: number, frames: Uint8Array[]}} One RGBA image per frame.
+ */
+export function decodeGif(buffer) {
+    const signature = buffer.toString('ascii', 0, 6)
+    if (signature !== 'GIF87a' && signature !== 'GIF89a') {
+        throw new Error('not a GIF file')
+    }
+
+    const width = buffer.readUInt16LE(6)
+    const height = buffer.readUInt16LE(8)
+    const flags = buffer[10]
+    let offset = 13
+    let globalPalette = null
+    if (flags & 0x80) {
+        globalPalette = buffer.subarray(offset, offset + 3 * (2 << (flags & 0x07)))
+        offset += globalPalette.length
+    }
+
+    const frames = []
+    let canvas = new Uint8Array(width * height * 4)
+    let control = { disposal: 0, transparent: -1 }
+
+    // Concatenate data sub-blocks up to the zero terminator.
+    const readSubBlocks = () => {
+        const parts = []
+        while (buffer[offset] !== 0) {
+            parts.push(buffer.subarray(offset + 1, offset + 1 + buffer[offset]))
+            offset += 1 + buffer[offset]
+        }
+        offset += 1
+        return Buffer.concat(parts)
+    }
+
+    while (offset < buffer.length) {
+        const block = buffer[offset++]
+        if (block === 0x3b) {
+            break
+        }
+        if (block === 0x21) {
+            const label = buffer[offset++]
+            const data = readSubBlocks()
+            if (label === 0xf9) {
+                control = { disposal: (data[0] >> 2) & 0x07, transparent: data[0] & 0x01 ? data[3] : -1 }
+            }
+            continue
+        }
+        if (block !== 0x2c) {
+            throw new Error(`GIF has unknown block 0x${block.toString(16)}`)
+        }
+
+        const left = buffer.readUInt16LE(offset)
+        const top = buffer.readUInt16LE(offset + 2)
+        const frameWidth = buffer.readUInt16LE(offset + 4)
+        const frameHeight = buffer.readUInt16LE(offset + 6)
+        const frameFlags = buffer[offset + 8]
+        offset += 9
+        let palette = globalPalette
+        if (frameFlags & 0x80) {
+            palette = buffer.subarray(offset, offset + 3 * (2 << (frameFlags & 0x07)))
+            offset += palette.length
+        }
+        const minCodeSize = buffer[offset++]
+        const indices = gifLzwDecode(readSubBlocks(), minCodeSize, frameWidth * frameHeight)
+
+        const rows = []
+        if (frameFlags & 0x40) {
+            for (const [start, step] of GIF_INTERLACE_PASSES) {
+                for (let y = start; y < frameHeight; y += step) {
+                    rows.push(y)
+                }
+            }
+        } else {
+            for (let y = 0; y < frameHeight; y++) {
+                rows.push(y)
+            }
+        }
+
+        const previous = control.disposal === 3 ? canvas.slice() : null
+        rows.forEach((y, line) => {
+            for (let x = 0; x < frameWidth; x++) {
+                const index = indices[line * frameWidth + x]
+                const cx = left + x
+                const cy = top + y
+                if (index === control.transparent || cx >= width || cy >= height) {
+                    continue
+                }
+                const out = (cy * width + cx) * 4
+                canvas.set(palette.subarray(index * 3, index * 3 + 3), out)
+                canvas[out + 3] = 0xff
+            }
+        })
+        frames.push(canvas.slice())
+
+        if (control.disposal === 2) {
+            for (let y = top; y < Math.min(height, top + frameHeight); y++) {
+                canvas.fill(0, (y * width + left) * 4, (y * width + Math.min(width, left + frameWidth)) * 4)
+            }
+        } else if (previous) {
+            canvas = previous
+        }
+        control = { disposal: 0, transparent: -1 }
+    }
+
+    if (frames.length === 0) {
+        throw new Error('GIF has no frames')
+    }
+    return { width, height, frames }
+}
+
+/**
+ * Decode a PNG sprite sheet or an animated GIF, whichever the file contents are.
+ *
+ * @param {Buffer} buffer Image file contents.
+ * @returns {{width: number, height: number, frames: Uint8Array[]}} RGBA images.
+ */
+export function decodeImage(buffer) {
+    if (buffer.subarray(0, 8).equals(PNG_SIGNATURE)) {
+        return decodePng(buffer)
+    }
+    if (buffer.toString('ascii', 0, 3) === 'GIF') {
+        return decodeGif(buffer)
+    }
+    throw new Error('image must be a PNG or GIF file')
+}
+
+/**
+ * Cut decoded images into 8x8 LED frames.
+ *
+ * Each image is a grid of cells read left to right, then top to bottom. A cell is `8 * scale` pixels square and cells
+ * are `gap` pixels apart, so the PNG strips and GIFs from `display:sim` read back with their `--scale`. Each LED is
+ * sampled at the centre of its block and is lit when both alpha and the brightest colour channel reach half scale.
+ *
+ * @param {{width: number, height: number, frames: Uint8Array[]}} image Decoded RGBA images.
+ * @param {{scale?: number, gap?: number}} [options={}] Pixels per LED and between cells.
+ * @returns {number[][]} Frames as eight column bytes each, bit `n` = row `n`, set = LED lit.
+ */
+export function imageToFrames({ width, height, frames }, { scale = 1, gap = 0 } = {}) {
+    if (!Number.isInteger(scale) || scale < 1 || !Number.isInteger(gap) || gap < 0) {
+        throw new RangeError('scale must be a positive integer and gap a non-negative one')
+    }
+
+    const pitch = 8 * scale + gap
+    if ((width + gap) % pitch !== 0 || (height + gap) % pitch !== 0) {
+        throw new RangeError(`image of ${width}x${height} is not a grid of ${8 * scale}px cells ${gap}px apart`)
+    }
+
+    const cellsAcross = (width + gap) / pitch
+    const cellsDown = (height + gap) / pitch
+    const center = scale >> 1
+    const result = []
+    for (const rgba of frames) {
+        for (let cellY = 0; cellY < cellsDown; cellY++) {
+            for (let cellX = 0; cellX < cellsAcross; cellX++) {
+                const columns = []
+                for (let col = 0; col < 8; col++) {
+                    let column = 0
+                    for (let row = 0; row < 8; row++) {
+                        const x = cellX * pitch + col * scale + center
+                        const y = cellY * pitch + row * scale + center
+                        const pixel = (y * width + x) * 4
+                        const brightest = Math.max(rgba[pixel], rgba[pixel + 1], rgba[pixel + 2])
+                        if (rgba[pixel + 3] >= LIT_THRESHOLD && brightest >= LIT_THRESHOLD) {
+                            column |= 1 << row
+                        }
+                    }
+                    columns.push(column)
+                }
+                result.push(columns)
+            }
+        }
+    }
+    return result
+}
+
+/**
+ * Load the 8x8 frames of a PNG sprite sheet or animated GIF.
+ *
+ * @param {Buffer} buffer Image file contents.
+ * @param {{scale?: number, gap?: number}} [options={}] Cell layout, see `imageToFrames`.
+ * @returns {number[][]} Frames as eight column bytes each.
+ */
+export function loadSpriteFrames(buffer, options = {}) {
+    return imageToFrames(decodeImage(buffer), options)
+}
@@ -0,0 +1,126 @@
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..', '..')
+
+export const TRACE_HEADER_PATH = path.join(repoRoot, 'firmware', 'lib', 'Trace', 'Trace.h')
+
+// Sync byte, id, timestamp (2), argument (2), XOR check byte.
+const SYNC = 0xa5
+const RECORD_BYTES = 7
+
+/**
+ * Read the trace event names from the firmware header so the decoder and firmware never disagree.
+ *
+ * @param {string} [source] Trace.h contents; defaults to the checked-in header.
+ * @returns {Map<number, string>} Event names by id.
+ */
+export function loadTraceEvents(source = fs.readFileSync(TRACE_HEADER_PATH, 'utf8')) {
+    const body = source.match(/enum Event : uint8_t\s*\{([\s\S]*?)\};/)
+    if (!body) {
+        throw new Error('Trace.h has no Event enum')
+    }
+
+    const events = new Map()
+    let next = 0
+    for (const line of body[1].split('\n')) {
+        const entry = line.replace(/\/\/.*$/, '').trim().replace(/,$/, '')
+        if (entry === '') {
+            continue
+        }
+        const [name, value] = entry.split('=').map((part) => part.trim())
+        next = value === undefined ? next : Number(value)
+        events.set(next, name)
+        next++
+    }
+    return events
+}
+
+/**
+ * Split a JP1 capture into trace records and the plain text printed around them.
+ * Timestamps are unwrapped from the 16-bit firmware counter, which assumes
+ * consecutive records are less than about 65 s apart.
+ *
+ * @param {Uint8Array | number[]} bytes Raw UART capture.
+ * @param {{events?: Map<number, string>}} [options] Event names, defaults to Trace.h.
+ * @returns {{records: {timeMs: number, id: number, name: string, arg: number}[], text: string[], corrupt: number}}
+ *     Decoded records, text lines, and the number of sync bytes whose record failed its check.
+ */
+export function decodeTraceStream(bytes, { events = loadTraceEvents() } = {}) {
+    const records = []
+    const text = []
+    let line = ''
+    let corrupt = 0
+    let lastRaw = null
+    let wraps = 0
+
+    const flushLine = () => {
+        if (line !== '') {
+            text.push(line)
+            line = ''
+        }
+    }
+
+    for (let i = 0; i < bytes.length; ) {
+        if (bytes[i] !== SYNC) {
+            const ch = bytes[i++]
+            if (ch === 0x0a) {
+                flushLine()
+            } else if (ch !== 0x0d) {
+                line += String.fromCharCode(ch)
+            }
+            continue
+        }
+
+        if (i + RECORD_BYTES > bytes.length) {
+            corrupt++
+            break
+        }
+        let check = 0
+        for (let j = 0; j < RECORD_BYTES; j++) {
+            check ^= bytes[i + j]
+        }
+        if (check !== 0) {
+            // Resynchronise on the next byte; a lost UART byte only costs this record.
+            corrupt++
+            i++
+            continue
+        }
+
+        const id = bytes[i + 1]
+        const raw = bytes[i + 2] | (bytes[i + 3] << 8)
+        const arg = bytes[i + 4] | (bytes[i + 5] << 8)
+        if (lastRaw !== null && raw < lastRaw) {
+            wraps++
+        }
+        lastRaw = raw
+        flushLine()
+        records.push({ timeMs: wraps * 0x10000 + raw, id, name: events.get(id) ?? `EVENT_${id}`, arg })
+        i += RECORD_BYTES
+    }
+    flushLine()
+
+    return { records, text, corrupt }
+}
+
+/**
+ * Format decoded records as a readable timeline, relative to the first record.
+ *
+ * @param {{records: {timeMs: number, name: string, arg: number}[], corrupt: number}} result Output of `decodeTraceStream()`.
+ * @returns {string} One line per record.
+ */
+export function formatTraceTimeline(result) {
+    const start = result.records.length > 0 ? result.records[0].timeMs : 0
+    let previous = start
+    const lines = result.records.map(({ timeMs, name, arg }) => {
+        const line = `${((timeMs - start) / 1000).toFixed(3).padStart(9)} s  +${String(timeMs - previous).padStart(5)} ms  ${name.padEnd(18)} 0x${arg.toString(16).padStart(4, '0')} (${arg})`
+        previous = timeMs
+        return line
+    })
+    if (result.corrupt > 0) {
+        lines.push(`${result.corrupt} corrupt record(s) skipped`)
+    }
+    return lines.length > 0 ? `${lines.join('\n')}\n` : ''
+}
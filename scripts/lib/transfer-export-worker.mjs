@@ -0,0 +1,12 @@
+import { parentPort } from 'node:worker_threads'
+
+import { renderJob } from './transfer-export.mjs'
+
+// Render one job per message and report back, so the pool can hand out the next one.
+parentPort.on('message', ({ job, sampleRate, channels }) => {
+    try {
+        parentPort.postMessage({ name: job.name, samples: renderJob(job, sampleRate, channels) })
+    } catch (error) {
+        parentPort.postMessage({ name: job.name, error: error.message })
+    }
+})
@@ -0,0 +1,428 @@
+import { createHash } from 'node:crypto'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { Worker } from 'node:worker_threads'
+
+import { loadSpriteFrames } from './sprite.mjs'
+import {
+    SAMPLE_RATE,
+    createFramesPattern,
+    createMultichannelTransferPcmWriter,
+    createTransferPcmWriter,
+    createTransferTestPattern,
+    estimateTransfer,
+    randomToken
+} from './transfer-tone.mjs'
+import { WAV_HEADER_BYTES, createWavHeader } from './wav.mjs'
+
+const SAMPLES_PER_CHUNK = 16384
+const HOST_LITTLE_ENDIAN = os.endianness() === 'LE'
+const BADGE_NAME = /^[A-Za-z0-9._-]+$/
+const TOKEN_PLACEHOLDER = /\{token\}/g
+
+// Field ranges that survive the packing in the transfer metadata bytes.
+const TEXT_FIELD_LIMITS = {
+    speed: 15,
+    delay: 7,
+    direction: 1,
+    repeat: 15,
+    brightness: 7
+}
+
+// Frames carry the full delay nibble and no direction.
+const FRAMES_FIELD_LIMITS = {
+    speed: 15,
+    delay: 15,
+    repeat: 15,
+    brightness: 7
+}
+
+/**
+ * Derive a repeatable token for one pattern of one badge.
+ *
+ * The token depends only on the seed and the pattern position, so the output does not change with the worker count
+ * or the order in which badges finish.
+ *
+ * @param {string} seed Export seed.
+ * @param {number} badgeIndex Badge position in the manifest.
+ * @param {number} patternIndex Pattern position within the badge.
+ * @param {number} [length=6] Token length in characters.
+ * @returns {string} Uppercase hexadecimal token.
+ */
+export function seededToken(seed, badgeIndex, patternIndex, length = 6) {
+    return createHash('sha256')
+        .update(`${seed}:${badgeIndex}:${patternIndex}`)
+        .digest('hex')
+        .toUpperCase()
+        .slice(0, length)
+}
+
+/**
+ * Build the default badge name for a manifest position.
+ *
+ * @param {number} index Badge position.
+ * @returns {string} Badge name.
+ */
+function defaultBadgeName(index) {
+    return `badge-${String(index + 1).padStart(3, '0')}`
+}
+
+/**
+ * Copy range-checked metadata fields from a manifest pattern.
+ *
+ * @param {object} pattern Manifest pattern.
+ * @param {object} normalized Pattern with defaults, updated in place.
+ * @param {Record<string, number>} limits Largest value of each field.
+ * @param {string} where Badge and pattern position for error messages.
+ * @returns {object} `normalized`.
+ */
+function applyFieldLimits(pattern, normalized, limits, where) {
+    for (const [field, limit] of Object.entries(limits)) {
+        if (pattern[field] === undefined) {
+            continue
+        }
+        if (!Number.isInteger(pattern[field]) || pattern[field] < 0 || pattern[field] > limit) {
+            throw new Error(`${where}: ${field} must be an integer from 0 to ${limit}`)
+        }
+        normalized[field] = pattern[field]
+    }
+    return normalized
+}
+
+/**
+ * Resolve a frames pattern from inline column bytes or a PNG/GIF sprite file and range-check its metadata.
+ *
+ * @param {object} pattern Manifest pattern.
+ * @param {string} baseDir Directory that `image` paths are relative to.
+ * @param {string} where Badge and pattern position for error messages.
+ * @returns {object} Pattern ready for the transfer encoder.
+ */
+function normalizeFramesPattern(pattern, baseDir, where) {
+    let frames = pattern.frames
+    if (pattern.image !== undefined) {
+        if (typeof pattern.image !== 'string' || frames !== undefined) {
+            throw new Error(`${where}: frames pattern needs either an "image" path or a "frames" array`)
+        }
+        try {
+            frames = loadSpriteFrames(fs.readFileSync(path.resolve(baseDir, pattern.image)), {
+                scale: pattern.scale,
+                gap: pattern.gap
+            })
+        } catch (error) {
+            throw new Error(`${where}: ${error.message}`)
+        }
+    }
+
+    if (!Array.isArray(frames) || frames.length === 0 || frames.length > 511) {
+        throw new Error(`${where}: frames pattern needs 1 to 511 frames`)
+    }
+    if (!frames.every((columns) => Array.isArray(columns) && columns.length === 8
+        && columns.every((column) => Number.isInteger(column) && column >= 0 && column <= 0xff))) {
+        throw new Error(`${where}: each frame must be 8 column bytes`)
+    }
+
+    return applyFieldLimits(pattern, createFramesPattern({ frames }), FRAMES_FIELD_LIMITS, where)
+}
+
+/**
+ * Fill in pattern defaults, substitute `{token}` in text and range-check the metadata fields.
+ *
+ * @param {object} pattern Manifest pattern.
+ * @param {string} token Token for `{token}` placeholders.
+ * @param {string} baseDir Directory that sprite `image` paths are relative to.
+ * @param {string} where Badge and pattern position for error messages.
+ * @returns {object} Pattern ready for the transfer encoder.
+ */
+function normalizePattern(pattern, token, baseDir, where) {
+    if (!pattern || typeof pattern !== 'object') {
+        throw new Error(`${where}: pattern must be an object`)
+    }
+
+    const type = pattern.type ?? 'text'
+    if (type === 'frames') {
+        return normalizeFramesPattern(pattern, baseDir, where)
+    }
+    if (type !== 'text') {
+        // Other pattern types go to the encoder unchanged; it rejects what it cannot serialize.
+        return { ...pattern, type }
+    }
+
+    if (typeof pattern.text !== 'string') {
+        throw new Error(`${where}: text pattern needs a "text" string`)
+    }
+
+    const text = pattern.text.replace(TOKEN_PLACEHOLDER, token)
+    if (text.length === 0 || text.length > 0xfff || !/^[\x20-\x7e]*$/.test(text)) {
+        throw new Error(`${where}: text must be 1 to 4095 printable ASCII characters`)
+    }
+
+    const normalized = createTransferTestPattern({ token })
+    normalized.text = text
+    return applyFieldLimits(pattern, normalized, TEXT_FIELD_LIMITS, where)
+}
+
+/**
+ * Validate a badge manifest and resolve it into per-badge pattern lists.
+ *
+ * The manifest is either an array of badges or an object with a `badges` array. Each badge has an optional `name`
+ * (used as the WAV file name) and a `patterns` array. Text patterns default to the `transfer:test` metadata, and
+ * `{token}` in their text is replaced by a seeded token, or a random one without a seed. Frames patterns give their
+ * column bytes inline or as a PNG/GIF `image` path relative to `baseDir`.
+ *
+ * @param {object|object[]} manifest Parsed manifest JSON.
+ * @param {{seed?: string, baseDir?: string}} [options={}] Token options and the manifest's directory.
+ * @returns {Array<{name: string, patterns: object[]}>} Resolved badges.
+ */
+export function parseManifest(manifest, { seed, baseDir = '.' } = {}) {
+    const badges = Array.isArray(manifest) ? manifest : manifest?.badges
+    if (!Array.isArray(badges) || badges.length === 0) {
+        throw new Error('manifest must list at least one badge')
+    }
+
+    const names = new Set()
+    return badges.map((badge, badgeIndex) => {
+        const name = badge?.name ?? defaultBadgeName(badgeIndex)
+        if (typeof name !== 'string' || !BADGE_NAME.test(name)) {
+            throw new Error(`badge ${badgeIndex + 1}: name may only use letters, digits, ".", "_" and "-"`)
+        }
+        if (names.has(name)) {
+            throw new Error(`badge ${badgeIndex + 1}: duplicate name "${name}"`)
+        }
+        names.add(name)
+
+        if (!Array.isArray(badge.patterns) || badge.patterns.length === 0) {
+            throw new Error(`${name}: badge must list at least one pattern`)
+        }
+
+        const patterns = badge.patterns.map((pattern, patternIndex) => {
+            const token = seed === undefined ? randomToken(6) : seededToken(seed, badgeIndex, patternIndex)
+            return normalizePattern(pattern, token, baseDir, `${name} pattern ${patternIndex + 1}`)
+        })
+
+        return { name, patterns }
+    })
+}
+
+/**
+ * Create a synthetic manifest of single-pattern test badges, as `transfer:test` sends them.
+ *
+ * @param {number} count Number of badges.
+ * @param {{seed?: string}} [options={}] Token options.
+ * @returns {Array<{name: string, patterns: object[]}>} Resolved badges.
+ */
+export function generateBadges(count, { seed } = {}) {
+    if (!Number.isInteger(count) || count <= 0) {
+        throw new RangeError('badge count must be a positive integer')
+    }
+
+    const badges = []
+    for (let index = 0; index < count; index += 1) {
+        badges.push({ patterns: [{ text: 'TEST {token}' }] })
+    }
+    return parseManifest(badges, { seed })
+}
+
+/**
+ * Lay out the render jobs for per-badge WAV files or one playlist WAV.
+ *
+ * Every transfer's sample count is known before rendering, so playlist jobs get fixed byte offsets and workers write
+ * their badge straight into the shared file. The gaps are the zero bytes left between them.
+ *
+ * With more than one channel, consecutive badges share a job: each gets its own channel of an interleaved WAV, all
+ * starting together, so one station provisions that many badges at once in the time of the longest transfer. A short
+ * last group leaves its spare channels silent.
+ *
+ * @param {Array<{name: string, patterns: object[]}>} badges Resolved badges.
+ * @param {{outDir?: string, playlist?: string, gapSeconds?: number, sampleRate?: number, fast?: boolean, shortSync?: boolean, channels?: number}} options
+ *     Output options; `fast` and `shortSync` as for createTransferPcmWriter(), `channels` is the number of badges played at once.
+ * @returns {{sampleRate: number, channels: number, playlist: {path: string, dataBytes: number}|null, jobs: Array<{name: string, channelPatterns: object[][], fast: boolean, shortSync: boolean, path: string, position: number, sampleCount: number, patternBytes: number, startSample: number, header: boolean}>}}
+ *     Export plan. Sample counts and offsets are per channel.
+ */
+export function planExport(badges, { outDir = '.', playlist, gapSeconds = 2, sampleRate = SAMPLE_RATE, fast = false, shortSync = false, channels = 1 } = {}) {
+    if (!(gapSeconds >= 0)) {
+        throw new RangeError('gap must be zero or more seconds')
+    }
+
+    if (!Number.isInteger(channels) || channels <= 0) {
+        throw new RangeError('channels must be a positive integer')
+    }
+
+    const gapSamples = Math.round(gapSeconds * sampleRate)
+    const jobs = []
+    let startSample = 0
+
+    for (let first = 0; first < badges.length; first += channels) {
+        const group = badges.slice(first, first + channels)
+        let sampleCount = 0
+        let patternBytes = 0
+        for (const badge of group) {
+            try {
+                sampleCount = Math.max(sampleCount, createTransferPcmWriter(badge.patterns, { fast, shortSync }).sampleCount)
+                patternBytes += estimateTransfer(badge.patterns).patternBytes
+            } catch (error) {
+                throw new Error(`${badge.name}: ${error.message}`)
+            }
+        }
+
+        const name = group.map((badge) => badge.name).join('+')
+        jobs.push({
+            name,
+            channelPatterns: group.map((badge) => badge.patterns),
+            fast,
+            shortSync,
+            path: playlist ?? path.join(outDir, `${name}.wav`),
+            position: playlist ? WAV_HEADER_BYTES + startSample * channels * 2 : 0,
+            sampleCount,
+            patternBytes,
+            startSample,
+            header: !playlist
+        })
+        startSample += sampleCount + gapSamples
+    }
+
+    const dataBytes = (startSample - gapSamples) * channels * 2
+    if (playlist) {
+        // Fail before any worker starts if the playlist cannot be described by a WAV header.
+        createWavHeader({ sampleRate, channels, dataBytes })
+    }
+
+    return {
+        sampleRate,
+        channels,
+        playlist: playlist ? { path: playlist, dataBytes } : null,
+        jobs
+    }
+}
+
+/**
+ * Create the playlist file at its final size with its header, so workers can fill in their ranges in any order.
+ *
+ * @param {{sampleRate: number, channels?: number, playlist: {path: string, dataBytes: number}}} plan Export plan.
+ */
+export function preparePlaylist(plan) {
+    const fd = fs.openSync(plan.playlist.path, 'w')
+    try {
+        fs.writeSync(fd, createWavHeader({ sampleRate: plan.sampleRate, channels: plan.channels, dataBytes: plan.playlist.dataBytes }))
+        fs.ftruncateSync(fd, WAV_HEADER_BYTES + plan.playlist.dataBytes)
+    } finally {
+        fs.closeSync(fd)
+    }
+}
+
+/**
+ * Render one badge, or one group of badges side by side, into its WAV file or its playlist range, one reused PCM
+ * chunk at a time.
+ *
+ * @param {{channelPatterns: object[][], fast?: boolean, shortSync?: boolean, path: string, position: number, sampleCount: number, header: boolean}} job
+ *     Render job from planExport().
+ * @param {number} sampleRate PCM sample rate in hertz.
+ * @param {number} [channels=1] Channels of the output file; channels without a badge stay silent.
+ * @returns {number} Samples written, across all channels.
+ */
+export function renderJob(job, sampleRate, channels = 1) {
+    // A mono job renders directly; the interleaving writer only pays off once there are channels to interleave.
+    const options = { fast: job.fast, shortSync: job.shortSync }
+    const writer = channels === 1
+        ? createTransferPcmWriter(job.channelPatterns[0], options)
+        : createMultichannelTransferPcmWriter(
+            Array.from({ length: channels }, (_, channel) => job.channelPatterns[channel] ?? null),
+            options
+        )
+    const chunk = new Int16Array(SAMPLES_PER_CHUNK)
+    const bytes = Buffer.from(chunk.buffer)
+    const fd = fs.openSync(job.path, job.header ? 'w' : 'r+')
+    let position = job.position
+    let total = 0
+
+    try {
+        if (job.header) {
+            const header = createWavHeader({ sampleRate, channels, dataBytes: writer.sampleCount * 2 })
+            position += fs.writeSync(fd, header, 0, header.length, position)
+        }
+
+        for (let written = writer.read(chunk); written > 0; written = writer.read(chunk)) {
+            const view = bytes.subarray(0, written * 2)
+            if (!HOST_LITTLE_ENDIAN) {
+                view.swap16()
+            }
+            position += fs.writeSync(fd, view, 0, view.length, position)
+            total += written
+        }
+    } finally {
+        fs.closeSync(fd)
+    }
+
+    return total
+}
+
+/**
+ * Render every job of an export plan on a pool of worker threads.
+ *
+ * @param {ReturnType<typeof planExport>} plan Export plan.
+ * @param {{jobs?: number}} [options={}] Pool options.
+ * @returns {Promise<number>} Number of workers used.
+ */
+export async function runExport(plan, { jobs = os.availableParallelism() } = {}) {
+    if (!Number.isInteger(jobs) || jobs <= 0) {
+        throw new RangeError('jobs must be a positive integer')
+    }
+
+    if (plan.playlist) {
+        preparePlaylist(plan)
+    } else {
+        for (const dir of new Set(plan.jobs.map((job) => path.dirname(job.path)))) {
+            fs.mkdirSync(dir, { recursive: true })
+        }
+    }
+
+    const workerCount = Math.min(jobs, plan.jobs.length)
+    const workers = []
+    let next = 0
+
+    try {
+        await new Promise((resolve, reject) => {
+            let running = 0
+
+            /**
+             * Hand the next job to a worker, or retire it when the queue is empty.
+             *
+             * @param {Worker} worker Idle worker.
+             */
+            const dispatch = (worker) => {
+                if (next === plan.jobs.length) {
+                    if (running === 0) {
+                        resolve()
+                    }
+                    return
+                }
+
+                running += 1
+                worker.postMessage({ job: plan.jobs[next], sampleRate: plan.sampleRate, channels: plan.channels })
+                next += 1
+            }
+
+            for (let index = 0; index < workerCount; index += 1) {
+                const worker = new Worker(new URL('./transfer-export-worker.mjs', import.meta.url))
+                workers.push(worker)
+                worker.on('error', reject)
+                worker.on('message', (result) => {
+                    running -= 1
+                    if (result.error) {
+                        reject(new Error(`${result.name}: ${result.error}`))
+                        return
+                    }
+                    dispatch(worker)
+                })
+            }
+
+            for (const worker of workers) {
+                dispatch(worker)
+            }
+        })
+    } finally {
+        await Promise.all(workers.map((worker) => worker.terminate()))
+    }
+
+    return workerCount
+}
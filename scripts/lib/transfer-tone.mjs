@@ -1,4 +1,6 @@
 import { randomBytes } from 'node:crypto'
+import os from 'node:os'
+import { Readable } from 'node:stream'
 
 const SAMPLE_RATE = 48000
 const INT16_MAX = 32767
@@ -11,6 +13,29 @@ const MODERN_START = [0x99, 0x99]
 const MODERN_BLOCK = [0xa9, 0xa9]
 const MODERN_END = [0x84, 0x84]
 
+// The legacy sync burst is 200 repetitions of 360 samples: a short ramp, then silence rendered in fixed blocks.
+const LEGACY_SYNC_SAMPLES = 360 * 200
+const LEGACY_SYNC_RAMP = 100
+const LEGACY_SILENCE_BLOCK = 100
+const LEGACY_SILENCE_BLOCKS = (LEGACY_SYNC_SAMPLES - LEGACY_SYNC_RAMP) / LEGACY_SILENCE_BLOCK
+
+// Fast mode sends only the legacy section after 100 ms instead of 1.5 s of sync. The modem restarts byte alignment after
+// 4 * BITLEN_THRESHOLD quiet activity windows, about 10 ms; the receive loopback needs 25 ms, and the rest leaves room
+// for audio output start-up.
+const FAST_LEGACY_SYNC_SAMPLES = 4800
+const FAST_LEGACY_SILENCE_BLOCKS = (FAST_LEGACY_SYNC_SAMPLES - LEGACY_SYNC_RAMP) / LEGACY_SILENCE_BLOCK
+
+// A short sync relies on the firmware locking onto the start marker itself; the ramp and 10 ms of quiet only give the
+// audio output time to start.
+const SHORT_LEGACY_SYNC_SAMPLES = 600
+const SHORT_LEGACY_SILENCE_BLOCKS = (SHORT_LEGACY_SYNC_SAMPLES - LEGACY_SYNC_RAMP) / LEGACY_SILENCE_BLOCK
+
+const MODERN_SYNC_CHUNKS = 1000
+const MODERN_RESYNC_CHUNKS = 4
+const MODERN_RESYNC_INTERVAL = 9
+
+const HOST_LITTLE_ENDIAN = os.endianness() === 'LE'
+
 const HammingLow = [0, 3, 5, 6, 6, 5, 3, 0, 7, 4, 2, 1, 1, 2, 4, 7]
 const HammingHigh = [0, 9, 10, 3, 11, 2, 1, 8, 12, 5, 6, 15, 7, 14, 13, 4]
 
@@ -59,7 +84,21 @@ function createLegacySymbols() {
     ]
 }
 
+/**
+ * Precompute the fade-in at the start of the legacy sync burst. The rest of the burst is silence.
+ *
+ * @returns {number[]} Ramp samples.
+ */
+function createLegacySyncRamp() {
+    const samples = []
+    for (let index = 0; index < LEGACY_SYNC_RAMP; index += 1) {
+        samples.push(Math.sin(degreesToRadians(index / 4)))
+    }
+    return samples
+}
+
 const LegacySymbols = createLegacySymbols()
+const LegacySyncRamp = createLegacySyncRamp()
 const ModernSyncChunks = [
     Array(17).fill(-1),
     Array(17).fill(1)
@@ -82,15 +121,16 @@ export function randomToken(length = 6) {
 /**
  * Build a single text pattern payload for transfer testing.
  *
- * @param {{token?: string, speed?: number, delay?: number, direction?: number, repeat?: number}} [options={}] Pattern fields.
- * @returns {{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}} Transfer pattern.
+ * @param {{token?: string, speed?: number, delay?: number, direction?: number, repeat?: number, brightness?: number}} [options={}] Pattern fields.
+ * @returns {{type: string, text: string, speed: number, delay: number, direction: number, repeat: number, brightness: number}} Transfer pattern.
  */
 export function createTransferTestPattern({
     token = randomToken(),
     speed = 0x0e,
     delay = 0,
     direction = 0,
-    repeat = 0
+    repeat = 0,
+    brightness = 0
 } = {}) {
     return {
         type: 'text',
@@ -98,7 +138,27 @@ export function createTransferTestPattern({
         speed,
         delay,
         direction,
-        repeat
+        repeat,
+        brightness
+    }
+}
+
+/**
+ * Build a frame animation pattern for the transfer encoder.
+ *
+ * @param {{frames: number[][], speed?: number, delay?: number, repeat?: number, brightness?: number}} options
+ *     Frames as eight column bytes each (bit `n` = row `n`, set = LED lit) and header fields. `delay` is the pause
+ *     nibble 0-15; `brightness` 1-7 caps the display level, 0 follows the global level.
+ * @returns {{type: string, frames: number[][], speed: number, delay: number, repeat: number, brightness: number}} Transfer pattern.
+ */
+export function createFramesPattern({ frames, speed = 0x0e, delay = 0, repeat = 0, brightness = 0 }) {
+    return {
+        type: 'frames',
+        frames,
+        speed,
+        delay,
+        repeat,
+        brightness
     }
 }
 
@@ -113,70 +173,138 @@ function toAsciiBytes(text) {
 }
 
 /**
- * Build the common two-byte text frame header.
+ * Build the two-byte length header shared by text and frame patterns.
  *
- * @param {string} text Pattern text payload.
+ * @param {number} type Pattern type nibble (1 = text, 2 = frames).
+ * @param {number} length Payload length in bytes.
  * @returns {number[]} Two-byte length header.
  */
-function createTextFrameHeader(text) {
-    const length = Buffer.byteLength(text, 'ascii')
-    return [0x10 | (length >> 8), length & 0xff]
+function createLengthHeader(type, length) {
+    return [(type << 4) | (length >> 8), length & 0xff]
 }
 
 /**
  * Build the legacy metadata bytes for a text pattern.
  *
- * @param {{speed: number, delay: number, direction: number, repeat: number}} pattern Pattern metadata.
+ * @param {{speed: number, delay: number, direction: number, repeat: number, brightness?: number}} pattern Pattern metadata.
  * @returns {number[]} Legacy metadata bytes.
  */
 function createLegacyTextHeader(pattern) {
     return [
         ((pattern.speed & 0x0f) << 4) | ((pattern.delay * 2) & 0x0f),
-        ((pattern.direction & 0x0f) << 4) | (pattern.repeat & 0x0f)
+        (((pattern.brightness ?? 0) & 0x07) << 5) | ((pattern.direction & 0x01) << 4) | (pattern.repeat & 0x0f)
     ]
 }
 
 /**
  * Build the alternate-format metadata bytes for a text pattern.
  *
- * @param {{speed: number, delay: number, direction: number}} pattern Pattern metadata.
+ * @param {{speed: number, delay: number, direction: number, brightness?: number}} pattern Pattern metadata.
  * @returns {number[]} Alternate metadata bytes.
  */
 function createModernTextHeader(pattern) {
     return [
         ((pattern.speed & 0x0f) << 4) | ((pattern.delay * 2) & 0x0f),
-        (pattern.direction & 0x0f) << 4
+        (((pattern.brightness ?? 0) & 0x07) << 5) | ((pattern.direction & 0x01) << 4)
+    ]
+}
+
+/**
+ * Build the legacy metadata bytes for a frame animation.
+ *
+ * Frames keep speed in the low nibble of the first byte, with the brightness cap above it, and delay in the high
+ * nibble of the second byte, the layout `showPayloadBuffer` reads for `AnimationType::FRAMES`.
+ *
+ * @param {{speed: number, delay: number, repeat: number, brightness?: number}} pattern Pattern metadata.
+ * @returns {number[]} Legacy metadata bytes.
+ */
+function createLegacyFramesHeader(pattern) {
+    return [
+        (((pattern.brightness ?? 0) & 0x07) << 4) | (pattern.speed & 0x0f),
+        ((pattern.delay & 0x0f) << 4) | (pattern.repeat & 0x0f)
+    ]
+}
+
+/**
+ * Build the alternate-format metadata bytes for a frame animation. Like text, the alternate format carries no repeat.
+ *
+ * @param {{speed: number, delay: number, brightness?: number}} pattern Pattern metadata.
+ * @returns {number[]} Alternate metadata bytes.
+ */
+function createModernFramesHeader(pattern) {
+    return [
+        (((pattern.brightness ?? 0) & 0x07) << 4) | (pattern.speed & 0x0f),
+        (pattern.delay & 0x0f) << 4
     ]
 }
 
 /**
- * Reject pattern types that the transfer test encoder cannot serialize.
+ * Reject patterns that the transfer encoder cannot serialize.
  *
- * @param {{type?: string}|undefined} pattern Candidate pattern object.
+ * @param {{type?: string, text?: string, frames?: number[][]}|undefined} pattern Candidate pattern object.
  */
 function assertSupportedPattern(pattern) {
-    if (!pattern || pattern.type !== 'text') {
-        throw new Error('transfer test encoder currently supports text patterns only')
+    if (pattern?.type === 'text') {
+        if (typeof pattern.text !== 'string' || pattern.text.length === 0 || pattern.text.length > 0xfff) {
+            throw new RangeError('text pattern needs 1 to 4095 characters')
+        }
+        return
+    }
+
+    if (pattern?.type === 'frames') {
+        const { frames } = pattern
+        if (!Array.isArray(frames) || frames.length === 0 || frames.length * 8 > 0xfff) {
+            throw new RangeError('frames pattern needs 1 to 511 frames')
+        }
+        for (const columns of frames) {
+            if (!Array.isArray(columns) || columns.length !== 8 || !columns.every((column) => Number.isInteger(column) && column >= 0 && column <= 0xff)) {
+                throw new RangeError('each frame needs exactly 8 column bytes')
+            }
+        }
+        return
     }
+
+    throw new Error('transfer encoder supports text and frames patterns only')
+}
+
+/**
+ * Build the length header, metadata and payload of one pattern block.
+ *
+ * @param {object} pattern Text or frames pattern.
+ * @param {boolean} legacy `true` for the legacy metadata layout, `false` for the alternate one.
+ * @returns {number[]} Block bytes after the block marker.
+ */
+function createPatternBlock(pattern, legacy) {
+    assertSupportedPattern(pattern)
+
+    if (pattern.type === 'frames') {
+        const data = pattern.frames.flat()
+        return [
+            ...createLengthHeader(2, data.length),
+            ...(legacy ? createLegacyFramesHeader(pattern) : createModernFramesHeader(pattern)),
+            ...data
+        ]
+    }
+
+    const data = toAsciiBytes(pattern.text)
+    return [
+        ...createLengthHeader(1, data.length),
+        ...(legacy ? createLegacyTextHeader(pattern) : createModernTextHeader(pattern)),
+        ...data
+    ]
 }
 
 /**
  * Build the raw legacy transfer frame bytes for one or more patterns.
  *
- * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+ * @param {object[]} patterns Text or frames patterns to encode.
  * @returns {number[]} Legacy frame bytes before FEC.
  */
 function buildLegacyRawBytes(patterns) {
     const bytes = [...LEGACY_START]
 
     for (const pattern of patterns) {
-        assertSupportedPattern(pattern)
-        bytes.push(
-            ...LEGACY_BLOCK,
-            ...createTextFrameHeader(pattern.text),
-            ...createLegacyTextHeader(pattern),
-            ...toAsciiBytes(pattern.text)
-        )
+        bytes.push(...LEGACY_BLOCK, ...createPatternBlock(pattern, true))
     }
 
     bytes.push(...LEGACY_END)
@@ -186,20 +314,14 @@ function buildLegacyRawBytes(patterns) {
 /**
  * Build the raw alternate transfer frame bytes for one or more patterns.
  *
- * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+ * @param {object[]} patterns Text or frames patterns to encode.
  * @returns {number[]} Alternate frame bytes before FEC.
  */
 function buildModernRawBytes(patterns) {
     const bytes = [...MODERN_START]
 
     for (const pattern of patterns) {
-        assertSupportedPattern(pattern)
-        bytes.push(
-            ...MODERN_BLOCK,
-            ...createTextFrameHeader(pattern.text),
-            ...createModernTextHeader(pattern),
-            ...toAsciiBytes(pattern.text)
-        )
+        bytes.push(...MODERN_BLOCK, ...createPatternBlock(pattern, false))
     }
 
     bytes.push(...MODERN_END)
@@ -242,197 +364,473 @@ function encodeFecBytes(rawBytes) {
 }
 
 /**
- * Append one sample segment into a mutable sample array.
+ * Convert one normalized sample into signed 16-bit PCM.
  *
- * @param {number[]} target Output sample array.
- * @param {number[]} segment Segment to append.
+ * @param {number} value Normalized sample.
+ * @returns {number} PCM sample.
  */
-function pushSegment(target, segment) {
-    for (let index = 0; index < segment.length; index += 1) {
-        target.push(segment[index])
-    }
+function toPcmSample(value) {
+    // Round through float32 first so the PCM matches the Float32Array returned by createTransferSamples().
+    // Clamp defensively so any future waveform tweaks cannot overflow PCM conversion.
+    const clamped = Math.max(-1, Math.min(1, Math.fround(value)))
+    return Math.round(clamped * INT16_MAX)
 }
 
 /**
- * Create the long sync burst used at the start of legacy transfers.
+ * Convert the shared waveform segments into one typed-array sample format.
  *
- * @param {number} [repetitions=1] Number of sync repetitions.
- * @returns {number[]} Sync samples.
+ * @param {Float32ArrayConstructor|Int16ArrayConstructor} ArrayType Output array type.
+ * @param {(value: number) => number} convert Per-sample conversion.
+ * @returns {{legacy: ArrayLike<number>[][], legacyRamp: ArrayLike<number>, silence: ArrayLike<number>, modernSync: ArrayLike<number>[], modern: ArrayLike<number>[][]}} Segment bank.
  */
-function createLegacySyncSignal(repetitions = 1) {
-    const samples = []
-    for (let index = 0; index < 360 * repetitions; index += 1) {
-        if (index < repetitions / 2) {
-            samples.push(Math.sin(degreesToRadians(index / 4)))
-        } else {
-            samples.push(0)
-        }
+function createSegmentBank(ArrayType, convert) {
+    const segment = (values) => ArrayType.from(values, convert)
+
+    return {
+        legacy: LegacySymbols.map((symbols) => symbols.map(segment)),
+        legacyRamp: segment(LegacySyncRamp),
+        silence: new ArrayType(LEGACY_SILENCE_BLOCK),
+        modernSync: ModernSyncChunks.map(segment),
+        modern: ModernSymbols.map((symbols) => symbols.map(segment))
     }
-    return samples
 }
 
+const FloatSegments = createSegmentBank(Float32Array, (value) => value)
+const PcmSegments = createSegmentBank(Int16Array, toPcmSample)
+const NO_SEGMENT = new Int16Array(0)
+
+// Waveform sections in transmission order.
+const STAGE_LEGACY_RAMP = 0
+const STAGE_LEGACY_SILENCE = 1
+const STAGE_LEGACY_DATA = 2
+const STAGE_LEGACY_TAIL = 3
+const STAGE_MODERN_SYNC = 4
+const STAGE_MODERN_DATA = 5
+const STAGE_MODERN_RESYNC = 6
+const STAGE_MODERN_END = 7
+const STAGE_DONE = 8
+
 /**
- * Append one legacy-framed byte worth of samples.
+ * Incremental transfer waveform renderer.
  *
- * @param {number[]} target Output sample array.
- * @param {number} byte Byte to append.
- * @param {number} state Current high/low phase state.
- * @returns {number} Updated phase state.
+ * The waveform is a sequence of short precomputed segments (one per bit or sync chunk), so it is produced by walking
+ * the FEC bytes and copying segments into caller-owned arrays. Memory use does not grow with the transfer length.
  */
-function appendLegacyByteSamples(target, byte, state) {
-    let workingByte = byte
-    let hilo = state
-
-    for (let bitIndex = 0; bitIndex < 8; bitIndex += 1) {
-        hilo ^= 1
-        pushSegment(target, LegacySymbols[hilo][workingByte & 1])
-        workingByte >>= 1
+class TransferWaveform {
+    /**
+     * Start a renderer at the first sample of the legacy sync burst.
+     *
+     * @param {{legacyFecBytes: number[], modernFecBytes: number[]}} payloads Encoded payloads.
+     * @param {ReturnType<typeof createSegmentBank>} segments Segment bank that sets the sample format.
+     * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+     */
+    constructor(payloads, segments, { fast = false, shortSync = false } = {}) {
+        this.legacyBytes = payloads.legacyFecBytes
+        this.modernBytes = payloads.modernFecBytes
+        this.segments = segments
+        this.fast = fast
+        this.legacySilenceBlocks = shortSync
+            ? SHORT_LEGACY_SILENCE_BLOCKS
+            : fast ? FAST_LEGACY_SILENCE_BLOCKS : LEGACY_SILENCE_BLOCKS
+        this.stage = STAGE_LEGACY_RAMP
+        this.repeat = 0
+        this.byteIndex = 0
+        this.bitIndex = 8
+        this.workingByte = 0
+        this.hilo = 0
+        this.countSinceSync = 0
+        this.segment = NO_SEGMENT
+        this.segmentOffset = 0
     }
 
-    return hilo
-}
+    /**
+     * Advance to the next waveform segment.
+     *
+     * @returns {ArrayLike<number>|null} Next segment, or `null` after the last one.
+     */
+    nextSegment_() {
+        const segments = this.segments
+
+        for (;;) {
+            switch (this.stage) {
+                case STAGE_LEGACY_RAMP:
+                    this.stage = STAGE_LEGACY_SILENCE
+                    this.repeat = this.legacySilenceBlocks
+                    return segments.legacyRamp
+
+                case STAGE_LEGACY_SILENCE:
+                    if (this.repeat > 0) {
+                        this.repeat -= 1
+                        return segments.silence
+                    }
+                    this.stage = STAGE_LEGACY_DATA
+                    break
+
+                case STAGE_LEGACY_DATA:
+                    if (this.bitIndex === 8) {
+                        if (this.byteIndex === this.legacyBytes.length) {
+                            this.stage = this.fast ? STAGE_LEGACY_TAIL : STAGE_MODERN_SYNC
+                            this.repeat = MODERN_SYNC_CHUNKS
+                            this.byteIndex = 0
+                            this.hilo = 0
+                            break
+                        }
+                        this.workingByte = this.legacyBytes[this.byteIndex]
+                        this.byteIndex += 1
+                        this.bitIndex = 0
+                    }
+                    return this.nextBit_(segments.legacy)
+
+                case STAGE_LEGACY_TAIL:
+                    // The last symbol is a gap, and a gap only ends at the next pulse. The dual-format transfer
+                    // closes it with the alternate sync; on its own the legacy section needs one closing pulse.
+                    this.stage = STAGE_DONE
+                    return segments.legacy[1][0]
+
+                case STAGE_MODERN_SYNC:
+                case STAGE_MODERN_RESYNC:
+                case STAGE_MODERN_END:
+                    if (this.repeat > 0) {
+                        this.repeat -= 1
+                        this.hilo ^= 1
+                        return segments.modernSync[this.hilo]
+                    }
+                    this.stage = this.stage === STAGE_MODERN_END ? STAGE_DONE : STAGE_MODERN_DATA
+                    break
+
+                case STAGE_MODERN_DATA:
+                    if (this.bitIndex === 8) {
+                        // The alternate framing refreshes sync periodically so the firmware decoder can re-lock on longer transfers.
+                        if (this.countSinceSync === MODERN_RESYNC_INTERVAL) {
+                            this.countSinceSync = 0
+                            this.stage = STAGE_MODERN_RESYNC
+                            this.repeat = MODERN_RESYNC_CHUNKS
+                            break
+                        }
+                        if (this.byteIndex === this.modernBytes.length) {
+                            this.stage = STAGE_MODERN_END
+                            this.repeat = MODERN_RESYNC_CHUNKS
+                            break
+                        }
+                        this.workingByte = this.modernBytes[this.byteIndex]
+                        this.byteIndex += 1
+                        this.countSinceSync += 1
+                        this.bitIndex = 0
+                    }
+                    return this.nextBit_(segments.modern)
+
+                default:
+                    return null
+            }
+        }
+    }
 
-/**
- * Convert FEC bytes into the legacy transfer waveform.
- *
- * @param {number[]} fecBytes Encoded transfer bytes.
- * @returns {number[]} Legacy waveform samples.
- */
-function createLegacySamples(fecBytes) {
-    const samples = createLegacySyncSignal(200)
-    let hilo = 0
+    /**
+     * Consume the next bit of the current byte, least significant bit first.
+     *
+     * @param {ArrayLike<number>[][]} symbols Symbol segments indexed by phase and bit value.
+     * @returns {ArrayLike<number>} Segment for the bit.
+     */
+    nextBit_(symbols) {
+        const bit = this.workingByte & 1
+        this.workingByte >>= 1
+        this.bitIndex += 1
+        this.hilo ^= 1
+        return symbols[this.hilo][bit]
+    }
 
-    for (const byte of fecBytes) {
-        hilo = appendLegacyByteSamples(samples, byte, hilo)
+    /**
+     * Copy the next samples into a caller-owned array.
+     *
+     * @param {Float32Array|Int16Array} target Output array in the renderer's sample format.
+     * @param {number} [offset=0] First index to write.
+     * @param {number} [length=target.length - offset] Maximum number of samples to write.
+     * @returns {number} Samples written; fewer than `length` only at the end of the transfer.
+     */
+    read(target, offset = 0, length = target.length - offset) {
+        let written = 0
+
+        while (written < length) {
+            if (this.segmentOffset === this.segment.length) {
+                const next = this.nextSegment_()
+                if (next === null) {
+                    break
+                }
+                this.segment = next
+                this.segmentOffset = 0
+            }
+
+            const segment = this.segment
+            const start = this.segmentOffset
+            const count = Math.min(segment.length - start, length - written)
+            const base = offset + written - start
+            for (let index = start; index < start + count; index += 1) {
+                target[base + index] = segment[index]
+            }
+            this.segmentOffset = start + count
+            written += count
+        }
+
+        return written
     }
 
-    return samples
+    /**
+     * Count the samples a renderer would produce without writing any of them.
+     *
+     * @param {{legacyFecBytes: number[], modernFecBytes: number[]}} payloads Encoded payloads.
+     * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+     * @returns {{legacy: number, total: number}} Samples in the legacy section and in the whole transfer.
+     */
+    static countSamples(payloads, options = {}) {
+        const probe = new TransferWaveform(payloads, PcmSegments, options)
+        let legacy = 0
+        let total = 0
+
+        for (let segment = probe.nextSegment_(); segment !== null; segment = probe.nextSegment_()) {
+            total += segment.length
+            if (probe.stage < STAGE_MODERN_SYNC) {
+                legacy = total
+            }
+        }
+
+        return { legacy: probe.fast ? total : legacy, total }
+    }
 }
 
 /**
- * Create the alternating sync run used by the alternate framing mode.
+ * Build both raw and FEC-encoded transfer payload variants for the supplied patterns.
  *
- * @param {number} [repetitions=1] Number of sync chunks.
- * @param {number} [initialHilo=0] Initial phase state.
- * @returns {{samples: number[], hilo: number}} Sync samples and the resulting phase state.
+ * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+ * @returns {{legacyRawBytes: number[], modernRawBytes: number[], legacyFecBytes: number[], modernFecBytes: number[]}} Encoded payload variants.
  */
-function createModernSyncSignal(repetitions = 1, initialHilo = 0) {
-    const samples = []
-    let hilo = initialHilo
+export function encodeTransferPayloads(patterns) {
+    const legacyRawBytes = buildLegacyRawBytes(patterns)
+    const modernRawBytes = buildModernRawBytes(patterns)
 
-    for (let index = 0; index < repetitions; index += 1) {
-        hilo ^= 1
-        pushSegment(samples, ModernSyncChunks[hilo])
+    return {
+        legacyRawBytes,
+        modernRawBytes,
+        legacyFecBytes: encodeFecBytes(legacyRawBytes),
+        modernFecBytes: encodeFecBytes(modernRawBytes)
     }
-
-    return { samples, hilo }
 }
 
 /**
- * Append one alternate-framed byte worth of samples.
+ * Create a floating-point transfer waveform that concatenates legacy and alternate payloads.
  *
- * @param {number[]} target Output sample array.
- * @param {number} byte Byte to append.
- * @param {number} state Current high/low phase state.
- * @returns {number} Updated phase state.
+ * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+ * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+ * @returns {Float32Array} Combined normalized waveform samples.
  */
-function appendModernByteSamples(target, byte, state) {
-    let workingByte = byte
-    let hilo = state
-
-    for (let bitIndex = 0; bitIndex < 8; bitIndex += 1) {
-        hilo ^= 1
-        pushSegment(target, ModernSymbols[hilo][workingByte & 1])
-        workingByte >>= 1
-    }
+export function createTransferSamples(patterns, options = {}) {
+    const payloads = encodeTransferPayloads(patterns)
+    const samples = new Float32Array(TransferWaveform.countSamples(payloads, options).total)
 
-    return hilo
+    new TransferWaveform(payloads, FloatSegments, options).read(samples)
+    return samples
 }
 
 /**
- * Convert FEC bytes into the alternate transfer waveform.
+ * Convert the generated transfer waveform into signed 16-bit PCM.
  *
- * @param {number[]} fecBytes Encoded transfer bytes.
- * @returns {number[]} Alternate waveform samples.
+ * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+ * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+ * @returns {Buffer} Little-endian signed 16-bit PCM buffer.
  */
-function createModernSamples(fecBytes) {
-    const sync = createModernSyncSignal(1000, 0)
-    const samples = sync.samples
-    let hilo = sync.hilo
-    let countSinceSync = 0
-
-    for (const byte of fecBytes) {
-        hilo = appendModernByteSamples(samples, byte, hilo)
-        countSinceSync += 1
-
-        // The alternate framing refreshes sync periodically so the firmware decoder can re-lock on longer transfers.
-        if (countSinceSync === 9) {
-            const extraSync = createModernSyncSignal(4, hilo)
-            pushSegment(samples, extraSync.samples)
-            hilo = extraSync.hilo
-            countSinceSync = 0
-        }
-    }
-
-    const endSync = createModernSyncSignal(4, hilo)
-    pushSegment(samples, endSync.samples)
+export function createTransferPcmBuffer(patterns, options = {}) {
+    const writer = createTransferPcmWriter(patterns, options)
+    const buffer = Buffer.alloc(writer.sampleCount * 2)
 
-    return samples
+    writer.read(new Int16Array(buffer.buffer, buffer.byteOffset, writer.sampleCount))
+    return toLittleEndian(buffer)
 }
 
 /**
- * Build both raw and FEC-encoded transfer payload variants for the supplied patterns.
+ * Create an incremental PCM renderer for the transfer waveform.
+ *
+ * `read(chunk)` fills a caller-owned `Int16Array` in host byte order and returns the number of samples written, so one
+ * preallocated chunk can be reused for the whole transfer when each chunk is consumed before the next call.
  *
  * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
- * @returns {{legacyRawBytes: number[], modernRawBytes: number[], legacyFecBytes: number[], modernFecBytes: number[]}} Encoded payload variants.
+ * @param {{fast?: boolean, shortSync?: boolean}} [options={}] `fast` sends only the legacy section after a short sync.
+ *     `shortSync` cuts the legacy sync to 50 ms, for firmware that locks onto the start marker without a quiet gap.
+ * @returns {{sampleCount: number, legacySampleCount: number, read: (chunk: Int16Array, offset?: number, length?: number) => number}}
+ *     PCM renderer. `legacySampleCount` is where the alternate-format section starts, or the whole transfer when `fast`.
  */
-export function encodeTransferPayloads(patterns) {
-    const legacyRawBytes = buildLegacyRawBytes(patterns)
-    const modernRawBytes = buildModernRawBytes(patterns)
+export function createTransferPcmWriter(patterns, options = {}) {
+    const payloads = encodeTransferPayloads(patterns)
+    const waveform = new TransferWaveform(payloads, PcmSegments, options)
+    const counts = TransferWaveform.countSamples(payloads, options)
 
     return {
-        legacyRawBytes,
-        modernRawBytes,
-        legacyFecBytes: encodeFecBytes(legacyRawBytes),
-        modernFecBytes: encodeFecBytes(modernRawBytes)
+        sampleCount: counts.total,
+        legacySampleCount: counts.legacy,
+        read: (chunk, offset, length) => waveform.read(chunk, offset, length)
     }
 }
 
 /**
- * Create a floating-point transfer waveform that concatenates legacy and alternate payloads.
+ * Estimate how long a transfer plays and how fast it moves pattern data, without rendering it.
+ *
+ * `patternBytes` counts what the badge stores: each pattern's four header bytes and its payload.
  *
  * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
- * @returns {Float32Array} Combined normalized waveform samples.
+ * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+ * @returns {{seconds: number, patternBytes: number, bytesPerSecond: number}} Playback time and effective throughput.
  */
-export function createTransferSamples(patterns) {
+export function estimateTransfer(patterns, options = {}) {
     const payloads = encodeTransferPayloads(patterns)
-    const legacySamples = createLegacySamples(payloads.legacyFecBytes)
-    const modernSamples = createModernSamples(payloads.modernFecBytes)
-    const combined = new Float32Array(legacySamples.length + modernSamples.length)
+    const seconds = TransferWaveform.countSamples(payloads, options).total / SAMPLE_RATE
+    // Every legacy block is its two marker bytes followed by the stored pattern bytes.
+    const patternBytes = payloads.legacyRawBytes.length - LEGACY_START.length - LEGACY_END.length - patterns.length * LEGACY_BLOCK.length
 
-    combined.set(legacySamples, 0)
-    combined.set(modernSamples, legacySamples.length)
+    return { seconds, patternBytes, bytesPerSecond: patternBytes / seconds }
+}
 
-    return combined
+/**
+ * Byte-swap a host-order PCM buffer into little-endian order on big-endian hosts.
+ *
+ * @param {Buffer} buffer Host-order 16-bit PCM.
+ * @returns {Buffer} The same buffer in little-endian order.
+ */
+function toLittleEndian(buffer) {
+    return HOST_LITTLE_ENDIAN ? buffer : buffer.swap16()
 }
 
 /**
- * Convert the generated transfer waveform into signed 16-bit PCM.
+ * Create an incremental renderer that plays one transfer per channel, interleaved into multichannel PCM.
  *
- * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
- * @returns {Buffer} Little-endian signed 16-bit PCM buffer.
+ * Every channel starts at the first frame, so the whole output lasts as long as the longest transfer; shorter channels
+ * are padded with silence, and a `null` entry leaves its channel silent. `read(chunk)` fills whole frames of a
+ * caller-owned `Int16Array` in host byte order and returns the number of samples written, a multiple of `channels`.
+ *
+ * @param {Array<Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>|null>} channelPatterns Patterns for each output channel.
+ * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+ * @returns {{channels: number, frameCount: number, sampleCount: number, channelFrameCounts: number[], read: (chunk: Int16Array) => number}}
+ *     PCM renderer. `sampleCount` is `frameCount * channels`.
+ */
+export function createMultichannelTransferPcmWriter(channelPatterns, options = {}) {
+    if (!Array.isArray(channelPatterns) || channelPatterns.length === 0) {
+        throw new RangeError('need patterns for at least one channel')
+    }
+
+    const channels = channelPatterns.length
+    const writers = channelPatterns.map((patterns) => (patterns ? createTransferPcmWriter(patterns, options) : null))
+    const channelFrameCounts = writers.map((writer) => (writer ? writer.sampleCount : 0))
+    const frameCount = Math.max(...channelFrameCounts)
+    let scratch = new Int16Array(0)
+    let frame = 0
+
+    return {
+        channels,
+        frameCount,
+        sampleCount: frameCount * channels,
+        channelFrameCounts,
+        read: (chunk) => {
+            const frames = Math.min(Math.floor(chunk.length / channels), frameCount - frame)
+            if (scratch.length < frames) {
+                scratch = new Int16Array(frames)
+            }
+
+            for (let channel = 0; channel < channels; channel += 1) {
+                const written = writers[channel] ? writers[channel].read(scratch, 0, frames) : 0
+                scratch.fill(0, written, frames)
+                for (let index = 0; index < frames; index += 1) {
+                    chunk[index * channels + channel] = scratch[index]
+                }
+            }
+
+            frame += frames
+            return frames * channels
+        }
+    }
+}
+
+/**
+ * Render a multichannel transfer into one interleaved PCM buffer.
+ *
+ * @param {Array<Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>|null>} channelPatterns Patterns for each output channel.
+ * @param {{fast?: boolean, shortSync?: boolean}} [options={}] Transfer options as for createTransferPcmWriter().
+ * @returns {Buffer} Little-endian signed 16-bit interleaved PCM buffer.
+ */
+export function createMultichannelTransferPcmBuffer(channelPatterns, options = {}) {
+    const writer = createMultichannelTransferPcmWriter(channelPatterns, options)
+    const buffer = Buffer.alloc(writer.sampleCount * 2)
+
+    writer.read(new Int16Array(buffer.buffer, buffer.byteOffset, writer.sampleCount))
+    return toLittleEndian(buffer)
+}
+
+/**
+ * Readable that pulls little-endian PCM chunks from a transfer renderer on demand.
  */
-export function createTransferPcmBuffer(patterns) {
-    const samples = createTransferSamples(patterns)
-    const buffer = Buffer.alloc(samples.length * 2)
-
-    for (let index = 0; index < samples.length; index += 1) {
-        // Clamp defensively so any future waveform tweaks cannot overflow PCM conversion.
-        const clamped = Math.max(-1, Math.min(1, samples[index]))
-        buffer.writeInt16LE(Math.round(clamped * INT16_MAX), index * 2)
+class PcmWriterStream extends Readable {
+    /**
+     * Wrap a renderer from createTransferPcmWriter() or createMultichannelTransferPcmWriter().
+     *
+     * @param {{sampleCount: number, read: (chunk: Int16Array) => number}} writer PCM renderer.
+     * @param {number} samplesPerChunk Samples per pushed chunk, across all channels.
+     */
+    constructor(writer, samplesPerChunk) {
+        super()
+        this.writer = writer
+        this.sampleCount = writer.sampleCount
+        this.samplesPerChunk = samplesPerChunk
     }
 
-    return buffer
+    /**
+     * Render the next little-endian PCM chunk on demand.
+     */
+    _read() {
+        // Pushed chunks stay queued until the consumer reads them, so each one gets its own backing store.
+        // Backpressure keeps the number of queued chunks, and with it memory use, bounded.
+        const buffer = Buffer.allocUnsafeSlow(this.samplesPerChunk * 2)
+        const written = this.writer.read(new Int16Array(buffer.buffer, buffer.byteOffset, this.samplesPerChunk))
+
+        if (written === 0) {
+            this.push(null)
+            return
+        }
+
+        this.push(toLittleEndian(written === this.samplesPerChunk ? buffer : buffer.subarray(0, written * 2)))
+    }
+}
+
+export class TransferPcmStream extends PcmWriterStream {
+    /**
+     * Build a streaming PCM source for one transfer.
+     *
+     * @param {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>} patterns Patterns to encode.
+     * @param {{samplesPerChunk?: number, fast?: boolean, shortSync?: boolean}} [options={}] Stream options; the transfer
+     *     options as for createTransferPcmWriter().
+     */
+    constructor(patterns, { samplesPerChunk = 4096, ...options } = {}) {
+        if (!Number.isInteger(samplesPerChunk) || samplesPerChunk <= 0) {
+            throw new RangeError('samplesPerChunk must be a positive integer')
+        }
+
+        super(createTransferPcmWriter(patterns, options), samplesPerChunk)
+    }
+}
+
+export class MultichannelTransferPcmStream extends PcmWriterStream {
+    /**
+     * Build a streaming interleaved PCM source with one transfer per channel.
+     *
+     * @param {Array<Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number}>|null>} channelPatterns Patterns for each output channel.
+     * @param {{framesPerChunk?: number, fast?: boolean, shortSync?: boolean}} [options={}] Stream options; the transfer
+     *     options as for createTransferPcmWriter().
+     */
+    constructor(channelPatterns, { framesPerChunk = 4096, ...options } = {}) {
+        if (!Number.isInteger(framesPerChunk) || framesPerChunk <= 0) {
+            throw new RangeError('framesPerChunk must be a positive integer')
+        }
+
+        const writer = createMultichannelTransferPcmWriter(channelPatterns, options)
+        super(writer, framesPerChunk * writer.channels)
+        this.channels = writer.channels
+        this.frameCount = writer.frameCount
+    }
 }
 
 export { SAMPLE_RATE }
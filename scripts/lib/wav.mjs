@@ -0,0 +1,85 @@
+const WAV_HEADER_BYTES = 44
+const WAV_MAX_DATA_BYTES = 0xffffffff - (WAV_HEADER_BYTES - 8)
+
+/**
+ * Build the canonical 44-byte RIFF/WAVE header for integer PCM.
+ *
+ * @param {{sampleRate: number, dataBytes: number, channels?: number, bitsPerSample?: number}} options Format and payload size.
+ * @returns {Buffer} WAV header.
+ */
+export function createWavHeader({ sampleRate, dataBytes, channels = 1, bitsPerSample = 16 }) {
+    if (!Number.isInteger(sampleRate) || sampleRate <= 0) {
+        throw new RangeError('sampleRate must be a positive integer')
+    }
+
+    if (!Number.isInteger(dataBytes) || dataBytes < 0 || dataBytes > WAV_MAX_DATA_BYTES) {
+        throw new RangeError('WAV data must be between 0 bytes and 4 GiB')
+    }
+
+    const blockAlign = channels * (bitsPerSample / 8)
+    const header = Buffer.alloc(WAV_HEADER_BYTES)
+
+    header.write('RIFF', 0, 'ascii')
+    header.writeUInt32LE(WAV_HEADER_BYTES - 8 + dataBytes, 4)
+    header.write('WAVE', 8, 'ascii')
+    header.write('fmt ', 12, 'ascii')
+    header.writeUInt32LE(16, 16)
+    header.writeUInt16LE(1, 20)
+    header.writeUInt16LE(channels, 22)
+    header.writeUInt32LE(sampleRate, 24)
+    header.writeUInt32LE(sampleRate * blockAlign, 28)
+    header.writeUInt16LE(blockAlign, 32)
+    header.writeUInt16LE(bitsPerSample, 34)
+    header.write('data', 36, 'ascii')
+    header.writeUInt32LE(dataBytes, 40)
+
+    return header
+}
+
+/**
+ * Read the first channel of a 16-bit PCM WAV file.
+ *
+ * @param {Buffer} buffer WAV file contents.
+ * @returns {{sampleRate: number, channels: number, samples: Int16Array}} Format and first-channel samples.
+ */
+export function readWav(buffer) {
+    if (buffer.length < 12 || buffer.toString('ascii', 0, 4) !== 'RIFF' || buffer.toString('ascii', 8, 12) !== 'WAVE') {
+        throw new Error('not a RIFF/WAVE file')
+    }
+
+    let format = null
+    let offset = 12
+    while (offset + 8 <= buffer.length) {
+        const id = buffer.toString('ascii', offset, offset + 4)
+        const size = buffer.readUInt32LE(offset + 4)
+        const body = offset + 8
+
+        if (id === 'fmt ') {
+            format = {
+                tag: buffer.readUInt16LE(body),
+                channels: buffer.readUInt16LE(body + 2),
+                sampleRate: buffer.readUInt32LE(body + 4),
+                bitsPerSample: buffer.readUInt16LE(body + 14)
+            }
+        } else if (id === 'data') {
+            // 0xfffe is WAVE_FORMAT_EXTENSIBLE, which recorders use for plain PCM too.
+            if (!format || (format.tag !== 1 && format.tag !== 0xfffe) || format.bitsPerSample !== 16) {
+                throw new Error('only 16-bit integer PCM WAV files are supported')
+            }
+
+            const frames = Math.floor(Math.min(size, buffer.length - body) / (2 * format.channels))
+            const samples = new Int16Array(frames)
+            for (let index = 0; index < frames; index += 1) {
+                samples[index] = buffer.readInt16LE(body + index * 2 * format.channels)
+            }
+            return { sampleRate: format.sampleRate, channels: format.channels, samples }
+        }
+
+        // Chunks are padded to an even length.
+        offset = body + size + (size & 1)
+    }
+
+    throw new Error('WAV file has no data chunk')
+}
+
+export { WAV_HEADER_BYTES }
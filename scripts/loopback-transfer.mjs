@@ -0,0 +1,200 @@
+#!/usr/bin/env node
+import fs from 'node:fs'
+import { parseArgs } from 'node:util'
+
+import { ADC_RATE_HZ, DEFAULT_CHANNEL, loopbackPcm, loopbackTransfer, scoreLoopback } from './lib/loopback.mjs'
+import { seededToken } from './lib/transfer-export.mjs'
+import { SAMPLE_RATE, createTransferPcmWriter, createTransferTestPattern } from './lib/transfer-tone.mjs'
+import { readWav } from './lib/wav.mjs'
+
+const USAGE = `Usage: npm run transfer:loopback -- [options]
+
+  --text TEXT         transmit a text pattern (repeatable; default: the seeded transfer:test pattern)
+  --wav FILE          decode a recorded or exported WAV instead of rendering one; with --text,
+                      score it assuming the transfer starts at the beginning of the file
+  --level N           signal swing in ADC counts either side of the bias (default: ${DEFAULT_CHANNEL.level})
+  --noise N           Gaussian noise in ADC counts RMS (default: ${DEFAULT_CHANNEL.noise})
+  --clip N            saturate at this fraction of full scale (default: ${DEFAULT_CHANNEL.clip}, no clipping)
+  --drift-ppm N       sender clock error against the ADC clock (default: ${DEFAULT_CHANNEL.driftPpm})
+  --dropouts N        dropouts per second of audio (default: ${DEFAULT_CHANNEL.dropoutsPerSecond})
+  --dropout-ms N      length of each dropout (default: ${DEFAULT_CHANNEL.dropoutMs})
+  --sweep P=V1,V2,..  repeat the run for each value of one of the channel options above
+  --trials N          runs per point, each with the next seed (default: 1)
+  --seed N            first noise and dropout seed (default: ${DEFAULT_CHANNEL.seed})
+  --fast              send the single-format fast transfer instead of both formats
+  --short-sync        cut the legacy sync to 12.5 ms
+  --define NAME[=V]   extra firmware build flag for the receive stack (repeatable)
+  --json              print one JSON object per point and format instead of the table`
+
+// CLI channel options and the channel model fields they set.
+const CHANNEL_OPTIONS = {
+    level: 'level',
+    noise: 'noise',
+    clip: 'clip',
+    'drift-ppm': 'driftPpm',
+    dropouts: 'dropoutsPerSecond',
+    'dropout-ms': 'dropoutMs'
+}
+
+/**
+ * Parse a numeric option.
+ *
+ * @param {string} name Option name for error messages.
+ * @param {string} value Option value.
+ * @returns {number} Parsed value.
+ */
+function parseNumber(name, value) {
+    const number = Number(value)
+    if (value === '' || !Number.isFinite(number)) {
+        throw new RangeError(`--${name} must be a number`)
+    }
+    return number
+}
+
+/**
+ * Merge the per-format results of several trials at one sweep point.
+ *
+ * @param {Array<{scores: ReturnType<typeof scoreLoopback>, audioSeconds: number, wallSeconds: number}>} trials Trial results.
+ * @returns {Array<{format: string, rawBits: number, rawBitErrors: number, rawBer: number, framesOk: number, trials: number, realTime: number}>}
+ *     One summary per format.
+ */
+function summarize(trials) {
+    const audioSeconds = trials.reduce((sum, trial) => sum + trial.audioSeconds, 0)
+    const wallSeconds = trials.reduce((sum, trial) => sum + trial.wallSeconds, 0)
+
+    return trials[0].scores.map(({ format }, index) => {
+        const scores = trials.map((trial) => trial.scores[index])
+        const rawBits = scores.reduce((sum, score) => sum + score.rawBits, 0)
+        const rawBitErrors = scores.reduce((sum, score) => sum + score.rawBitErrors, 0)
+        return {
+            format,
+            rawBits,
+            rawBitErrors,
+            rawBer: rawBitErrors / rawBits,
+            framesOk: scores.filter((score) => score.frameOk).length,
+            trials: trials.length,
+            realTime: audioSeconds / wallSeconds
+        }
+    })
+}
+
+/**
+ * Format one summary as a table row.
+ *
+ * @param {string} point Sweep point label.
+ * @param {ReturnType<typeof summarize>[number]} summary Format summary.
+ * @returns {string} Table row.
+ */
+function formatRow(point, summary) {
+    return [
+        point.padEnd(16),
+        summary.format.padEnd(9),
+        summary.rawBer.toExponential(2).padStart(9),
+        `${summary.framesOk}/${summary.trials}`.padStart(7),
+        `${summary.realTime.toFixed(0)}x`.padStart(8)
+    ].join('  ')
+}
+
+async function main() {
+    const { values } = parseArgs({
+        options: {
+            text: { type: 'string', multiple: true },
+            wav: { type: 'string' },
+            ...Object.fromEntries(Object.keys(CHANNEL_OPTIONS).map((name) => [name, { type: 'string' }])),
+            sweep: { type: 'string' },
+            trials: { type: 'string', default: '1' },
+            seed: { type: 'string', default: String(DEFAULT_CHANNEL.seed) },
+            fast: { type: 'boolean', default: false },
+            'short-sync': { type: 'boolean', default: false },
+            define: { type: 'string', multiple: true, default: [] },
+            json: { type: 'boolean', default: false },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    const channel = {}
+    for (const [name, field] of Object.entries(CHANNEL_OPTIONS)) {
+        if (values[name] !== undefined) {
+            channel[field] = parseNumber(name, values[name])
+        }
+    }
+
+    const trials = parseNumber('trials', values.trials)
+    const seed = parseNumber('seed', values.seed)
+    if (!Number.isInteger(trials) || trials <= 0) {
+        throw new RangeError('--trials must be a positive integer')
+    }
+
+    let sweepName = null
+    let sweepValues = [null]
+    if (values.sweep) {
+        const [name, list = ''] = values.sweep.split('=')
+        if (!CHANNEL_OPTIONS[name]) {
+            throw new RangeError(`--sweep can vary ${Object.keys(CHANNEL_OPTIONS).join(', ')}`)
+        }
+        sweepName = name
+        sweepValues = list.split(',').map((value) => parseNumber(name, value))
+    }
+
+    const options = { defines: values.define, fast: values.fast, shortSync: values['short-sync'] }
+    const patterns = values.text
+        ? values.text.map((text) => ({ ...createTransferTestPattern({ token: '' }), text }))
+        : [createTransferTestPattern({ token: seededToken(values.seed, 0, 0) })]
+    const wav = values.wav ? readWav(fs.readFileSync(values.wav)) : null
+
+    if (wav && !values.text) {
+        // Nothing to score against, so just report what the receiver made of the recording.
+        const { result, audioSeconds, wallSeconds } = loopbackPcm(wav.samples, wav.sampleRate, { ...channel, seed }, options)
+        for (const frame of result.frames) {
+            console.log(`${(frame.sample / ADC_RATE_HZ).toFixed(3).padStart(8)}s  frame`)
+            for (const pattern of frame.patterns) {
+                console.log(`          ${Buffer.from(pattern).toString('hex')}`)
+            }
+        }
+        console.log(`${result.raw.length} raw bytes, ${result.frames.length} frames, ${(audioSeconds / wallSeconds).toFixed(0)}x real time`)
+        return
+    }
+
+    if (!values.json) {
+        console.log(`${'point'.padEnd(16)}  format       raw_BER   frames  realtime`)
+    }
+
+    for (const value of sweepValues) {
+        const point = sweepName ? { ...channel, [CHANNEL_OPTIONS[sweepName]]: value } : channel
+        const results = []
+
+        for (let trial = 0; trial < trials; trial += 1) {
+            const settings = { ...DEFAULT_CHANNEL, ...point, seed: seed + trial }
+            if (wav) {
+                const run = loopbackPcm(wav.samples, wav.sampleRate, settings, options)
+                results.push({
+                    ...run,
+                    scores: scoreLoopback(run.result, patterns, {
+                        legacySamples: createTransferPcmWriter(patterns, options).legacySampleCount,
+                        sampleRate: SAMPLE_RATE,
+                        leadSeconds: settings.leadSeconds,
+                        driftPpm: settings.driftPpm,
+                        fast: values.fast
+                    })
+                })
+            } else {
+                results.push(loopbackTransfer(patterns, settings, options))
+            }
+        }
+
+        const label = sweepName ? `${sweepName}=${value}` : 'default'
+        for (const summary of summarize(results)) {
+            console.log(values.json ? JSON.stringify({ point: label, ...summary }) : formatRow(label, summary))
+        }
+    }
+}
+
+main().catch((error) => {
+    console.error(`Transfer loopback failed: ${error.message}`)
+    process.exitCode = 1
+})
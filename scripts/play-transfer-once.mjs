@@ -1,21 +1,62 @@
 #!/usr/bin/env node
+import { parseArgs } from 'node:util'
+
 import { playBufferOnce } from './lib/audio-output.mjs'
 
 import {
     SAMPLE_RATE,
-    createTransferPcmBuffer,
+    MultichannelTransferPcmStream,
+    TransferPcmStream,
     createTransferTestPattern,
+    estimateTransfer,
     randomToken
 } from './lib/transfer-tone.mjs'
 
+const USAGE = `Usage: npm run transfer:test -- [options]
+
+  --fast              send only the legacy format after a short sync (current firmware only)
+  --short-sync        cut the legacy sync to 12.5 ms; needs firmware with the start-marker correlator
+  --channels N        send a different test pattern on each of N output channels (default: 1)`
+
 async function main() {
-    const token = randomToken(6)
-    const pattern = createTransferTestPattern({ token })
-    const pcmBuffer = createTransferPcmBuffer([pattern])
+    const { values } = parseArgs({
+        options: {
+            fast: { type: 'boolean', default: false },
+            'short-sync': { type: 'boolean', default: false },
+            channels: { type: 'string', default: '1' },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    const channels = Number(values.channels)
+    if (!Number.isInteger(channels) || channels <= 0) {
+        throw new RangeError('--channels must be a positive integer')
+    }
+
+    const options = { fast: values.fast, shortSync: values['short-sync'] }
+    const patterns = Array.from({ length: channels }, () => createTransferTestPattern({ token: randomToken(6) }))
+    const estimates = patterns.map((pattern) => estimateTransfer([pattern], options))
+    const patternBytes = estimates.reduce((sum, estimate) => sum + estimate.patternBytes, 0)
+    const expectedSeconds = Math.max(...estimates.map((estimate) => estimate.seconds))
+    const pcmStream = channels === 1
+        ? new TransferPcmStream(patterns, options)
+        : new MultichannelTransferPcmStream(patterns.map((pattern) => [pattern]), options)
+
+    console.log(
+        `Sending transfer test pattern once: ${patterns.map((pattern) => `"${pattern.text}"`).join(', ')} `
+        + `(${values.fast ? 'fast' : 'both formats'}, ${expectedSeconds.toFixed(2)} s)`
+    )
 
-    console.log(`Sending transfer test pattern once: "${pattern.text}"`)
+    const start = process.hrtime.bigint()
+    await playBufferOnce(pcmStream, { sampleRate: SAMPLE_RATE, channels })
+    const seconds = Number(process.hrtime.bigint() - start) / 1e9
 
-    await playBufferOnce(pcmBuffer, { sampleRate: SAMPLE_RATE })
+    console.log(`Sent ${patternBytes} pattern bytes in ${seconds.toFixed(2)} s (${(patternBytes / seconds).toFixed(1)} B/s)`)
 }
 
 main().catch((error) => {
@@ -0,0 +1,92 @@
+#!/usr/bin/env node
+import { parseArgs } from 'node:util'
+
+import { DEFAULT_CHANNEL } from './lib/loopback.mjs'
+import { RELEASE_ELF, simavrTransfer } from './lib/simavr-bench.mjs'
+import { seededToken } from './lib/transfer-export.mjs'
+import { createTransferTestPattern } from './lib/transfer-tone.mjs'
+
+const USAGE = `Usage: npm run sim:bench -- [options]
+
+  --text TEXT         transmit a text pattern (repeatable; default: the seeded transfer:test pattern)
+  --elf FILE          firmware image to run (default: the release build)
+  --noise N           Gaussian noise in ADC counts RMS (default: ${DEFAULT_CHANNEL.noise})
+  --seed N            noise seed and transfer:test token seed (default: ${DEFAULT_CHANNEL.seed})
+  --both-formats      send the legacy and alternate sections instead of the fast transfer
+  --json              print the result as one JSON object instead of the table
+
+Needs simavr (SIMAVR_DIR) and the avr-libc headers (AVR_INCLUDE); without them, or without
+the .elf, it reports why and exits cleanly, or fails when SIMAVR_BENCH_REQUIRED=1.`
+
+/**
+ * Parse a numeric option.
+ *
+ * @param {string} name Option name for error messages.
+ * @param {string} value Option value.
+ * @returns {number} Parsed value.
+ */
+function parseNumber(name, value) {
+    const number = Number(value)
+    if (value === '' || !Number.isFinite(number)) {
+        throw new RangeError(`--${name} must be a number`)
+    }
+    return number
+}
+
+async function main() {
+    const { values } = parseArgs({
+        options: {
+            text: { type: 'string', multiple: true },
+            elf: { type: 'string', default: RELEASE_ELF },
+            noise: { type: 'string', default: String(DEFAULT_CHANNEL.noise) },
+            seed: { type: 'string', default: String(DEFAULT_CHANNEL.seed) },
+            'both-formats': { type: 'boolean', default: false },
+            json: { type: 'boolean', default: false },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    const patterns = values.text
+        ? values.text.map((text) => ({ ...createTransferTestPattern({ token: '' }), text }))
+        : [createTransferTestPattern({ token: seededToken(values.seed, 0, 0) })]
+    const result = simavrTransfer(
+        patterns,
+        { noise: parseNumber('noise', values.noise), seed: parseNumber('seed', values.seed) },
+        { elf: values.elf, fast: !values['both-formats'] }
+    )
+
+    if (result.skipped) {
+        console.log(`simavr bench skipped: ${result.skipped}`)
+        return
+    }
+
+    const stored = result.eeprom.patterns.map((pattern) => Buffer.from(pattern.slice(4)).toString('latin1'))
+    if (values.json) {
+        console.log(JSON.stringify({ ...result, eeprom: { ...result.eeprom, image: undefined, stored } }))
+        return
+    }
+
+    console.log(`${'vector'.padEnd(14)}  ${'calls'.padStart(8)}  ${'min'.padStart(6)}  ${'mean'.padStart(8)}  ${'max'.padStart(6)}  cycles`)
+    for (const isr of result.isrs) {
+        console.log([
+            isr.name.padEnd(14),
+            String(isr.count).padStart(8),
+            String(isr.min).padStart(6),
+            isr.mean.toFixed(1).padStart(8),
+            String(isr.max).padStart(6)
+        ].join('  '))
+    }
+    console.log(`${result.frames.length} display pictures, ${result.eeprom.writeCycles} EEPROM write cycles, `
+        + `${result.eeprom.busyNacks} polls during a write cycle, ${(result.cycles / 8e6).toFixed(2)} s simulated`)
+    console.log(`stored: ${stored.map((text) => JSON.stringify(text)).join(', ') || 'nothing'}`)
+}
+
+main().catch((error) => {
+    console.error(`simavr bench failed: ${error.message}`)
+    process.exitCode = 1
+})
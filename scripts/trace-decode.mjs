@@ -0,0 +1,41 @@
+#!/usr/bin/env node
+import fs from 'node:fs'
+import { parseArgs } from 'node:util'
+
+import { decodeTraceStream, formatTraceTimeline } from './lib/trace-decode.mjs'
+
+const USAGE = `Usage: npm run trace:decode -- [options] [CAPTURE]
+
+  CAPTURE             raw JP1 UART capture (default: stdin)
+  --text              also print the plain text lines found between records
+
+Capture example: stty -F /dev/ttyUSB0 38400 raw && cat /dev/ttyUSB0 > capture.bin`
+
+async function main() {
+    const { values, positionals } = parseArgs({
+        allowPositionals: true,
+        options: {
+            text: { type: 'boolean', default: false },
+            help: { type: 'boolean', default: false }
+        }
+    })
+
+    if (values.help) {
+        console.log(USAGE)
+        return
+    }
+
+    const bytes = fs.readFileSync(positionals[0] ?? 0)
+    const result = decodeTraceStream(bytes)
+    process.stdout.write(formatTraceTimeline(result))
+    if (values.text) {
+        for (const line of result.text) {
+            console.log(`text: ${line}`)
+        }
+    }
+}
+
+main().catch((error) => {
+    console.error(`Trace decode failed: ${error.message}`)
+    process.exitCode = 1
+})
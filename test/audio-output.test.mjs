@@ -1,8 +1,9 @@
 import test from 'node:test'
 import assert from 'node:assert/strict'
 import { EventEmitter } from 'node:events'
+import { Readable, Writable } from 'node:stream'
 
-import { createMonoSpeakerOptions, playBufferOnce } from '../scripts/lib/audio-output.mjs'
+import { createMonoSpeakerOptions, createSpeakerOptions, playBufferOnce } from '../scripts/lib/audio-output.mjs'
 
 /**
  * Minimal event-emitting speaker double used to test playback logic without a real audio device.
@@ -53,6 +54,28 @@ test('createMonoSpeakerOptions rejects invalid sample rates', () => {
     assert.throws(() => createMonoSpeakerOptions(44.1), /sampleRate must be a positive integer/)
 })
 
+/**
+ * Verify that multichannel playback opens the speaker with the requested channel count.
+ */
+test('createSpeakerOptions configures interleaved multichannel output', async () => {
+    let options = null
+
+    assert.deepEqual(createSpeakerOptions(48000, 2), { ...createMonoSpeakerOptions(48000), channels: 2 })
+    assert.throws(() => createSpeakerOptions(48000, 0), /channels must be a positive integer/)
+
+    await playBufferOnce(Buffer.alloc(8), {
+        sampleRate: 48000,
+        channels: 4,
+        SpeakerClass: class extends FakeSpeaker {
+            constructor(speakerOptions) {
+                super(speakerOptions)
+                options = speakerOptions
+            }
+        }
+    })
+    assert.equal(options.channels, 4)
+})
+
 /**
  * Verify that successful playback writes the caller-provided PCM buffer and resolves.
  */
@@ -75,6 +98,25 @@ test('playBufferOnce writes the provided PCM buffer and resolves on finish', asy
     assert.equal(speakerInstance.endedBuffer, buffer)
 })
 
+/**
+ * Verify that a PCM stream is piped into the speaker and playback resolves once it drains.
+ */
+test('playBufferOnce pipes a PCM stream into the speaker', async () => {
+    const written = []
+
+    await playBufferOnce(Readable.from([Buffer.from([0x01, 0x02]), Buffer.from([0x03, 0x04])]), {
+        sampleRate: 32000,
+        SpeakerClass: class StreamSpeaker extends Writable {
+            _write(chunk, encoding, callback) {
+                written.push(chunk)
+                callback()
+            }
+        }
+    })
+
+    assert.deepEqual(Buffer.concat(written), Buffer.from([0x01, 0x02, 0x03, 0x04]))
+})
+
 /**
  * Verify that construction failures propagate as rejected playback promises.
  */
@@ -0,0 +1,54 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { spawnSync } from 'node:child_process'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const displaySourcePath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.cpp')
+const systemSourcePath = path.join(repoRoot, 'firmware', 'lib', 'System', 'System.cpp')
+
+/**
+ * Compile and run the host-side debouncer probe.
+ */
+test('button debouncer filters bounce and reports press, release and long-press events', () => {
+    const firmwareRoot = path.join(repoRoot, 'firmware')
+    const output = path.join(os.tmpdir(), 'blinkenstar-buttons-host')
+
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'Buttons'),
+            path.join(firmwareRoot, 'test', 'ButtonsHost.cpp'),
+            path.join(firmwareRoot, 'lib', 'Buttons', 'Buttons.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+
+    assert.equal(compile.status, 0, compile.stderr || compile.stdout)
+
+    const run = spawnSync(output, [], { cwd: repoRoot, encoding: 'utf8' })
+    assert.equal(run.status, 0, run.stderr || run.stdout)
+})
+
+/**
+ * Verify that the display timer owns button sampling and the main loop no longer reads PINC.
+ */
+test('buttons are sampled in the display tick and consumed as debounced state', () => {
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const systemSource = fs.readFileSync(systemSourcePath, 'utf8')
+
+    assert.match(displaySource, /if \(\+\+active_col == 8\)\s*\{\s*active_col = 0;\s*\/\/[^\n]*\n\s*buttons\.sample\(\);/)
+    assert.match(displaySource, /buttons\.begin\(\);\s*timer\.start\(\);/)
+    assert.match(displaySource, /timer\.stop\(\);\s*buttons\.end\(\);/)
+    assert.doesNotMatch(systemSource, /PINC/)
+    assert.match(systemSource, /static inline bool button1_is_low\(\) \{ return buttons\.isDown\(Buttons::BUTTON_1\); \}/)
+    assert.match(systemSource, /static inline bool button2_is_low\(\) \{ return buttons\.isDown\(Buttons::BUTTON_2\); \}/)
+    assert.match(systemSource, /buttons\.consumeLongPress\(\)/)
+})
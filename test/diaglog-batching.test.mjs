@@ -0,0 +1,93 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { spawnSync } from 'node:child_process'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+
+// Datasheet erase-and-write time of one internal EEPROM byte.
+const EEPROM_WRITE_MS = 3.4
+
+/**
+ * Compile and run the diagnostic log probe.
+ *
+ * @returns {Record<string, string>} Probe results by key.
+ */
+function runDiagLogProbe() {
+    const output = path.join(os.tmpdir(), 'blinkenstar-diaglog-host')
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-DDIAG_INTERNAL_LOG',
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'System'),
+            path.join(firmwareRoot, 'test', 'DiagLogHost.cpp'),
+            path.join(firmwareRoot, 'lib', 'System', 'DiagLog.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+    assert.equal(compile.status, 0, compile.stderr || compile.stdout)
+
+    const run = spawnSync(output, [], { cwd: repoRoot, encoding: 'utf8' })
+    assert.equal(run.status, 0, run.stderr || run.stdout)
+    return Object.fromEntries(run.stdout.trim().split('\n').map((line) => line.split(' ')))
+}
+
+/**
+ * Verify that a received frame no longer stalls on internal EEPROM writes.
+ */
+test('diagnostic counters stay in SRAM until the frame completes', (t) => {
+    const result = runDiagLogProbe()
+    const legacyWrites = Number(result.legacy_receive_writes)
+
+    t.diagnostic(
+        `per-frame stall: ${(legacyWrites * EEPROM_WRITE_MS).toFixed(1)} ms before, 0 ms now; ` +
+            `the record follows in ${result.flush_passes} non-blocking loop passes`
+    )
+    // The old write-through log blocked once per state change and counter step.
+    assert.ok(legacyWrites >= 30, `legacy writes ${legacyWrites}`)
+    assert.equal(result.receive_writes, '0')
+    // One EEPROM slot per flush, started one byte per pass without waiting.
+    assert.ok(Number(result.flush_writes) <= 32)
+    assert.equal(result.max_pass_writes, '1')
+})
+
+/**
+ * Verify that a brown-out mid-flush and the sequence wrap keep the log readable.
+ */
+test('diagnostic records survive torn flushes and sequence wrap', () => {
+    const result = runDiagLogProbe()
+    const [intact, points] = result.torn_ok.split('/').map(Number)
+
+    assert.ok(points > 0)
+    assert.equal(intact, points)
+    assert.equal(result.wrap_ok, '1')
+})
+
+/**
+ * Verify that a flush writes the snapshot taken when it started, not counters that changed during it.
+ */
+test('diagnostic flushes write a consistent snapshot', () => {
+    const result = runDiagLogProbe()
+
+    assert.equal(result.snapshot_ok, '1')
+})
+
+/**
+ * Verify that the firmware flushes the record on shutdown and services it from the main loop.
+ */
+test('system services and flushes the diagnostic log', () => {
+    const system = fs.readFileSync(path.join(firmwareRoot, 'lib', 'System', 'System.cpp'), 'utf8')
+    const receiver = fs.readFileSync(path.join(firmwareRoot, 'lib', 'Modem', 'Receiver.cpp'), 'utf8')
+
+    assert.match(system, /diaglog::service\(\);/)
+    assert.match(system, /trace::flush\(\);[\s\S]*diaglog::flush\(\);[\s\S]*PCMSK1/)
+    assert.match(receiver, /trace::record\(trace::RX_TIMEOUT\);\s*diaglog::markTimeout\(\);/)
+})
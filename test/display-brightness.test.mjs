@@ -0,0 +1,96 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { encodeFramesPattern, encodeTextPattern, runDisplaySimulation } from '../scripts/lib/display-sim.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const displaySourcePath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.cpp')
+const receiverSourcePath = path.join(repoRoot, 'firmware', 'lib', 'Modem', 'Receiver.cpp')
+const systemSourcePath = path.join(repoRoot, 'firmware', 'lib', 'System', 'System.cpp')
+const timerSourcePath = path.join(repoRoot, 'firmware', 'lib', 'Timer', 'Timer.cpp')
+
+const REFRESHES = 100
+
+/**
+ * Return the fraction of simulated timer ticks during which a column was driven.
+ *
+ * @param {{duty: {litTicks: number, totalTicks: number}}} result Simulation result.
+ * @returns {number} Column duty cycle between 0 and 1.
+ */
+function duty(result) {
+    return result.duty.litTicks / result.duty.totalTicks
+}
+
+/**
+ * Verify that each global level lights the matrix for level/8 of every column slot.
+ */
+test('global brightness levels scale the column duty cycle', () => {
+    const pattern = encodeTextPattern({ text: 'Hi' })
+    for (const level of [8, 4, 2, 1]) {
+        const result = runDisplaySimulation({ pattern, refreshes: REFRESHES, brightness: level })
+
+        assert.equal(result.duty.totalTicks, REFRESHES * 8 * 2048)
+        assert.equal(duty(result), level / 8, `level ${level}`)
+    }
+})
+
+/**
+ * Verify that full brightness keeps one compare interrupt per column and dimming adds exactly one.
+ */
+test('dimmed columns cost one extra multiplex interrupt', () => {
+    const pattern = encodeTextPattern({ text: 'Hi' })
+
+    assert.equal(runDisplaySimulation({ pattern, refreshes: REFRESHES }).duty.isrCalls, REFRESHES * 8)
+    assert.equal(runDisplaySimulation({ pattern, refreshes: REFRESHES, brightness: 2 }).duty.isrCalls, REFRESHES * 16)
+})
+
+/**
+ * Verify that a pattern header cap can only dim below the global level.
+ */
+test('pattern brightness caps apply the lower of cap and global level', () => {
+    const capped = encodeTextPattern({ text: 'Hi', brightness: 2 })
+    const frames = encodeFramesPattern({ frames: [[0, 0, 0, 0, 0, 0, 0, 0]], brightness: 4 })
+
+    assert.equal(duty(runDisplaySimulation({ pattern: capped, refreshes: REFRESHES })), 2 / 8)
+    assert.equal(duty(runDisplaySimulation({ pattern: capped, refreshes: REFRESHES, brightness: 1 })), 1 / 8)
+    assert.equal(duty(runDisplaySimulation({ pattern: frames, refreshes: REFRESHES })), 4 / 8)
+})
+
+/**
+ * Verify that dimming changes only the on-time, never the frame sequence or its timing.
+ */
+test('brightness does not change the rendered frame timeline', () => {
+    const plain = runDisplaySimulation({ pattern: encodeTextPattern({ text: 'Blinkenstar' }), refreshes: 600 })
+    const dimmed = runDisplaySimulation({
+        pattern: encodeTextPattern({ text: 'Blinkenstar', brightness: 3 }),
+        refreshes: 600,
+        brightness: 2
+    })
+
+    assert.deepEqual(dimmed.frames, plain.frames)
+})
+
+/**
+ * Verify the firmware wiring: the ISR splits a dimmed column, the receiver decodes the cap bits, and the chord steps the level.
+ */
+test('firmware decodes brightness caps and steps the level from the button chord', () => {
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const receiverSource = fs.readFileSync(receiverSourcePath, 'utf8')
+    const systemSource = fs.readFileSync(systemSourcePath, 'utf8')
+    const timerSource = fs.readFileSync(timerSourcePath, 'utf8')
+
+    assert.match(
+        displaySource,
+        /void Display::multiplex\(\)\s*\{[^]*?if \(column_lit_\)\s*\{\s*PORTB = 0x00;\s*column_lit_ = false;\s*timer\.setPeriodTicks\(column_off_ticks_\);\s*return;\s*\}/
+    )
+    assert.match(displaySource, /timer\.setPeriodTicks\(column_on_ticks_\);\s*column_lit_ = column_off_ticks_ != 0;/)
+    // A phase already overdue when its period is written fires right away instead of after a counter wrap.
+    assert.match(timerSource, /OCR1A = ticks - 1;[^]*?if \(TCNT1 > OCR1A\)\s*\{\s*TCNT1 = ticks >= 3 \? ticks - 3 : 0;\s*\}/)
+    assert.match(receiverSource, /anim\.direction = \(p3 >> 4\) & 0x01;\s*anim\.brightness = \(p3 >> 5\);/)
+    assert.match(receiverSource, /anim\.brightness = \(p2 >> 4\) & 0x07;/)
+    assert.match(systemSource, /display\.stepBrightness\(\);/)
+})
@@ -0,0 +1,77 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const displayHeaderPath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.h')
+const displaySourcePath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.cpp')
+
+/**
+ * Return the source text of one `Display::` method body.
+ *
+ * @param {string} source Display.cpp contents.
+ * @param {string} signature Method signature prefix to locate.
+ * @returns {string} Method text up to the next top-level definition.
+ */
+function methodSource(source, signature) {
+    const start = source.indexOf(signature)
+    assert.notEqual(start, -1, `expected ${signature} in Display.cpp`)
+    const next = source.indexOf('\n}\n', start)
+    return source.slice(start, next + 2)
+}
+
+/**
+ * Verify that the ISR scrolls text from the pre-rendered queue instead of waiting for the main loop.
+ */
+test('multiplex ISR shifts queued text columns on the scroll threshold', () => {
+    const displayHeader = fs.readFileSync(displayHeaderPath, 'utf8')
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const multiplex = methodSource(displaySource, 'void Display::multiplex()')
+    const shift = methodSource(displaySource, 'inline void Display::shiftInQueuedColumn_()')
+
+    assert.match(displayHeader, /#ifndef DISPLAY_COLUMN_QUEUE_SIZE\s*#define DISPLAY_COLUMN_QUEUE_SIZE 8\s*#endif/s)
+    assert.match(displayHeader, /uint8_t col_queue\[DISPLAY_COLUMN_QUEUE_SIZE\];/)
+    assert.match(displayHeader, /volatile uint8_t col_queue_head;/)
+    assert.match(displayHeader, /volatile uint8_t col_queue_tail;/)
+    assert.match(
+        multiplex,
+        /if \(\+\+update_cnt == update_threshold\)\s*\{\s*update_cnt = 0;[^}]*if \(col_queue_head != col_queue_tail\)\s*\{\s*shiftInQueuedColumn_\(\);\s*\}\s*need_update = 1;/s
+    )
+    assert.match(shift, /uint8_t \*buf = disp_buf\[front_buf\];/)
+    assert.doesNotMatch(shift, /pgm_read|loadChunk/)
+})
+
+/**
+ * Verify that font lookups and chunk loads stay in the main-loop refill path.
+ */
+test('main loop pre-renders text columns and finishes the cycle after the queue drains', () => {
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const update = methodSource(displaySource, 'void Display::update()')
+    const updateText = methodSource(displaySource, 'void Display::updateText_(')
+    const render = methodSource(displaySource, 'uint8_t Display::renderTextColumn_(')
+
+    assert.match(update, /updateText_\(boot_message_active\);/)
+    assert.doesNotMatch(update, /font\[/)
+    assert.match(render, /ensureStorageChunkLoaded_\(\);/)
+    assert.match(render, /pgm_read_ptr\(&font\[current_anim->data\[chunk_offset\]\]\)/)
+    assert.match(updateText, /if \(text_cycle_done_ && col_queue_head == col_queue_tail\)\s*\{\s*text_cycle_done_ = false;\s*if \(finishAnimationCycle_\(\)/s)
+    assert.match(
+        updateText,
+        /while \(!text_cycle_done_ && \(uint8_t\)\(col_queue_tail - col_queue_head\) < DISPLAY_COLUMN_QUEUE_SIZE\)\s*\{\s*col_queue\[col_queue_tail & kColumnQueueMask\] = renderTextColumn_\(boot_message\);\s*col_queue_tail\+\+;/s
+    )
+})
+
+/**
+ * Verify that starting or freezing content drops stale queued columns under the interrupt lock.
+ */
+test('reset and freeze clear the column queue atomically', () => {
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const reset = methodSource(displaySource, 'void Display::reset()')
+    const freeze = methodSource(displaySource, 'void Display::freezeState(')
+
+    assert.match(reset, /cli\(\);[^]*clearColumnQueue_\(\);\s*SREG = oldSREG;/)
+    assert.match(freeze, /cli\(\);[^]*clearColumnQueue_\(\);\s*SREG = oldSREG;/)
+})
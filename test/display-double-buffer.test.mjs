@@ -0,0 +1,63 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const displayHeaderPath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.h')
+const displaySourcePath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.cpp')
+
+/**
+ * Return the source text of one `Display::` method body.
+ *
+ * @param {string} source Display.cpp contents.
+ * @param {string} signature Method signature prefix to locate.
+ * @returns {string} Method text up to the next top-level definition.
+ */
+function methodSource(source, signature) {
+    const start = source.indexOf(signature)
+    assert.notEqual(start, -1, `expected ${signature} in Display.cpp`)
+    const next = source.indexOf('\n}\n', start)
+    return source.slice(start, next + 2)
+}
+
+/**
+ * Verify that the multiplex ISR scans a front buffer and only flips on a full-refresh boundary.
+ */
+test('multiplex ISR scans the front buffer and flips only between full refreshes', () => {
+    const displayHeader = fs.readFileSync(displayHeaderPath, 'utf8')
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const multiplex = methodSource(displaySource, 'void Display::multiplex()')
+
+    assert.match(displayHeader, /uint8_t disp_buf\[2\]\[8\];/)
+    assert.match(displayHeader, /volatile uint8_t front_buf;/)
+    assert.match(displayHeader, /volatile uint8_t swap_pending;/)
+    assert.match(multiplex, /uint8_t rows = disp_buf\[front_buf\]\[active_col\];/)
+    assert.match(multiplex, /if \(\+\+active_col == 8\)\s*\{\s*active_col = 0;[^}]*if \(swap_pending\)\s*\{\s*front_buf \^= 1;\s*swap_pending = 0;\s*\}/s)
+})
+
+/**
+ * Verify that the main-loop renderer never writes the buffer the ISR is scanning.
+ */
+test('display update renders into the back buffer and defers while a swap is pending', () => {
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const update = methodSource(displaySource, 'void Display::update()')
+
+    assert.match(update, /if \(swap_pending\)\s*\{\s*return;\s*\}\s*need_update = 0;/s)
+    assert.doesNotMatch(update, /disp_buf\[front_buf\]\[/)
+    assert.doesNotMatch(update, /disp_buf\[i\]/)
+    assert.match(update, /uint8_t \*buf = disp_buf\[front_buf \^ 1\];/)
+    assert.match(update, /swap_pending = 1;/)
+})
+
+/**
+ * Verify that direct column writes are batched into the back buffer under an interrupt lock.
+ */
+test('direct column writes batch into the back buffer atomically', () => {
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const setColumn = methodSource(displaySource, 'void Display::setColumn(')
+
+    assert.match(setColumn, /cli\(\);\s*backBuffer_\(\)\[idx\] = value;\s*swap_pending = 1;\s*SREG = oldSREG;/s)
+})
@@ -0,0 +1,255 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+import { inflateSync } from 'node:zlib'
+
+import {
+    encodeFramesPattern,
+    encodeGif,
+    encodePngStrip,
+    encodeTextPattern,
+    findTornFrames,
+    formatTimelineAscii,
+    frameHolds,
+    runDisplaySimulation
+} from '../scripts/lib/display-sim.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const goldenDir = path.join(__dirname, 'golden', 'display')
+
+// Speed nibble 14 maps to 250 - 0xE0 = 26 refreshes per scroll step.
+const TEXT_STEP = 26
+// Frames speed nibble 15 maps to 250 - 0xF0 = 10 refreshes per frame.
+const FRAME_STEP = 10
+
+const SCENARIOS = {
+    'text-left': { pattern: encodeTextPattern({ text: 'Hi' }), refreshes: 420 },
+    'text-right': { pattern: encodeTextPattern({ text: 'Hi', direction: 1 }), refreshes: 420 },
+    'text-pause': { pattern: encodeTextPattern({ text: 'Hi', delay: 1 }), refreshes: 700 },
+    'text-repeat': { pattern: encodeTextPattern({ text: 'Hi', repeat: 2 }), refreshes: 700 },
+    'frames-pause': {
+        pattern: encodeFramesPattern({
+            frames: [
+                [0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81],
+                [0xff, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xff],
+                [0x00, 0x00, 0x3c, 0x3c, 0x3c, 0x3c, 0x00, 0x00]
+            ],
+            speed: 15,
+            delay: 1,
+            repeat: 3
+        }),
+        refreshes: 800
+    },
+    boot: { boot: true, refreshes: 500 }
+}
+
+/**
+ * Compare one simulated timeline with its checked-in golden file. Set
+ * `UPDATE_DISPLAY_GOLDEN=1` to rewrite the golden after an intended change.
+ *
+ * @param {string} name Scenario and golden file name.
+ */
+function assertGolden(name) {
+    const timeline = formatTimelineAscii(runDisplaySimulation(SCENARIOS[name]))
+    const goldenPath = path.join(goldenDir, `${name}.txt`)
+
+    if (process.env.UPDATE_DISPLAY_GOLDEN === '1') {
+        fs.mkdirSync(goldenDir, { recursive: true })
+        fs.writeFileSync(goldenPath, timeline)
+    }
+
+    assert.equal(timeline, fs.readFileSync(goldenPath, 'utf8'))
+}
+
+for (const name of Object.keys(SCENARIOS)) {
+    /**
+     * Verify the rendered frame sequence and timing against the golden timeline.
+     */
+    test(`display simulator matches the ${name} golden timeline`, () => {
+        assertGolden(name)
+    })
+}
+
+/**
+ * Verify that no frame mixes two animation steps, even when update() lands mid-scan.
+ */
+test('display frames are never torn by main-loop updates', () => {
+    for (const loopEvery of [1, 3, 5]) {
+        const text = runDisplaySimulation({ pattern: encodeTextPattern({ text: 'Blinkenstar' }), refreshes: 1500, loopEvery })
+        const frames = runDisplaySimulation({ ...SCENARIOS['frames-pause'], loopEvery })
+
+        assert.deepEqual(findTornFrames(text, TEXT_STEP), [], `text torn with loopEvery=${loopEvery}`)
+        assert.deepEqual(findTornFrames(frames, FRAME_STEP), [], `frames torn with loopEvery=${loopEvery}`)
+    }
+})
+
+/**
+ * Verify that text keeps its scroll cadence while the main loop is stalled for about 100 ms at a time.
+ */
+test('text scroll cadence survives a busy main loop', () => {
+    const result = runDisplaySimulation({
+        pattern: encodeTextPattern({ text: 'Blinkenstar' }),
+        refreshes: 1200,
+        loopEvery: 400
+    })
+    const holds = frameHolds(result).slice(1, -1)
+
+    assert.ok(holds.length > 40)
+    assert.deepEqual([...new Set(holds)], [TEXT_STEP])
+})
+
+/**
+ * Verify that storage-backed text streams past the first 128-byte chunk.
+ */
+test('storage-backed text scrolls into the second payload chunk', () => {
+    const stored = runDisplaySimulation({
+        pattern: encodeTextPattern({ text: `${'I'.repeat(128)}H`, speed: 15 }),
+        storage: true,
+        refreshes: 3000
+    })
+    const reference = runDisplaySimulation({ pattern: encodeTextPattern({ text: 'IIIIIIIIH', speed: 15 }), refreshes: 260 })
+    const shown = new Set(stored.frames.map((frame) => frame.columns.join(',')))
+
+    // Frames 18..24 of the RAM reference scroll the H in behind a run of I glyphs.
+    for (const frame of reference.frames.slice(18, 25)) {
+        assert.ok(shown.has(frame.columns.join(',')), `missing frame from chunk 1 at reference refresh ${frame.refresh}`)
+    }
+})
+
+/**
+ * Verify that update() timing is reported for every simulated main-loop call.
+ */
+test('display simulator reports update() timing', () => {
+    const result = runDisplaySimulation({ pattern: encodeTextPattern({ text: 'Hi' }), refreshes: 100, loopEvery: 2 })
+
+    assert.equal(result.update.calls, 400)
+    assert.ok(result.update.maxNs >= result.update.meanNs)
+})
+
+/**
+ * Verify that the PNG strip is a well-formed indexed image with one cell per frame.
+ */
+test('encodePngStrip writes an indexed PNG strip', () => {
+    const frames = [[0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe], [0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff]]
+    const png = encodePngStrip(frames, { scale: 2 })
+
+    assert.deepEqual([...png.subarray(0, 8)], [0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a])
+    assert.equal(png.readUInt32BE(16), 2 * 16 + 2)
+    assert.equal(png.readUInt32BE(20), 16)
+
+    const idatStart = png.indexOf('IDAT') + 4
+    const idatLength = png.readUInt32BE(idatStart - 8)
+    const raw = inflateSync(png.subarray(idatStart, idatStart + idatLength))
+    const stride = 2 * 16 + 2 + 1
+    assert.equal(raw.length, stride * 16)
+    // Top-left pixel of frame 1 is column 7, row 0 lit; frame 2 has column 0 fully lit.
+    assert.equal(raw[1 + 7 * 2], 2)
+    assert.equal(raw[1 + 18], 2)
+    assert.equal(raw[1 + 16], 0)
+})
+
+/**
+ * Decode the LZW image data of one GIF frame.
+ *
+ * @param {number[]} data Concatenated sub-block payload.
+ * @param {number} minCodeSize GIF minimum code size.
+ * @returns {number[]} Palette indices.
+ */
+function decodeGifLzw(data, minCodeSize) {
+    const clearCode = 1 << minCodeSize
+    const endCode = clearCode + 1
+    let codeSize = minCodeSize + 1
+    let table = []
+    let previous = null
+    const out = []
+    let bitPos = 0
+
+    const reset = () => {
+        table = Array.from({ length: clearCode }, (_, i) => [i])
+        table.push(null, null)
+        codeSize = minCodeSize + 1
+        previous = null
+    }
+    reset()
+
+    while (bitPos + codeSize <= data.length * 8) {
+        let code = 0
+        for (let i = 0; i < codeSize; i++, bitPos++) {
+            code |= ((data[bitPos >> 3] >> (bitPos & 7)) & 1) << i
+        }
+        if (code === clearCode) {
+            reset()
+            continue
+        }
+        if (code === endCode) {
+            break
+        }
+        let entry = table[code]
+        if (entry === undefined) {
+            entry = [...previous, previous[0]]
+        }
+        out.push(...entry)
+        if (previous !== null && table.length < 4096) {
+            table.push([...previous, entry[0]])
+            if (table.length === 1 << codeSize && codeSize < 12) {
+                codeSize++
+            }
+        }
+        previous = entry
+    }
+    return out
+}
+
+/**
+ * Verify that the animated GIF carries one decodable image per frame with refresh-based delays.
+ */
+test('encodeGif writes one timed image per captured frame', () => {
+    const result = runDisplaySimulation(SCENARIOS['text-left'])
+    const gif = encodeGif(result, { scale: 3 })
+
+    assert.equal(gif.subarray(0, 6).toString('ascii'), 'GIF89a')
+    assert.equal(gif.readUInt16LE(6), 24)
+    assert.equal(gif[gif.length - 1], 0x3b)
+
+    let offset = 13 + 4 * 3
+    const images = []
+    const delays = []
+    while (gif[offset] !== 0x3b) {
+        if (gif[offset] === 0x21) {
+            if (gif[offset + 1] === 0xf9) {
+                delays.push(gif.readUInt16LE(offset + 4))
+            }
+            offset += 2
+            while (gif[offset] !== 0) {
+                offset += gif[offset] + 1
+            }
+            offset++
+        } else {
+            assert.equal(gif[offset], 0x2c)
+            const minCodeSize = gif[offset + 10]
+            offset += 11
+            const data = []
+            while (gif[offset] !== 0) {
+                data.push(...gif.subarray(offset + 1, offset + 1 + gif[offset]))
+                offset += gif[offset] + 1
+            }
+            offset++
+            images.push(decodeGifLzw(data, minCodeSize))
+        }
+    }
+
+    assert.equal(images.length, result.frames.length)
+    assert.equal(delays[1], Math.round((TEXT_STEP * 2048) / 10000))
+    for (const [index, frame] of result.frames.entries()) {
+        const pixels = images[index]
+        assert.equal(pixels.length, 24 * 24)
+        for (let col = 0; col < 8; col++) {
+            for (let row = 0; row < 8; row++) {
+                const lit = (frame.columns[col] & (1 << row)) === 0
+                assert.equal(pixels[row * 3 * 24 + col * 3], lit ? 2 : 1)
+            }
+        }
+    }
+})
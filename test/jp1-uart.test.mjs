@@ -0,0 +1,193 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { spawnSync } from 'node:child_process'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+
+// Every byte value, then the refilled text, then the 31 bytes a full 32-byte FIFO holds.
+const EXPECTED = [
+    ...Array.from({ length: 256 }, (_, value) => value),
+    ...Buffer.from('JP1 UART\r\n'),
+    ...Array.from({ length: 31 }, (_, i) => 0x61 + (i % 26))
+]
+
+/**
+ * Compile the UART capture probe for one baud rate.
+ *
+ * @param {number} baud JP1_DEBUG_BAUD value.
+ * @returns {string} Probe binary path.
+ */
+function buildProbe(baud) {
+    const output = path.join(os.tmpdir(), `blinkenstar-debugserial-host-${baud}`)
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-DJP1_DEBUG_SERIAL',
+            `-DJP1_DEBUG_BAUD=${baud}UL`,
+            // Rates above 9600 only build for the headless, polled receiver.
+            ...(baud > 9600 ? ['-DJP1_DEBUG_HEADLESS_RX', '-DRX_POLLING'] : []),
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'DebugSerial'),
+            path.join(firmwareRoot, 'test', 'DebugSerialHost.cpp'),
+            path.join(firmwareRoot, 'lib', 'DebugSerial', 'DebugSerial.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+    assert.equal(compile.status, 0, compile.stderr || compile.stdout)
+    return output
+}
+
+/**
+ * Run the probe and parse its pin capture.
+ *
+ * @param {string} probe Probe binary path.
+ * @param {number} jitterUs Maximum simulated interrupt latency.
+ * @returns {{edges: {ns: number, level: number}[], endNs: number}} TX pin transitions.
+ */
+function capture(probe, jitterUs) {
+    const run = spawnSync(probe, ['--jitter-us', String(jitterUs)], { cwd: repoRoot, encoding: 'utf8' })
+    assert.equal(run.status, 0, run.stderr || run.stdout)
+
+    const edges = []
+    let endNs = 0
+    for (const line of run.stdout.trim().split('\n')) {
+        const [kind, ns, level] = line.split(' ')
+        if (kind === 'T') {
+            edges.push({ ns: Number(ns), level: Number(level) })
+        } else if (kind === 'E') {
+            endNs = Number(ns)
+        }
+    }
+    return { edges, endNs }
+}
+
+/**
+ * Decode 8N1 frames from a pin capture the way a USB-UART adapter does: sync on
+ * each start edge and sample every bit in its middle.
+ *
+ * @param {{edges: {ns: number, level: number}[], endNs: number}} trace TX pin transitions, idle high.
+ * @param {number} baud Receiver baud rate.
+ * @returns {{bytes: number[], framingErrors: number, maxEdgeErrorBits: number}}
+ *     Decoded bytes, frames with a low stop bit, and the largest distance of any
+ *     edge from its ideal time relative to the start edge, in bit periods.
+ */
+function decodeUart({ edges, endNs }, baud) {
+    const bitNs = 1e9 / baud
+    const levelAt = (ns) => {
+        let level = 1
+        for (const edge of edges) {
+            if (edge.ns > ns) {
+                break
+            }
+            level = edge.level
+        }
+        return level
+    }
+
+    const bytes = []
+    let framingErrors = 0
+    let maxEdgeErrorBits = 0
+    let index = 0
+    while (index < edges.length) {
+        const start = edges[index]
+        if (start.level !== 0) {
+            index++
+            continue
+        }
+
+        let value = 0
+        for (let bit = 0; bit < 8; bit++) {
+            value |= levelAt(start.ns + (bit + 1.5) * bitNs) << bit
+        }
+        if (levelAt(start.ns + 9.5 * bitNs) !== 1) {
+            framingErrors++
+        }
+        bytes.push(value)
+
+        const frameEnd = start.ns + 9.5 * bitNs
+        index++
+        while (index < edges.length && edges[index].ns < frameEnd) {
+            const offset = (edges[index].ns - start.ns) / bitNs
+            maxEdgeErrorBits = Math.max(maxEdgeErrorBits, Math.abs(offset - Math.round(offset)))
+            index++
+        }
+    }
+    assert.ok(endNs >= (edges.at(-1)?.ns ?? 0))
+    return { bytes, framingErrors, maxEdgeErrorBits }
+}
+
+/*
+ * Timer0 ticks every 8 us, so 31250 baud is exactly four ticks per bit while
+ * 9600, 38400 and 57600 baud round each edge to the nearest tick. The jitter is the
+ * largest simulated interrupt latency each rate still tolerates; a receiver
+ * syncs on the start edge, so an edge may move by up to one tick against it.
+ */
+const RATES = [
+    { baud: 9600, jitterUs: 50 },
+    { baud: 31250, jitterUs: 15 },
+    { baud: 38400, jitterUs: 6 },
+    { baud: 57600, jitterUs: 0 }
+]
+
+for (const { baud, jitterUs } of RATES) {
+    /**
+     * Verify that an independent receiver reads every queued byte back at this baud rate.
+     */
+    test(`JP1 UART capture decodes cleanly at ${baud} baud`, () => {
+        const probe = buildProbe(baud)
+        const clean = decodeUart(capture(probe, 0), baud)
+        const jittered = decodeUart(capture(probe, jitterUs), baud)
+        const tickBits = (8e3 * baud) / 1e9
+
+        assert.deepEqual(clean.bytes, EXPECTED)
+        assert.equal(clean.framingErrors, 0)
+        // Rounding never accumulates across a frame.
+        assert.ok(clean.maxEdgeErrorBits <= tickBits + 1e-9, `edge error ${clean.maxEdgeErrorBits}`)
+
+        assert.deepEqual(jittered.bytes, EXPECTED)
+        assert.equal(jittered.framingErrors, 0)
+    })
+}
+
+/**
+ * Verify that the transmitter no longer busy-waits with interrupts disabled.
+ */
+test('JP1 UART is interrupt driven instead of bit-banged under cli()', () => {
+    const source = fs.readFileSync(path.join(firmwareRoot, 'lib', 'DebugSerial', 'DebugSerial.cpp'), 'utf8')
+    const platformio = fs.readFileSync(path.join(firmwareRoot, 'platformio.ini'), 'utf8')
+
+    assert.doesNotMatch(source, /_delay_us/)
+    assert.match(source, /ISR\(TIMER0_COMPA_vect\)/)
+    assert.match(source, /while \(next == fifo_tail\)\s*\{\s*if \(!\(SREG & _BV\(SREG_I\)\)\)/)
+    assert.match(source, /#define JP1_DEBUG_BAUD 9600UL/)
+    assert.match(platformio, /HEADLESS_RX\n[^\n]*\n    -DJP1_DEBUG_BAUD=38400/)
+})
+
+/**
+ * Verify that a rate above 9600 does not build while the display or ADC interrupt can delay bit edges.
+ */
+test('JP1 UART rejects fast rates outside the headless polled build', () => {
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-fsyntax-only',
+            '-DJP1_DEBUG_SERIAL',
+            '-DJP1_DEBUG_BAUD=38400UL',
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'DebugSerial'),
+            path.join(firmwareRoot, 'lib', 'DebugSerial', 'DebugSerial.cpp')
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+    assert.notEqual(compile.status, 0)
+    assert.match(compile.stderr, /JP1_DEBUG_BAUD above 9600 needs JP1_DEBUG_HEADLESS_RX and RX_POLLING/)
+})
@@ -0,0 +1,134 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import { execFileSync } from 'node:child_process'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { loopbackOptical } from '../scripts/lib/loopback.mjs'
+import { OPTICAL_FPS, createLightSamples, createOpticalPlayerHtml, encodeOpticalFrames } from '../scripts/lib/optical-transfer.mjs'
+import { createTransferTestPattern, encodeTransferPayloads } from '../scripts/lib/transfer-tone.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const cliPath = path.join(repoRoot, 'scripts', 'export-optical-transfer.mjs')
+const packageJson = JSON.parse(fs.readFileSync(path.join(repoRoot, 'package.json'), 'utf8'))
+
+const patterns = [createTransferTestPattern({ token: 'A1B2C3' })]
+
+/**
+ * Split frames into runs of equal brightness.
+ *
+ * @param {Uint8Array} frames Encoded frames.
+ * @returns {Array<{lit: number, length: number}>} Runs in display order.
+ */
+function frameRuns(frames) {
+    const runs = []
+    for (const lit of frames) {
+        if (runs.length > 0 && runs.at(-1).lit === lit) {
+            runs.at(-1).length += 1
+        } else {
+            runs.push({ lit, length: 1 })
+        }
+    }
+    return runs
+}
+
+/**
+ * Verify that every FEC bit becomes one alternating symbol, two frames for a 0 and five for a 1, between dark padding.
+ */
+test('optical frames carry the legacy FEC stream as alternating symbols', () => {
+    const frames = encodeOpticalFrames(patterns)
+    const runs = frameRuns(frames)
+    const bits = Array.from(encodeTransferPayloads(patterns).legacyFecBytes).flatMap((byte) =>
+        Array.from({ length: 8 }, (_, bit) => (byte >> bit) & 1))
+
+    assert.deepEqual(runs[0], { lit: 0, length: 30 })
+    assert.deepEqual(runs.slice(1, bits.length + 1).map((run) => run.length), bits.map((bit) => (bit ? 5 : 2)))
+    assert.equal(runs[1].lit, 1)
+    assert.equal(runs.at(-1).lit, 0)
+    assert.equal(runs.at(-2).lit, 1)
+})
+
+/**
+ * Verify that the player page embeds the frames, paces them by time, and escapes the title.
+ */
+test('optical player page flashes the frames at the display rate', () => {
+    const frames = Uint8Array.from([0, 1, 1, 0])
+    const html = createOpticalPlayerHtml(frames, { title: 'A <b> & "c"' })
+
+    assert.match(html, /const frames = '0110'/)
+    assert.match(html, new RegExp(`const fps = ${OPTICAL_FPS}\\b`))
+    assert.match(html, /requestAnimationFrame\(step\)/)
+    assert.match(html, /<title>A &#60;b&#62; &#38; &#34;c&#34;<\/title>/)
+})
+
+/**
+ * Verify that the light model settles on the ambient and lit levels, that a stutter repeats frames, and that a skip
+ * holds the previous frame in place of the skipped one.
+ */
+test('light samples model the screen level behind the sensor pull-up', () => {
+    const frames = Uint8Array.from([0, 1, 1, 1, 0])
+    const samples = createLightSamples(frames, { leadSeconds: 0, tailSeconds: 0, responseMs: 0 })
+    const frame = 48000 / OPTICAL_FPS
+
+    assert.equal(samples.length, 5 * frame)
+    assert.equal(samples[frame / 2], -Math.round(0.2 * 32767))
+    assert.equal(samples[2 * frame], -Math.round(0.8 * 32767))
+    assert.equal(createLightSamples(frames, { leadSeconds: 0, tailSeconds: 0, stutterEvery: 2 }).length, 7 * frame)
+
+    const skipped = createLightSamples(frames, { leadSeconds: 0, tailSeconds: 0, responseMs: 0, skipEvery: 2 })
+    assert.equal(skipped.length, 5 * frame)
+    assert.equal(skipped[frame + frame / 2], -Math.round(0.2 * 32767))
+    assert.equal(skipped[3 * frame + frame / 2], -Math.round(0.8 * 32767))
+})
+
+/**
+ * Verify that the optical build stores a screen-flash transfer under room light flicker, a slow panel, and frames
+ * that a busy browser repeats or skips.
+ */
+test('optical loopback stores the frame through the firmware receive stack', () => {
+    const lights = [
+        {},
+        { flicker: 0.3, contrast: 0.3, responseMs: 10 },
+        { flicker: 0.5, contrast: 0.2, flickerHz: 120 },
+        { responseMs: 12 },
+        { stutterEvery: 10 },
+        // Every skip that lands on a symbol edge shortens one symbol and lengthens its neighbour by a frame.
+        { skipEvery: 5 },
+        { skipEvery: 7, flicker: 0.3 }
+    ]
+    for (const light of lights) {
+        const { scores, result } = loopbackOptical(patterns, light, { noise: 6 })
+
+        assert.equal(scores[0].rawBitErrors, 0, JSON.stringify(light))
+        assert.equal(result.frames.length, 1, JSON.stringify(light))
+        assert.equal(Buffer.from(result.frames[0].patterns[0].slice(4)).toString('ascii'), patterns[0].text)
+    }
+})
+
+/**
+ * Verify that the CLI writes a player page for the given text.
+ */
+test('optical transfer CLI writes the flash player page', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'optical-transfer-'))
+    const htmlPath = path.join(dir, 'flash.html')
+
+    try {
+        const output = execFileSync(process.execPath, [cliPath, '--text', 'HELLO', '--out', htmlPath], { encoding: 'utf8' })
+        const frames = encodeOpticalFrames([{ ...createTransferTestPattern({ token: '' }), text: 'HELLO' }])
+
+        assert.match(output, new RegExp(`Wrote ${frames.length} frames`))
+        assert.ok(fs.readFileSync(htmlPath, 'utf8').includes(`const frames = '${frames.join('')}'`))
+    } finally {
+        fs.rmSync(dir, { recursive: true, force: true })
+    }
+})
+
+/**
+ * Verify that the npm script exposes the optical export CLI.
+ */
+test('package.json exposes the transfer:optical script', () => {
+    assert.equal(packageJson.scripts['transfer:optical'], 'node scripts/export-optical-transfer.mjs')
+})
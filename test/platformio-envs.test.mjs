@@ -110,3 +110,19 @@ test('hwdiag keeps button diagnostics while enabling the boot-message renderer f
     assert.match(hwdiag, /-DDIAG_BUTTONS/)
     assert.match(hwdiag, /-DDIAG_BOOT_MESSAGE/)
 })
+
+/**
+ * Verify that `optical` is the release build moved to the light sensor input with the host probe's optical flags.
+ */
+test('optical env reads the JP2 light sensor with the flags the optical loopback uses', async () => {
+    const { OPTICAL_DEFINES } = await import('../scripts/lib/loopback.mjs')
+    const optical = getEnvSection('optical')
+
+    assert.ok(optical, 'expected env:optical to exist')
+    assert.match(optical, /extends = env:release/)
+    assert.match(optical, /build_unflags =\s*-DMODEM_ADC_CHANNEL=6/)
+    assert.match(optical, /-DMODEM_ADC_CHANNEL=7/)
+    for (const define of OPTICAL_DEFINES) {
+        assert.match(optical, new RegExp(`-D${define}\\s`))
+    }
+})
@@ -16,7 +16,7 @@ test('system initialization captures and clears MCUSR before logging or branchin
 
     assert.match(systemSource, /const uint8_t reset_cause = MCUSR;/)
     assert.match(systemSource, /MCUSR = 0;/)
-    assert.match(systemSource, /debuglog::printlnHex8\(reset_cause\);/)
+    assert.match(systemSource, /trace::record\(trace::BOOT, reset_cause\);/)
     assert.match(systemSource, /uint8_t mcusr = reset_cause;/)
 })
 
@@ -37,5 +37,5 @@ test('jp1 diagnostics can skip modem bring-up while keeping boot logging alive',
     const systemSource = fs.readFileSync(systemPath, 'utf8')
 
     assert.match(systemSource, /#ifdef JP1_DEBUG_SKIP_MODEM/)
-    assert.match(systemSource, /debuglog::println\("MODEM SKIP"\);/)
+    assert.match(systemSource, /trace::record\(trace::MODEM_SKIP\);/)
 })
@@ -0,0 +1,144 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { spawnSync } from 'node:child_process'
+import { fileURLToPath } from 'node:url'
+
+import { loadTraceEvents } from '../scripts/lib/trace-decode.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+
+// Task ids in firmware/test/SchedulerHost.cpp.
+const RECEIVE = 0
+const DISPLAY = 1
+const BUTTONS = 2
+const DRAIN = 3
+const SLEEPER = 4
+
+/**
+ * Compile and run the scheduler probe.
+ *
+ * @returns {{phases: Map<string, {tasks: object[], busiestPass: number}>, records: {name: string, arg: number}[]}}
+ *     Task statistics per phase and the trace records in output order.
+ */
+function runSchedulerProbe() {
+    const output = path.join(os.tmpdir(), 'blinkenstar-scheduler-host')
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-DSCHED_STATS=1',
+            '-DJP1_DEBUG_SERIAL',
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'System'),
+            '-I', path.join(firmwareRoot, 'lib', 'Trace'),
+            path.join(firmwareRoot, 'test', 'SchedulerHost.cpp'),
+            path.join(firmwareRoot, 'lib', 'System', 'Scheduler.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+    assert.equal(compile.status, 0, compile.stderr || compile.stdout)
+
+    const run = spawnSync(output, [], { cwd: repoRoot, encoding: 'utf8' })
+    assert.equal(run.status, 0, run.stderr || run.stdout)
+
+    const events = loadTraceEvents()
+    const phases = new Map()
+    const records = []
+    let phase = null
+    for (const line of run.stdout.trim().split('\n')) {
+        const fields = line.split(' ')
+        if (fields[0] === 'phase') {
+            phase = { tasks: [], busiestPass: 0 }
+            phases.set(fields[1], phase)
+        } else if (fields[0] === 'task') {
+            const [, , , runs, , worstUs, , overruns, , late] = fields.map(Number)
+            phase.tasks.push({ runs, worstUs, overruns, late })
+        } else if (fields[0] === 'busiest_pass') {
+            phase.busiestPass = Number(fields[1])
+        } else if (fields[0] === 'record') {
+            records.push({ name: events.get(parseInt(fields[1], 16)), arg: parseInt(fields[2], 16), phase })
+        }
+    }
+    return { phases, records }
+}
+
+/**
+ * Verify periods, priorities and the one-housekeeping-task-per-pass bound.
+ */
+test('scheduler runs critical tasks every pass and housekeeping on its period', () => {
+    const { phases } = runSchedulerProbe()
+    const steady = phases.get('steady')
+
+    // One second of 256 us column ticks.
+    assert.equal(steady.tasks[RECEIVE].runs, 3907)
+    assert.equal(steady.tasks[DISPLAY].runs, 3907)
+    assert.ok(Math.abs(steady.tasks[BUTTONS].runs - 100) <= 1, `buttons ${steady.tasks[BUTTONS].runs}`)
+    assert.equal(steady.tasks[DRAIN].runs, 500)
+    assert.equal(steady.tasks[SLEEPER].runs, 20)
+    assert.ok(steady.tasks.every((task) => task.late === 0 && task.overruns === 0))
+
+    for (const phase of phases.values()) {
+        assert.equal(phase.busiestPass, 1)
+    }
+
+    // A 3 ms receive burst starves the lowest-priority short period, not the button task.
+    const burst = phases.get('burst')
+    assert.equal(burst.tasks[RECEIVE].overruns, 32)
+    assert.equal(burst.tasks[BUTTONS].late, 0)
+    assert.ok(burst.tasks[DRAIN].late > 0)
+
+    // Sleeping inside a task is neither charged to it nor counted against the others.
+    const sleep = phases.get('sleep')
+    assert.equal(sleep.tasks[SLEEPER].worstUs, 10)
+    assert.equal(sleep.tasks[DRAIN].late, burst.tasks[DRAIN].late)
+    assert.equal(sleep.tasks[BUTTONS].late, 0)
+})
+
+/**
+ * Verify the overrun and statistics trace records.
+ */
+test('scheduler reports overruns and deadline misses as trace records', () => {
+    const { records } = runSchedulerProbe()
+    const overruns = records.filter((record) => record.name === 'TASK_OVERRUN')
+
+    // Task id in the top nibble, run time in 16 us units.
+    assert.deepEqual(
+        overruns.map(({ arg }) => [arg >> 12, (arg & 0x0fff) * 16]),
+        [
+            [DRAIN, 896],
+            [RECEIVE, 2992]
+        ]
+    )
+    assert.deepEqual(
+        records.filter((record) => record.name === 'TASK_STATS').map(({ arg }) => [arg >> 8, arg & 0xff]),
+        [
+            [RECEIVE, 32],
+            [DRAIN, 2]
+        ]
+    )
+    assert.deepEqual(
+        records.filter((record) => record.name === 'TASK_LATE').map(({ arg }) => [arg >> 8, arg & 0xff]),
+        [
+            [DRAIN, 12],
+            [SLEEPER, 1]
+        ]
+    )
+})
+
+/**
+ * Verify that System::loop() is the scheduler pass over the firmware task table.
+ */
+test('System::loop runs the task table with the receiver and display as critical tasks', () => {
+    const system = fs.readFileSync(path.join(firmwareRoot, 'lib', 'System', 'System.cpp'), 'utf8')
+
+    assert.match(system, /void System::loop\(\)\s*\{\s*sched::runPass\(\);\s*\}/)
+    assert.match(system, /static const sched::Task tasks\[\] PROGMEM = \{\s*#ifdef ENABLE_MODEM\s*\{System::TASK_RECEIVE, 0, \d+\},\s*#endif\s*\{System::TASK_DISPLAY, 0, \d+\},/)
+    assert.match(system, /startTasks_\(\);\s*\/\/ Enable interrupts globally/)
+    assert.match(system, /sched::resync\(\);\s*\}\s*\/\*\*\s*\* Wake the MCU/)
+})
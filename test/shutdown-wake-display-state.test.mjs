@@ -73,11 +73,11 @@ test('shutdown wake path restarts the modem after ADC power is restored', () =>
 
     const adcEnableIndex = shutdownSource.indexOf('power_adc_enable();')
     const restartIndex = shutdownSource.indexOf('modemReceiver.begin();', adcEnableIndex)
-    const wakeLogIndex = shutdownSource.indexOf('debuglog::println("WAKE");')
+    const wakeLogIndex = shutdownSource.indexOf('trace::record(trace::WAKE);')
 
     assert.notEqual(adcEnableIndex, -1, 'expected shutdown wake path to restore ADC power')
     assert.notEqual(restartIndex, -1, 'expected the modem to restart after ADC power is restored')
-    assert.match(shutdownSource, /power_adc_enable\(\);\s*#ifdef ENABLE_MODEM\s*if \(modem_enabled\)\s*\{\s*modemReceiver\.begin\(\);\s*\}\s*#endif\s*debuglog::println\("WAKE"\);/s)
+    assert.match(shutdownSource, /power_adc_enable\(\);\s*#ifdef ENABLE_MODEM\s*if \(modem_enabled\)\s*\{\s*modemReceiver\.begin\(\);\s*\}\s*#endif\s*trace::record\(trace::WAKE\);/s)
     assert.ok(adcEnableIndex < restartIndex, 'expected modem restart after ADC power is restored')
     assert.ok(restartIndex < wakeLogIndex, 'expected wake logging after the modem is ready again')
 })
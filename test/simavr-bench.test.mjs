@@ -0,0 +1,83 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import { execFileSync, spawnSync } from 'node:child_process'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { RELEASE_ELF, checkSimavrBench, findSimavr, readStoredPatterns, runSimavrBench, simavrTransfer } from '../scripts/lib/simavr-bench.mjs'
+import { createTransferTestPattern } from '../scripts/lib/transfer-tone.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const cliPath = path.join(repoRoot, 'scripts', 'simavr-bench.mjs')
+const packageJson = JSON.parse(fs.readFileSync(path.join(repoRoot, 'package.json'), 'utf8'))
+
+/**
+ * Verify that the stored-pattern reader follows the Storage layout: count, page pointers, then 32-byte pages from byte 256.
+ */
+test('readStoredPatterns reads patterns back through the metadata pointers', () => {
+    const image = Buffer.alloc(8192, 0xff)
+    const first = [0x10, 0x02, 0xe0, 0x00, 0x48, 0x49]
+    const second = [0x10, 0x03, 0xe0, 0x00, 0x41, 0x42, 0x43]
+    image[0] = 2
+    image[1] = 0
+    image[2] = 5
+    Buffer.from(first).copy(image, 256)
+    Buffer.from(second).copy(image, 256 + 5 * 32)
+
+    assert.deepEqual(readStoredPatterns(image), [first, second])
+    assert.deepEqual(readStoredPatterns(Buffer.alloc(8192, 0xff)), [])
+})
+
+/**
+ * Verify that a missing simavr install is reported instead of failing the build, unless CI requires the bench.
+ */
+test('simavr bench skips cleanly without simavr', () => {
+    const empty = fs.mkdtempSync(path.join(os.tmpdir(), 'simavr-missing-'))
+    const env = { ...process.env, SIMAVR_DIR: empty, SIMAVR_BENCH_REQUIRED: '' }
+
+    try {
+        const found = findSimavr(env)
+        assert.equal(found.ok, false)
+        assert.match(found.reason, /simavr headers not found/)
+        assert.match(runSimavrBench(new Uint16Array(16), { env }).skipped, /SIMAVR_DIR/)
+
+        assert.equal(packageJson.scripts['sim:bench'], 'node scripts/simavr-bench.mjs')
+        const output = execFileSync(process.execPath, [cliPath], { cwd: repoRoot, env, encoding: 'utf8' })
+        assert.match(output, /^simavr bench skipped: simavr headers not found/)
+
+        const required = { ...env, SIMAVR_BENCH_REQUIRED: '1' }
+        assert.throws(() => runSimavrBench(new Uint16Array(16), { env: required }), /SIMAVR_BENCH_REQUIRED but cannot run: simavr headers not found/)
+        const failed = spawnSync(process.execPath, [cliPath], { cwd: repoRoot, env: required, encoding: 'utf8' })
+        assert.equal(failed.status, 1)
+        assert.match(failed.stderr, /^simavr bench failed: required by SIMAVR_BENCH_REQUIRED/)
+    } finally {
+        fs.rmSync(empty, { recursive: true, force: true })
+    }
+})
+
+/**
+ * Verify a fast transfer end to end on the release image where simavr and the release build are available.
+ * CI sets SIMAVR_BENCH_REQUIRED=1, which turns the skip into a failure.
+ */
+test('release image stores a transfer under simavr', (t) => {
+    const { skipped } = checkSimavrBench(RELEASE_ELF)
+    if (skipped) {
+        t.skip(skipped)
+        return
+    }
+
+    const pattern = createTransferTestPattern({ token: 'A1B2C3' })
+    const result = simavrTransfer([pattern], { noise: 4 })
+    const adc = result.isrs.find((isr) => isr.name === 'ADC')
+    const display = result.isrs.find((isr) => isr.name === 'TIMER1_COMPA')
+
+    assert.deepEqual(result.eeprom.patterns.map((stored) => Buffer.from(stored.slice(4)).toString('ascii')), [pattern.text])
+    assert.ok(result.eeprom.writeCycles > 0)
+    assert.ok(result.frames.length > 1)
+    // The ADC ISR has to finish well inside one 416-cycle conversion.
+    assert.ok(adc.count > 0 && adc.max < 416, JSON.stringify(adc))
+    assert.ok(display.count > 0, JSON.stringify(display))
+})
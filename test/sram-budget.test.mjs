@@ -0,0 +1,77 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { spawnSync } from 'node:child_process'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+const sramMapPath = path.join(firmwareRoot, 'sram_map.py')
+
+// Trimmed `avr-nm -S -C` listing of a release-style image.
+const NM_LISTING = `00800100 D __data_start
+00800100 00000002 D display
+00800102 00000084 B display_payload_buf
+00800186 00000040 b (anonymous namespace)::ring
+008001c6 00000020 B modemReceiver
+008001e6 00000001 b (anonymous namespace)::flush_pos
+008001e8 B _end
+008001e8 B __heap_start
+00810000 00000038 D diaglog::ee_slots
+00000000 W __vector_default
+`
+
+/**
+ * Verify that the SRAM map sorts objects, sums the static use and flags a thin stack reserve.
+ */
+test('sram_map.py reports static SRAM use and the stack remainder', (t) => {
+    const python = spawnSync('python3', ['--version'])
+    if (python.status !== 0) {
+        t.skip('python3 is not installed')
+        return
+    }
+
+    const run = spawnSync('python3', [sramMapPath, '--ram-size', '512', '--stack-reserve', '300'], {
+        input: NM_LISTING,
+        encoding: 'utf8'
+    })
+    assert.equal(run.status, 0, run.stderr)
+
+    const lines = run.stdout.trim().split('\n')
+    // 0x1e8 - 0x100 includes the alignment byte in front of _end.
+    assert.equal(lines[0], 'SRAM 512 bytes: data 2, bss 229, static 232, stack 280')
+    assert.deepEqual(
+        lines.slice(1, -1).map((line) => line.trim().split(/\s{2,}/)),
+        [
+            ['132', 'bss', 'display_payload_buf'],
+            ['64', 'bss', '(anonymous namespace)::ring'],
+            ['32', 'bss', 'modemReceiver'],
+            ['2', 'data', 'display'],
+            ['1', 'bss', '(anonymous namespace)::flush_pos']
+        ]
+    )
+    assert.equal(lines.at(-1), 'warning: only 280 bytes left for the stack (reserve 300)')
+})
+
+/**
+ * Verify that every environment writes the map and that the firmware reports its stack high-water mark.
+ */
+test('builds write the SRAM map and report stack headroom', () => {
+    const platformio = fs.readFileSync(path.join(firmwareRoot, 'platformio.ini'), 'utf8')
+    const stackCheck = fs.readFileSync(path.join(firmwareRoot, 'lib', 'System', 'StackCheck.cpp'), 'utf8')
+    const stackCheckHeader = fs.readFileSync(path.join(firmwareRoot, 'lib', 'System', 'StackCheck.h'), 'utf8')
+    const system = fs.readFileSync(path.join(firmwareRoot, 'lib', 'System', 'System.cpp'), 'utf8')
+
+    // hwdiag does not extend release, so it needs its own entry.
+    assert.equal(platformio.match(/^extra_scripts = post:sram_map\.py$/gm)?.length, 2)
+    assert.match(stackCheck, /section\("\.init3"\)/)
+    // Release has no channel that reads the headroom, so it does not paint.
+    assert.match(stackCheck, /^#if STACK_CHECK\n[\s\S]*section\("\.init3"\)[\s\S]*\n#endif\n$/m)
+    assert.match(stackCheckHeader, /#if \(defined\(JP1_DEBUG_SERIAL\) && !defined\(JP1_DEBUG_SILENT\)\) \|\| defined\(DIAG_INTERNAL_LOG\)\n#define STACK_CHECK 1/)
+    assert.match(system, /static void reportStackHeadroom\(\)\s*\{\s*#if STACK_CHECK/)
+    assert.match(system, /trace::record\(trace::FRAME_DONE\);\s*reportStackHeadroom\(\);/)
+    assert.match(system, /reportStackHeadroom\(\);\s*sched::report\(\);\s*\/\/ Buffered trace records[\s\S]*trace::flush\(\);/)
+    assert.match(system, /trace::record\(trace::STACK_FREE, bytes\);\s*diaglog::setStackFree\(bytes\);/)
+})
@@ -0,0 +1,47 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const systemPath = path.join(repoRoot, 'firmware', 'lib', 'System', 'System.cpp')
+const systemHeaderPath = path.join(repoRoot, 'firmware', 'lib', 'System', 'System.h')
+const platformioPath = path.join(repoRoot, 'firmware', 'platformio.ini')
+const displaySourcePath = path.join(repoRoot, 'firmware', 'lib', 'Display', 'Display.cpp')
+
+/**
+ * Verify that auto-off is opt-in, runs the regular shutdown path, and restarts its countdown on activity.
+ */
+test('builds with AUTO_OFF_MS power down without presses or receive activity', () => {
+    const systemSource = fs.readFileSync(systemPath, 'utf8')
+    const systemHeader = fs.readFileSync(systemHeaderPath, 'utf8')
+    const platformio = fs.readFileSync(platformioPath, 'utf8')
+
+    // Displaying alone never powers a badge down unless a build opts in.
+    assert.match(systemHeader, /#ifndef AUTO_OFF_MS\s*#define AUTO_OFF_MS 0UL\s*#endif/)
+    assert.doesNotMatch(platformio, /-DAUTO_OFF_MS=/)
+    assert.match(systemSource, /#if AUTO_OFF_MS > 0/)
+    assert.match(systemSource, /bool active = pressed != 0;\s*#ifdef ENABLE_MODEM\s*active = active \|\| \(modem_enabled && !modemReceiver\.isIdle\(\)\);\s*#endif/)
+    assert.match(systemSource, /else if \(now_ms - last_activity_ms_ >= AUTO_OFF_MS\)\s*\{\s*trace::record\(trace::AUTO_OFF\);\s*shutdown\(\);/)
+})
+
+/**
+ * Verify that the optional pause sleep blanks the matrix, sleeps on the watchdog, and resumes the next cycle.
+ */
+test('sleep between repeats powers down through long pauses on the watchdog', () => {
+    const systemSource = fs.readFileSync(systemPath, 'utf8')
+    const displaySource = fs.readFileSync(displaySourcePath, 'utf8')
+    const start = systemSource.indexOf('void System::sleepThroughPause_()')
+    assert.notEqual(start, -1, 'expected System::sleepThroughPause_()')
+    const sleep = systemSource.slice(start, systemSource.indexOf('\n}\n', start))
+
+    assert.match(systemSource, /#ifdef SLEEP_BETWEEN_REPEATS\s*\{System::TASK_PAUSE_SLEEP, \d+, \d+\},\s*#endif/)
+    assert.match(systemSource, /case TASK_PAUSE_SLEEP:\s*blinkenstar\.sleepThroughPause_\(\);/)
+    assert.match(sleep, /if \(remaining_ms < SLEEP_BETWEEN_REPEATS_MIN_MS \|\| button1_is_low\(\) \|\| button2_is_low\(\)\)/)
+    assert.match(sleep, /if \(modem_enabled && !modemReceiver\.isIdle\(\)\)\s*\{\s*return;\s*\}/)
+    assert.match(sleep, /display\.disable\(\);[\s\S]*set_sleep_mode\(SLEEP_MODE_PWR_DOWN\);[\s\S]*wdt_disable\(\);[\s\S]*display\.skipPause\(\);\s*display\.resume\(\);/)
+    assert.match(systemSource, /WDTCSR = _BV\(WDCE\) \| _BV\(WDE\);\s*WDTCSR = _BV\(WDIE\) \| prescaler;/)
+    assert.match(displaySource, /const uint32_t refreshes = \(uint32_t\)steps \* 244 - step_progress;/)
+})
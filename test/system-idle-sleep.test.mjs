@@ -0,0 +1,52 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const mainPath = path.join(repoRoot, 'firmware', 'src', 'main.cpp')
+const systemPath = path.join(repoRoot, 'firmware', 'lib', 'System', 'System.cpp')
+const systemHeaderPath = path.join(repoRoot, 'firmware', 'lib', 'System', 'System.h')
+const platformioPath = path.join(repoRoot, 'firmware', 'platformio.ini')
+
+/**
+ * Verify that the runtime loop idles between column ticks instead of spinning.
+ */
+test('main loop idle-sleeps until the next column tick, millis tick or modem byte', () => {
+    const mainSource = fs.readFileSync(mainPath, 'utf8')
+    const systemSource = fs.readFileSync(systemPath, 'utf8')
+    const start = systemSource.indexOf('void System::idle()')
+    assert.notEqual(start, -1, 'expected System::idle() in System.cpp')
+    const idle = systemSource.slice(start, systemSource.indexOf('\n}\n', start))
+
+    assert.match(mainSource, /blinkenstar\.loop\(\);\s*\/\/[^\n]*\n\s*blinkenstar\.idle\(\);/)
+    assert.match(idle, /#ifndef NO_IDLE_SLEEP/)
+    assert.match(idle, /set_sleep_mode\(SLEEP_MODE_IDLE\);/)
+    assert.match(idle, /const uint8_t column = display\.activeColumn\(\);/)
+    assert.match(idle, /const uint8_t tick = \(uint8_t\)millis\(\);/)
+    // The millis() tick keeps the loop alive while the multiplex timer is stopped.
+    assert.match(idle, /sleep_cpu\(\);[\s\S]*\} while \(display\.activeColumn\(\) == column && \(uint8_t\)millis\(\) == tick\);/)
+    assert.match(idle, /if \(modem_enabled && fecModem\.available\(\)\)\s*\{\s*break;\s*\}/)
+    // Free-running polled ADC samples would be overwritten while the CPU sleeps.
+    assert.match(idle, /#if defined\(ENABLE_MODEM\) && defined\(RX_POLLING\)\s*\/\/[^\n]*\n\s*if \(modem_enabled\)\s*\{\s*return;\s*\}/)
+})
+
+/**
+ * Verify that button hold thresholds are real time instead of loop-pass counts.
+ */
+test('button hold thresholds are measured in milliseconds', () => {
+    const systemSource = fs.readFileSync(systemPath, 'utf8')
+    const systemHeader = fs.readFileSync(systemHeaderPath, 'utf8')
+    const platformio = fs.readFileSync(platformioPath, 'utf8')
+
+    for (const obsolete of [/SHUTDOWN_THRESHOLD/, /BOTH_STABLE_THRESHOLD/, /RECEIVE_HOLD_TICKS/, /want_shutdown/, /btn2_hold\b/]) {
+        assert.doesNotMatch(systemSource + systemHeader + platformio, obsolete)
+    }
+    assert.match(systemHeader, /#ifndef SHUTDOWN_HOLD_MS\s*#define SHUTDOWN_HOLD_MS 524U\s*#endif/)
+    assert.match(systemHeader, /#ifndef BOTH_STABLE_MS\s*#define BOTH_STABLE_MS 8U\s*#endif/)
+    assert.match(systemSource, /const uint16_t held_ms = held1_ms < held2_ms \? held1_ms : held2_ms;/)
+    assert.match(systemSource, /if \(held_ms >= BOTH_STABLE_MS \+ SHUTDOWN_HOLD_MS\)\s*\{\s*shutdown\(\);/)
+    assert.match(systemSource, /buttons\.heldMs\(Buttons::BUTTON_2\) >= RECEIVE_HOLD_MS/)
+})
@@ -0,0 +1,100 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { spawnSync } from 'node:child_process'
+import { fileURLToPath } from 'node:url'
+
+import { decodeTraceStream, formatTraceTimeline, loadTraceEvents } from '../scripts/lib/trace-decode.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const firmwareRoot = path.join(repoRoot, 'firmware')
+
+/**
+ * Compile the host trace probe and return its raw JP1 output.
+ *
+ * @returns {Buffer} Captured bytes.
+ */
+function runTraceProbe() {
+    const output = path.join(os.tmpdir(), 'blinkenstar-trace-host')
+    const compile = spawnSync(
+        'c++',
+        [
+            '-std=c++17',
+            '-DJP1_DEBUG_SERIAL',
+            '-DTRACE_RING_SIZE=8',
+            '-I', path.join(firmwareRoot, 'test', 'host'),
+            '-I', path.join(firmwareRoot, 'lib', 'DebugSerial'),
+            '-I', path.join(firmwareRoot, 'lib', 'Trace'),
+            path.join(firmwareRoot, 'test', 'TraceHost.cpp'),
+            path.join(firmwareRoot, 'lib', 'Trace', 'Trace.cpp'),
+            '-o', output
+        ],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+    assert.equal(compile.status, 0, compile.stderr || compile.stdout)
+
+    const run = spawnSync(output, [], { cwd: repoRoot })
+    assert.equal(run.status, 0, String(run.stderr))
+    return run.stdout
+}
+
+/**
+ * Verify that the firmware ring, its overflow report and the host decoder agree on one timeline.
+ */
+test('trace records survive the ring and decode into a timeline', () => {
+    const result = decodeTraceStream(runTraceProbe())
+    const appends = [0, 1, 2, 3, 4, 5, 6].map((page) => ['STORAGE_APPEND', 1000, page])
+
+    assert.equal(result.corrupt, 0)
+    assert.deepEqual(result.text, ['HB'])
+    assert.deepEqual(
+        result.records.map(({ name, timeMs, arg }) => [name, timeMs, arg]),
+        [
+            ['BOOT', 100, 2],
+            ['RX_BEGIN', 150, 0],
+            ...appends,
+            ['DROPPED', 1200, 3],
+            ['DROPPED', 1300, 1],
+            ['WAKE', 1300, 0],
+            ['RX_END', 65000, 0],
+            ['SHUTDOWN', 65736, 0]
+        ]
+    )
+    assert.match(formatTraceTimeline(result), /^ {4}0\.000 s {2}\+ {4}0 ms {2}BOOT {15}0x0002 \(2\)$/m)
+})
+
+/**
+ * Verify that a damaged record is skipped without losing the records around it.
+ */
+test('trace decoder resynchronises after a corrupted record', () => {
+    const bytes = [...runTraceProbe()]
+    // Flip a timestamp bit in the second record (after the 7-byte BOOT record).
+    bytes[7 + 2] ^= 0x01
+    const result = decodeTraceStream(bytes)
+
+    assert.equal(result.corrupt, 1)
+    assert.equal(result.records[0].name, 'BOOT')
+    assert.equal(result.records[1].name, 'STORAGE_APPEND')
+})
+
+/**
+ * Verify that event ids come from Trace.h and that the old string events are gone from the traced modules.
+ */
+test('trace event names follow the firmware enum and replace string logging', () => {
+    const events = loadTraceEvents()
+    assert.equal(events.get(1), 'BOOT')
+    // Ids are appended, so existing ones keep their values.
+    assert.equal(events.get(23), 'DROPPED')
+    assert.equal(new Set(events.keys()).size, events.size)
+
+    for (const file of ['Modem/Receiver.cpp', 'Storage/Storage.cpp', 'TwiBus/TwiBus.cpp']) {
+        assert.doesNotMatch(fs.readFileSync(path.join(firmwareRoot, 'lib', file), 'utf8'), /debuglog::/, file)
+    }
+    const systemSource = fs.readFileSync(path.join(firmwareRoot, 'lib', 'System', 'System.cpp'), 'utf8')
+    assert.doesNotMatch(systemSource, /debuglog::println\("/)
+    assert.match(systemSource, /if \(!blinkenstar\.modem_enabled \|\| modemReceiver\.isIdle\(\)\)\s*#endif\s*\{\s*trace::drain\(\);\s*\}/)
+    assert.match(systemSource, /trace::flush\(\);[\s\S]*bool wake_requested = false;/)
+})
@@ -0,0 +1,173 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import { execFileSync } from 'node:child_process'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { generateBadges, parseManifest, planExport, seededToken } from '../scripts/lib/transfer-export.mjs'
+import { SAMPLE_RATE, createMultichannelTransferPcmBuffer, createTransferPcmBuffer } from '../scripts/lib/transfer-tone.mjs'
+import { WAV_HEADER_BYTES, createWavHeader } from '../scripts/lib/wav.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const cliPath = path.join(repoRoot, 'scripts', 'export-transfer-wav.mjs')
+const packageJson = JSON.parse(fs.readFileSync(path.join(repoRoot, 'package.json'), 'utf8'))
+
+/**
+ * Run the export CLI in a scratch directory.
+ *
+ * @param {string} cwd Working directory.
+ * @param {string[]} args CLI arguments.
+ * @returns {string} Standard output.
+ */
+function runExportCli(cwd, args) {
+    return execFileSync(process.execPath, [cliPath, ...args], { cwd, encoding: 'utf8' })
+}
+
+/**
+ * Verify that manifest patterns get the transfer:test defaults and seeded tokens.
+ */
+test('parseManifest fills text defaults and substitutes seeded tokens', () => {
+    const manifest = {
+        badges: [
+            { name: 'alice', patterns: [{ text: 'HI {token}' }, { text: 'BYE', speed: 3, repeat: 2 }] },
+            { patterns: [{ type: 'text', text: '{token}', brightness: 5 }] }
+        ]
+    }
+    const badges = parseManifest(manifest, { seed: 'station-1' })
+
+    assert.deepEqual(badges.map((badge) => badge.name), ['alice', 'badge-002'])
+    assert.equal(badges[0].patterns[0].text, `HI ${seededToken('station-1', 0, 0)}`)
+    assert.deepEqual(badges[0].patterns[1], {
+        type: 'text',
+        text: 'BYE',
+        speed: 3,
+        delay: 0,
+        direction: 0,
+        repeat: 2,
+        brightness: 0
+    })
+    assert.equal(badges[1].patterns[0].text, seededToken('station-1', 1, 0))
+    assert.equal(badges[1].patterns[0].brightness, 5)
+    assert.deepEqual(parseManifest(manifest, { seed: 'station-1' }), badges)
+    assert.notDeepEqual(parseManifest(manifest, { seed: 'station-2' }), badges)
+})
+
+/**
+ * Verify that manifest mistakes are reported with the badge they belong to.
+ */
+test('parseManifest rejects invalid badges and pattern fields', () => {
+    assert.throws(() => parseManifest({ badges: [] }), /at least one badge/)
+    assert.throws(() => parseManifest([{ name: 'a/b', patterns: [{ text: 'X' }] }]), /name may only use/)
+    assert.throws(
+        () => parseManifest([{ name: 'a', patterns: [{ text: 'X' }] }, { name: 'a', patterns: [{ text: 'Y' }] }]),
+        /duplicate name "a"/
+    )
+    assert.throws(() => parseManifest([{ name: 'a', patterns: [] }]), /a: badge must list at least one pattern/)
+    assert.throws(() => parseManifest([{ name: 'a', patterns: [{ text: 'Grüße' }] }]), /a pattern 1: text must be/)
+    assert.throws(() => parseManifest([{ name: 'a', patterns: [{ text: 'X', speed: 16 }] }]), /speed must be an integer from 0 to 15/)
+})
+
+/**
+ * Verify that playlist jobs are laid out back to back with the requested gap.
+ */
+test('planExport places playlist entries at fixed offsets separated by the gap', () => {
+    const badges = generateBadges(3, { seed: 'layout' })
+    const plan = planExport(badges, { playlist: 'all.wav', gapSeconds: 0.5 })
+    const gap = SAMPLE_RATE / 2
+
+    assert.equal(plan.jobs[0].position, WAV_HEADER_BYTES)
+    assert.equal(plan.jobs[1].startSample, plan.jobs[0].sampleCount + gap)
+    assert.equal(plan.jobs[2].position, WAV_HEADER_BYTES + plan.jobs[2].startSample * 2)
+    assert.equal(plan.playlist.dataBytes, (plan.jobs[2].startSample + plan.jobs[2].sampleCount) * 2)
+    assert.ok(plan.jobs.every((job) => job.path === 'all.wav' && !job.header))
+})
+
+/**
+ * Verify that per-badge export writes one WAV per badge with the same PCM as the in-memory encoder.
+ */
+test('transfer export writes one WAV per badge on worker threads', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'transfer-export-'))
+    try {
+        const output = runExportCli(dir, ['--generate', '3', '--seed', 'wav', '--jobs', '2', '--out-dir', 'out'])
+        assert.match(output, /Rendered 3 badges, .* with 2 workers/)
+
+        for (const badge of generateBadges(3, { seed: 'wav' })) {
+            const file = fs.readFileSync(path.join(dir, 'out', `${badge.name}.wav`))
+            const pcm = createTransferPcmBuffer(badge.patterns)
+
+            assert.ok(file.subarray(0, WAV_HEADER_BYTES).equals(createWavHeader({ sampleRate: SAMPLE_RATE, dataBytes: pcm.length })))
+            assert.ok(file.subarray(WAV_HEADER_BYTES).equals(pcm))
+        }
+    } finally {
+        fs.rmSync(dir, { recursive: true, force: true })
+    }
+})
+
+/**
+ * Verify that multichannel export puts consecutive badges side by side and leaves a short group's spare channel silent.
+ */
+test('transfer export groups badges onto the channels of one WAV', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'transfer-export-'))
+    try {
+        runExportCli(dir, ['--generate', '3', '--seed', 'stereo', '--channels', '2', '--jobs', '2', '--out-dir', 'out'])
+
+        const badges = generateBadges(3, { seed: 'stereo' })
+        const plan = planExport(badges, { channels: 2 })
+        assert.deepEqual(plan.jobs.map((job) => job.name), [`${badges[0].name}+${badges[1].name}`, badges[2].name])
+
+        for (const job of plan.jobs) {
+            const file = fs.readFileSync(path.join(dir, 'out', `${job.name}.wav`))
+            const pcm = createMultichannelTransferPcmBuffer([...job.channelPatterns, null].slice(0, 2))
+
+            assert.ok(file.subarray(0, WAV_HEADER_BYTES).equals(createWavHeader({ sampleRate: SAMPLE_RATE, channels: 2, dataBytes: pcm.length })))
+            assert.ok(file.subarray(WAV_HEADER_BYTES).equals(pcm))
+            assert.equal(pcm.length, job.sampleCount * 4)
+        }
+    } finally {
+        fs.rmSync(dir, { recursive: true, force: true })
+    }
+})
+
+/**
+ * Verify that a seeded playlist is identical for any worker count and contains silent gaps.
+ */
+test('transfer export playlist is deterministic across worker counts', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'transfer-export-'))
+    const manifestPath = path.join(dir, 'badges.json')
+    fs.writeFileSync(manifestPath, JSON.stringify([
+        { name: 'one', patterns: [{ text: 'ONE {token}' }] },
+        { name: 'two', patterns: [{ text: 'TWO' }, { text: 'MORE {token}', direction: 1 }] },
+        { name: 'three', patterns: [{ text: 'THREE' }] }
+    ]))
+
+    try {
+        const output = runExportCli(dir, [manifestPath, '--seed', 'loop', '--playlist', 'a.wav', '--gap', '0.25', '--jobs', '1'])
+        runExportCli(dir, [manifestPath, '--seed', 'loop', '--playlist', 'b.wav', '--gap', '0.25', '--jobs', '3'])
+
+        const first = fs.readFileSync(path.join(dir, 'a.wav'))
+        assert.ok(first.equals(fs.readFileSync(path.join(dir, 'b.wav'))))
+        assert.match(output, /^\s+0\.000s\s+\d+\.\d{3}s {2}one$/m)
+
+        const badges = parseManifest(JSON.parse(fs.readFileSync(manifestPath, 'utf8')), { seed: 'loop' })
+        const plan = planExport(badges, { playlist: 'a.wav', gapSeconds: 0.25 })
+        assert.equal(first.length, WAV_HEADER_BYTES + plan.playlist.dataBytes)
+
+        const firstEnd = plan.jobs[0].position + plan.jobs[0].sampleCount * 2
+        assert.ok(first.subarray(firstEnd, plan.jobs[1].position).every((byte) => byte === 0))
+        assert.equal(plan.jobs[1].position - firstEnd, SAMPLE_RATE / 4 * 2)
+        assert.ok(first.subarray(plan.jobs[1].position, plan.jobs[1].position + plan.jobs[1].sampleCount * 2)
+            .equals(createTransferPcmBuffer(badges[1].patterns)))
+    } finally {
+        fs.rmSync(dir, { recursive: true, force: true })
+    }
+})
+
+/**
+ * Verify that the npm script exposes the WAV export CLI.
+ */
+test('package.json exposes the transfer:export script', () => {
+    assert.equal(packageJson.scripts['transfer:export'], 'node scripts/export-transfer-wav.mjs')
+})
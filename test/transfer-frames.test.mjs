@@ -0,0 +1,182 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import { execFileSync } from 'node:child_process'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+import { deflateSync } from 'node:zlib'
+
+import { encodeFramesPattern, encodeGif, encodePngStrip } from '../scripts/lib/display-sim.mjs'
+import { loopbackTransfer } from '../scripts/lib/loopback.mjs'
+import { decodePng, loadSpriteFrames } from '../scripts/lib/sprite.mjs'
+import { parseManifest } from '../scripts/lib/transfer-export.mjs'
+import { createFramesPattern, createTransferPcmBuffer, encodeTransferPayloads } from '../scripts/lib/transfer-tone.mjs'
+import { WAV_HEADER_BYTES } from '../scripts/lib/wav.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const exportCliPath = path.join(__dirname, '..', 'scripts', 'export-transfer-wav.mjs')
+
+// An X, a box and a filled square, as stored column bytes.
+const FRAMES = [
+    [0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81],
+    [0xff, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xff],
+    [0x00, 0x00, 0x3c, 0x3c, 0x3c, 0x3c, 0x00, 0x00]
+]
+
+/**
+ * Invert stored column bytes into the active-low display buffer layout the image writers take.
+ *
+ * @param {number[][]} frames Stored frames.
+ * @returns {number[][]} Active-low frames.
+ */
+function toActiveLow(frames) {
+    return frames.map((columns) => columns.map((column) => ~column & 0xff))
+}
+
+/**
+ * Write an 8-bit RGBA PNG that uses a different scanline filter on every row.
+ *
+ * @param {number} width Image width.
+ * @param {number} height Image height.
+ * @param {Uint8Array} rgba Pixels.
+ * @returns {Buffer} PNG file contents.
+ */
+function encodeFilteredRgbaPng(width, height, rgba) {
+    const stride = width * 4
+    const raw = Buffer.alloc((stride + 1) * height)
+    for (let y = 0; y < height; y++) {
+        const filter = y % 5
+        raw[y * (stride + 1)] = filter
+        for (let x = 0; x < stride; x++) {
+            const left = x >= 4 ? rgba[y * stride + x - 4] : 0
+            const up = y > 0 ? rgba[(y - 1) * stride + x] : 0
+            const upLeft = y > 0 && x >= 4 ? rgba[(y - 1) * stride + x - 4] : 0
+            const p = left + up - upLeft
+            const paeth = Math.abs(p - left) <= Math.abs(p - up) && Math.abs(p - left) <= Math.abs(p - upLeft)
+                ? left
+                : Math.abs(p - up) <= Math.abs(p - upLeft) ? up : upLeft
+            const predictor = [0, left, up, (left + up) >> 1, paeth][filter]
+            raw[y * (stride + 1) + 1 + x] = (rgba[y * stride + x] - predictor) & 0xff
+        }
+    }
+
+    const chunk = (type, data) => {
+        const head = Buffer.alloc(8)
+        head.writeUInt32BE(data.length, 0)
+        head.write(type, 4, 'ascii')
+        // The decoder does not check CRCs.
+        return Buffer.concat([head, data, Buffer.alloc(4)])
+    }
+    const header = Buffer.alloc(13)
+    header.writeUInt32BE(width, 0)
+    header.writeUInt32BE(height, 4)
+    header[8] = 8
+    header[9] = 6
+
+    return Buffer.concat([
+        Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a]),
+        chunk('IHDR', header),
+        chunk('IDAT', deflateSync(raw)),
+        chunk('IEND', Buffer.alloc(0))
+    ])
+}
+
+/**
+ * Verify that PNG strips and GIFs written by the display simulator read back as the frames they show.
+ */
+test('sprite loader reads display simulator PNG strips and GIFs back into column bytes', () => {
+    const png = encodePngStrip(toActiveLow(FRAMES), { scale: 4 })
+    assert.deepEqual(loadSpriteFrames(png, { scale: 4, gap: 4 }), FRAMES)
+
+    const gif = encodeGif({ frames: toActiveLow(FRAMES).map((columns, index) => ({ refresh: index * 10, columns })), refreshes: 30 }, { scale: 2 })
+    assert.deepEqual(loadSpriteFrames(gif, { scale: 2 }), FRAMES)
+
+    assert.throws(() => loadSpriteFrames(png, { scale: 4 }), /not a grid of 32px cells 0px apart/)
+    assert.throws(() => loadSpriteFrames(Buffer.from('BM')), /PNG or GIF/)
+})
+
+/**
+ * Verify that truecolour PNG sheets with every scanline filter and transparency decode to the right LEDs.
+ */
+test('sprite loader reads filtered RGBA PNG sheets row by row', () => {
+    // Two cells across and one down; lit = bright and opaque, a bright transparent pixel stays dark.
+    const width = 16
+    const height = 8
+    const rgba = new Uint8Array(width * height * 4)
+    const expected = [Array(8).fill(0), Array(8).fill(0)]
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            const lit = (x * 3 + y * 5) % 7 < 3
+            const pixel = (y * width + x) * 4
+            rgba.set(lit ? [20, 200, 90, 255] : (x + y) % 4 === 0 ? [255, 255, 255, 0] : [90, 60, 30, 255], pixel)
+            if (lit) {
+                expected[x >> 3][x & 7] |= 1 << y
+            }
+        }
+    }
+
+    const image = decodePng(encodeFilteredRgbaPng(width, height, rgba))
+    assert.deepEqual([...image.frames[0]], [...rgba])
+    assert.deepEqual(loadSpriteFrames(encodeFilteredRgbaPng(width, height, rgba)), expected)
+})
+
+/**
+ * Verify that the transfer encoder writes FRAMES blocks with the header layout the receiver reads.
+ */
+test('transfer encoder serializes frames patterns with the firmware FRAMES header', () => {
+    const pattern = createFramesPattern({ frames: FRAMES, speed: 15, delay: 9, repeat: 3, brightness: 5 })
+    const { legacyRawBytes, modernRawBytes } = encodeTransferPayloads([pattern])
+
+    assert.deepEqual(legacyRawBytes.slice(4, -3), [0x0f, 0xf0, ...encodeFramesPattern(pattern)])
+    assert.deepEqual(legacyRawBytes.slice(6, 10), [0x20, 0x18, 0x5f, 0x93])
+    // The alternate format has no repeat field, as for text.
+    assert.deepEqual(modernRawBytes.slice(2, 8), [0xa9, 0xa9, 0x20, 0x18, 0x5f, 0x90])
+
+    assert.throws(() => createTransferPcmBuffer([createFramesPattern({ frames: [[1, 2, 3]] })]), /exactly 8 column bytes/)
+    assert.throws(() => createTransferPcmBuffer([createFramesPattern({ frames: [] })]), /1 to 511 frames/)
+    assert.throws(() => createTransferPcmBuffer([createFramesPattern({ frames: Array(512).fill(FRAMES[0]) })]), /1 to 511 frames/)
+    assert.throws(() => createTransferPcmBuffer([{ type: 'bitmap' }]), /text and frames patterns only/)
+})
+
+/**
+ * Verify that a FRAMES transfer is stored byte for byte by the firmware receive stack.
+ */
+test('frames transfer passes through the firmware receive loopback', () => {
+    const pattern = createFramesPattern({ frames: FRAMES, speed: 12, delay: 2, repeat: 1 })
+    const { scores, result } = loopbackTransfer([pattern])
+
+    assert.equal(scores[0].frameOk, true)
+    assert.deepEqual(result.frames[0].patterns, [encodeFramesPattern(pattern)])
+    assert.equal(result.shows.at(-1).type, 2)
+})
+
+/**
+ * Verify that manifests can give frames inline or as sprite files next to the manifest.
+ */
+test('transfer export renders frames patterns from manifest sprite files', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'transfer-frames-'))
+    const manifestPath = path.join(dir, 'badges.json')
+    fs.writeFileSync(path.join(dir, 'x.png'), encodePngStrip(toActiveLow(FRAMES), { scale: 4 }))
+    const manifest = [
+        { name: 'sprite', patterns: [{ type: 'frames', image: 'x.png', scale: 4, gap: 4, speed: 10, delay: 12 }] },
+        { name: 'inline', patterns: [{ type: 'frames', frames: FRAMES }, { text: 'AND TEXT' }] }
+    ]
+    fs.writeFileSync(manifestPath, JSON.stringify(manifest))
+
+    try {
+        const badges = parseManifest(manifest, { baseDir: dir })
+        assert.deepEqual(badges[0].patterns[0], createFramesPattern({ frames: FRAMES, speed: 10, delay: 12 }))
+        assert.deepEqual(badges[1].patterns[0], createFramesPattern({ frames: FRAMES }))
+
+        assert.throws(() => parseManifest([{ name: 'a', patterns: [{ type: 'frames', image: 'missing.png' }] }], { baseDir: dir }), /a pattern 1: ENOENT/)
+        assert.throws(() => parseManifest([{ name: 'a', patterns: [{ type: 'frames', frames: [[1]] }] }]), /each frame must be 8 column bytes/)
+        assert.throws(() => parseManifest([{ name: 'a', patterns: [{ type: 'frames', frames: FRAMES, direction: 1, delay: 16 }] }]), /delay must be an integer from 0 to 15/)
+
+        execFileSync(process.execPath, [exportCliPath, manifestPath, '--out-dir', 'out', '--jobs', '1'], { cwd: dir })
+        const wav = fs.readFileSync(path.join(dir, 'out', 'sprite.wav'))
+        assert.ok(wav.subarray(WAV_HEADER_BYTES).equals(createTransferPcmBuffer(badges[0].patterns)))
+    } finally {
+        fs.rmSync(dir, { recursive: true, force: true })
+    }
+})
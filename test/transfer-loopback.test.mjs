@@ -0,0 +1,195 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import { execFileSync } from 'node:child_process'
+import fs from 'node:fs'
+import os from 'node:os'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+import { DEFAULT_CHANNEL, alignedBitErrors, loopbackPcm, loopbackTransfer, scoreLoopback } from '../scripts/lib/loopback.mjs'
+import { SAMPLE_RATE, createTransferPcmBuffer, createTransferPcmWriter, createTransferTestPattern, encodeTransferPayloads } from '../scripts/lib/transfer-tone.mjs'
+import { createWavHeader, readWav } from '../scripts/lib/wav.mjs'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const cliPath = path.join(repoRoot, 'scripts', 'loopback-transfer.mjs')
+const packageJson = JSON.parse(fs.readFileSync(path.join(repoRoot, 'package.json'), 'utf8'))
+
+const patterns = [
+    createTransferTestPattern({ token: 'A1B2C3' }),
+    { ...createTransferTestPattern({ token: '' }), text: 'LOOP', direction: 1, repeat: 2 }
+]
+
+/**
+ * Verify the bit error count at the best alignment of received and expected bytes.
+ */
+test('alignedBitErrors finds the best shift and charges missing bytes in full', () => {
+    assert.equal(alignedBitErrors([0x12, 0x34, 0x56], [0x12, 0x34, 0x56]), 0)
+    assert.equal(alignedBitErrors([0xff, 0x12, 0x34, 0x56], [0x12, 0x34, 0x56]), 0)
+    assert.equal(alignedBitErrors([0x12, 0x35, 0x56], [0x12, 0x34, 0x56]), 1)
+    assert.equal(alignedBitErrors([0x12, 0x34], [0x12, 0x34, 0x56]), 8)
+    assert.equal(alignedBitErrors([], [0x12, 0x34]), 16)
+})
+
+/**
+ * Verify that a clean legacy transfer is stored exactly and that the release build ignores the alternate format.
+ */
+test('clean loopback stores the legacy frame through the firmware receive stack', () => {
+    const { scores, result } = loopbackTransfer(patterns)
+    const [legacy, alternate] = scores
+
+    assert.equal(legacy.format, 'legacy')
+    assert.equal(legacy.rawBitErrors, 0)
+    assert.equal(legacy.frameOk, true)
+    assert.equal(result.frames.length, 1)
+    assert.equal(Buffer.from(result.frames[0].patterns[1].slice(4)).toString('ascii'), 'LOOP')
+    assert.equal(result.shows.at(-1).type, 1)
+
+    // Alternate symbols are shorter than one activity window at the release ADC rate.
+    assert.equal(alternate.format, 'alternate')
+    assert.equal(alternate.frameOk, false)
+})
+
+/**
+ * Verify that the single-format fast transfer is stored by the release receive stack.
+ */
+test('fast transfer stores the same frame through the firmware receive stack', () => {
+    const { scores, result } = loopbackTransfer(patterns, { noise: 4 }, { fast: true })
+
+    assert.deepEqual(scores.map((score) => score.format), ['legacy'])
+    assert.equal(scores[0].rawBitErrors, 0)
+    assert.equal(scores[0].frameOk, true)
+    assert.equal(result.frames.length, 1)
+})
+
+/**
+ * Verify that the start-marker correlator stores a short-sync transfer that follows other modem activity with no gap.
+ */
+test('loopback locks onto a short sync that directly follows another transfer', () => {
+    const pcm = createTransferPcmBuffer(patterns, { fast: true, shortSync: true })
+    const other = createTransferPcmBuffer([createTransferTestPattern({ token: 'ZZZZZZ' })], { fast: true })
+    const otherSamples = new Int16Array(other.buffer, other.byteOffset, other.length / 2)
+
+    const framesStored = (defines) => [0, 4, 8, 12, 16, 20].map((bits) => {
+        // Cut the other transfer mid-stream, a few short symbols further each time, so the new start lands at every byte phase.
+        const head = otherSamples.subarray(6000, 8000 + bits * 72)
+        const samples = new Int16Array(head.length + pcm.length / 2)
+        samples.set(head)
+        samples.set(new Int16Array(pcm.buffer, pcm.byteOffset, pcm.length / 2), head.length)
+        return loopbackPcm(samples, SAMPLE_RATE, { ...DEFAULT_CHANNEL, noise: 4 }, { defines }).result.frames.length
+    })
+
+    assert.deepEqual(framesStored([]), [1, 1, 1, 1, 1, 1])
+    assert.ok(framesStored(['MODEM_SYNC_SEARCH=0']).includes(0))
+})
+
+/**
+ * Verify that noise and dropouts are seeded so a failing point can be replayed.
+ */
+test('loopback impairments are deterministic per seed', () => {
+    const channel = { noise: 8, dropoutsPerSecond: 1 }
+    const first = loopbackTransfer(patterns, { ...channel, seed: 7 })
+    const second = loopbackTransfer(patterns, { ...channel, seed: 7 })
+
+    assert.deepEqual(second.result, first.result)
+    assert.deepEqual(second.scores, first.scores)
+})
+
+/**
+ * Verify that the threshold derived from the measured noise floor keeps a noisy channel decodable.
+ */
+test('loopback decodes at the noise level that defeated the fixed activity threshold', () => {
+    const calibrated = loopbackTransfer(patterns, { noise: 10 }, { fast: true })
+    const fixed = loopbackTransfer(patterns, { noise: 10 }, {
+        fast: true,
+        defines: ['MODEM_ACTIVITY_THRESHOLD_MIN=150', 'MODEM_ACTIVITY_THRESHOLD_MAX=150']
+    })
+
+    assert.equal(calibrated.scores[0].frameOk, true)
+    assert.equal(fixed.scores[0].frameOk, false)
+})
+
+/**
+ * Verify that a weak, noisy channel shows up as bit errors and a failed frame.
+ */
+test('loopback reports bit errors and frame loss on a noisy channel', () => {
+    const [legacy] = loopbackTransfer(patterns, { noise: 20 }).scores
+
+    assert.ok(legacy.rawBer > 0.1)
+    assert.equal(legacy.frameOk, false)
+})
+
+/**
+ * Verify that a glitch that drops a gap and a pulse costs one FEC triple instead of the rest of the frame.
+ */
+test('loopback receiver realigns bytes after a slipped symbol pair', () => {
+    const slipPatterns = [{ ...patterns[1], text: 'THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG' }, patterns[1]]
+    const pcm = createTransferPcmBuffer(slipPatterns, { fast: true })
+    const samples = new Int16Array(pcm.buffer, pcm.byteOffset, pcm.length / 2)
+
+    // Fast transfers start with 4800 samples of sync, then one 72- or 144-sample symbol per bit, LSB first.
+    const starts = []
+    let position = 4800
+    for (const byte of encodeTransferPayloads(slipPatterns).legacyFecBytes) {
+        for (let bit = 0; bit < 8; bit += 1) {
+            starts.push(position)
+            position += (byte >> bit) & 1 ? 144 : 72
+        }
+    }
+    const slipped = new Int16Array(samples.length - (starts[302] - starts[300]))
+    slipped.set(samples.subarray(0, starts[300]))
+    slipped.set(samples.subarray(starts[302]), starts[300])
+
+    const { result } = loopbackPcm(slipped, SAMPLE_RATE, {}, { defines: ['FEC_REALIGN'] })
+    const [legacy] = scoreLoopback(result, slipPatterns, {
+        legacySamples: createTransferPcmWriter(slipPatterns, { fast: true }).legacySampleCount,
+        sampleRate: SAMPLE_RATE,
+        leadSeconds: DEFAULT_CHANNEL.leadSeconds,
+        fast: true
+    })
+
+    assert.equal(result.frames.length, 1)
+    assert.ok(legacy.payloadBitErrors > 0 && legacy.payloadBitErrors <= 16)
+    assert.equal(Buffer.from(result.frames[0].patterns[1].slice(4)).toString('ascii'), 'LOOP')
+
+    // Without FEC_REALIGN the plain three-byte FEC reader loses the rest of the frame.
+    assert.equal(loopbackPcm(slipped, SAMPLE_RATE).result.frames.length, 0)
+    assert.equal(loopbackTransfer(patterns, {}, { fast: true, defines: ['FEC_REALIGN'] }).scores[0].frameOk, true)
+})
+
+/**
+ * Verify that the CLI scores an exported WAV at its own sample rate, and decodes one it has no patterns for.
+ */
+test('transfer loopback decodes WAV files', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'transfer-loopback-'))
+    const wavPath = path.join(dir, 'one.wav')
+    const pcm = createTransferPcmBuffer([patterns[0]])
+    fs.writeFileSync(wavPath, Buffer.concat([createWavHeader({ sampleRate: SAMPLE_RATE, dataBytes: pcm.length }), pcm]))
+
+    try {
+        const wav = readWav(fs.readFileSync(wavPath))
+        assert.equal(wav.sampleRate, SAMPLE_RATE)
+        assert.equal(wav.samples.length, pcm.length / 2)
+
+        const scored = execFileSync(process.execPath, [cliPath, '--wav', wavPath, '--text', patterns[0].text, '--json'], {
+            encoding: 'utf8'
+        })
+        const legacy = JSON.parse(scored.split('\n')[0])
+        assert.equal(legacy.format, 'legacy')
+        assert.equal(legacy.rawBitErrors, 0)
+        assert.equal(legacy.framesOk, 1)
+
+        const decoded = execFileSync(process.execPath, [cliPath, '--wav', wavPath], { encoding: 'utf8' })
+        assert.match(decoded, new RegExp(Buffer.from(patterns[0].text).toString('hex')))
+        assert.match(decoded, /1 frames/)
+    } finally {
+        fs.rmSync(dir, { recursive: true, force: true })
+    }
+})
+
+/**
+ * Verify that the npm script exposes the loopback CLI.
+ */
+test('package.json exposes the transfer:loopback script', () => {
+    assert.equal(packageJson.scripts['transfer:loopback'], 'node scripts/loopback-transfer.mjs')
+})
@@ -1,5 +1,7 @@
 import test from 'node:test'
 import assert from 'node:assert/strict'
+import { execFileSync } from 'node:child_process'
+import { createHash } from 'node:crypto'
 import fs from 'node:fs'
 import path from 'node:path'
 import { fileURLToPath } from 'node:url'
@@ -7,10 +9,16 @@ import {
     createTransferTestPattern,
     encodeTransferPayloads,
     createTransferSamples,
-    createTransferPcmBuffer
+    createTransferPcmBuffer,
+    createTransferPcmWriter,
+    createMultichannelTransferPcmBuffer,
+    estimateTransfer,
+    MultichannelTransferPcmStream,
+    TransferPcmStream
 } from '../scripts/lib/transfer-tone.mjs'
 
 const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
 const packageJson = JSON.parse(
     fs.readFileSync(path.join(__dirname, '..', 'package.json'), 'utf8')
 )
@@ -47,9 +55,233 @@ test('transfer encoder generates one-shot audio samples and PCM output', () => {
     assert.equal(pcm.length, samples.length * 2)
 })
 
+/**
+ * Build a five-pattern transfer that varies every metadata field.
+ *
+ * @returns {Array<{type: string, text: string, speed: number, delay: number, direction: number, repeat: number, brightness: number}>} Patterns.
+ */
+function createMixedPatterns() {
+    const patterns = []
+    for (let index = 0; index < 5; index += 1) {
+        patterns.push(createTransferTestPattern({
+            token: `P${index}`,
+            speed: index,
+            delay: index % 3,
+            direction: index & 1,
+            repeat: index,
+            brightness: index
+        }))
+    }
+    return patterns
+}
+
+/**
+ * Hash PCM or sample bytes for comparison with the array-based encoder output.
+ *
+ * @param {Buffer|Float32Array} data Encoder output.
+ * @returns {string} SHA-256 hex digest.
+ */
+function sha256(data) {
+    return createHash('sha256').update(Buffer.from(data.buffer, data.byteOffset, data.byteLength)).digest('hex')
+}
+
+/**
+ * Verify that the segment renderer reproduces the waveform of the original push-based encoder bit for bit.
+ * The digests were taken from the array-based implementation before it was replaced.
+ */
+test('transfer encoder output matches the array-based reference waveform', () => {
+    const single = createTransferPcmBuffer([createTransferTestPattern({ token: 'A1B2' })])
+    assert.equal(single.length, 232136)
+    assert.equal(sha256(single), '3124f63c41bf2eff2f18e3530d88f3fcc4b129f62cb80179ac7f97091e58fa28')
+
+    const mixed = createTransferPcmBuffer(createMixedPatterns())
+    assert.equal(mixed.length, 354696)
+    assert.equal(sha256(mixed), 'fd16e9c897edf07901a9c2267359c156bad0ea2c8fe1725d3a73cceec1b6a508')
+
+    const samples = createTransferSamples(createMixedPatterns())
+    assert.equal(samples.length, 177348)
+    assert.equal(sha256(samples), 'c4f3bad5aa4064beb8cbac2cefec7909565cf98a98abf393bf2139ac9ac63c98')
+})
+
+/**
+ * Verify that one reused chunk of any size renders the same PCM as the whole-buffer helper.
+ */
+test('transfer PCM writer fills a reused chunk until the transfer ends', () => {
+    const patterns = createMixedPatterns()
+    const expected = createTransferPcmBuffer(patterns)
+    const writer = createTransferPcmWriter(patterns)
+    const chunk = new Int16Array(777)
+    const parts = []
+    let written
+
+    assert.equal(writer.sampleCount * 2, expected.length)
+    while ((written = writer.read(chunk)) > 0) {
+        // Copy before the next read overwrites the chunk.
+        parts.push(Buffer.from(new Uint8Array(chunk.buffer, 0, written * 2)))
+    }
+
+    assert.equal(writer.read(chunk), 0)
+    assert.ok(Buffer.concat(parts).equals(expected))
+})
+
+/**
+ * Verify that fast mode sends the same legacy section after a shorter sync and nothing of the alternate format.
+ */
+test('fast transfer sends only the legacy section after a short sync', () => {
+    const patterns = createMixedPatterns()
+    const dual = createTransferPcmWriter(patterns)
+    const fast = createTransferPcmWriter(patterns, { fast: true })
+    const dualPcm = createTransferPcmBuffer(patterns)
+    const fastPcm = createTransferPcmBuffer(patterns, { fast: true })
+    const legacySync = 72000
+    const fastSync = 4800
+    // One closing short pulse follows the last legacy symbol.
+    const tail = 72
+
+    assert.equal(fast.sampleCount, fast.legacySampleCount)
+    assert.equal(fastPcm.length, fast.sampleCount * 2)
+    assert.equal(fast.sampleCount, dual.legacySampleCount - legacySync + fastSync + tail)
+    assert.ok(fastPcm.subarray(fastSync * 2, -tail * 2).equals(dualPcm.subarray(legacySync * 2, dual.legacySampleCount * 2)))
+    assert.equal(createTransferSamples(patterns, { fast: true }).length, fast.sampleCount)
+    assert.equal(new TransferPcmStream(patterns, { fast: true }).sampleCount, fast.sampleCount)
+})
+
+/**
+ * Verify that a short sync only cuts the quiet part of the legacy sync and leaves the alternate section alone.
+ */
+test('short sync transfer keeps the sync ramp and every data symbol', () => {
+    const patterns = createMixedPatterns()
+    const dual = createTransferPcmWriter(patterns)
+    const short = createTransferPcmWriter(patterns, { shortSync: true })
+    const fastShort = createTransferPcmWriter(patterns, { fast: true, shortSync: true })
+    const dualPcm = createTransferPcmBuffer(patterns)
+    const shortPcm = createTransferPcmBuffer(patterns, { shortSync: true })
+    const legacySync = 72000
+    const shortSync = 600
+    const ramp = 100
+
+    assert.equal(short.sampleCount, dual.sampleCount - legacySync + shortSync)
+    assert.equal(short.legacySampleCount, dual.legacySampleCount - legacySync + shortSync)
+    assert.ok(shortPcm.subarray(0, ramp * 2).equals(dualPcm.subarray(0, ramp * 2)))
+    assert.ok(shortPcm.subarray(shortSync * 2).equals(dualPcm.subarray(legacySync * 2)))
+    assert.equal(fastShort.sampleCount, createTransferPcmWriter(patterns, { fast: true }).sampleCount - 4800 + shortSync)
+    assert.equal(estimateTransfer(patterns, { fast: true, shortSync: true }).seconds, fastShort.sampleCount / 48000)
+    assert.equal(new TransferPcmStream(patterns, { shortSync: true }).sampleCount, short.sampleCount)
+})
+
+/**
+ * Verify that the duration estimate matches the rendered length and counts the stored pattern bytes.
+ */
+test('estimateTransfer reports playback time and effective bytes per second', () => {
+    const patterns = createMixedPatterns()
+    const dual = estimateTransfer(patterns)
+    const fast = estimateTransfer(patterns, { fast: true })
+    const storedBytes = patterns.reduce((sum, pattern) => sum + 4 + pattern.text.length, 0)
+
+    assert.equal(dual.seconds, createTransferPcmWriter(patterns).sampleCount / 48000)
+    assert.equal(fast.seconds, createTransferPcmWriter(patterns, { fast: true }).sampleCount / 48000)
+    assert.equal(dual.patternBytes, storedBytes)
+    assert.equal(fast.patternBytes, storedBytes)
+    assert.equal(fast.bytesPerSecond, storedBytes / fast.seconds)
+    assert.ok(fast.seconds < dual.seconds - 1.7)
+})
+
+/**
+ * Verify that the PCM stream emits bounded chunks whose concatenation matches the whole-buffer helper.
+ */
+test('TransferPcmStream streams the transfer in bounded chunks', async () => {
+    const patterns = createMixedPatterns()
+    const expected = createTransferPcmBuffer(patterns)
+    const stream = new TransferPcmStream(patterns, { samplesPerChunk: 1000 })
+    const chunks = []
+
+    for await (const chunk of stream) {
+        assert.ok(chunk.length <= 2000)
+        chunks.push(chunk)
+    }
+
+    assert.equal(stream.sampleCount * 2, expected.length)
+    assert.equal(chunks.length, Math.ceil(expected.length / 2000))
+    assert.ok(Buffer.concat(chunks).equals(expected))
+    assert.throws(() => new TransferPcmStream(patterns, { samplesPerChunk: 0 }), /samplesPerChunk must be a positive integer/)
+})
+
+/**
+ * Split interleaved little-endian PCM into one buffer per channel.
+ *
+ * @param {Buffer} pcm Interleaved PCM.
+ * @param {number} channels Channel count.
+ * @returns {Buffer[]} Per-channel PCM.
+ */
+function deinterleave(pcm, channels) {
+    const frames = pcm.length / 2 / channels
+    return Array.from({ length: channels }, (_, channel) => {
+        const out = Buffer.alloc(frames * 2)
+        for (let frame = 0; frame < frames; frame += 1) {
+            out.writeInt16LE(pcm.readInt16LE((frame * channels + channel) * 2), frame * 2)
+        }
+        return out
+    })
+}
+
+/**
+ * Verify that each channel carries its own transfer from the first frame, padded with silence to the longest one.
+ */
+test('multichannel transfer interleaves independent time-aligned payloads', async () => {
+    const long = createMixedPatterns()
+    const short = [createTransferTestPattern({ token: 'R1' })]
+    const longPcm = createTransferPcmBuffer(long)
+    const shortPcm = createTransferPcmBuffer(short)
+    const pcm = createMultichannelTransferPcmBuffer([long, short, null])
+    const [left, right, spare] = deinterleave(pcm, 3)
+
+    assert.equal(pcm.length, longPcm.length * 3)
+    assert.ok(left.equals(longPcm))
+    assert.ok(right.subarray(0, shortPcm.length).equals(shortPcm))
+    assert.ok(right.subarray(shortPcm.length).every((byte) => byte === 0))
+    assert.ok(spare.every((byte) => byte === 0))
+
+    const stream = new MultichannelTransferPcmStream([short, long], { framesPerChunk: 999, fast: true })
+    const chunks = []
+    for await (const chunk of stream) {
+        assert.equal(chunk.length % 4, 0)
+        chunks.push(chunk)
+    }
+    assert.equal(stream.frameCount, createTransferPcmWriter(long, { fast: true }).sampleCount)
+    assert.ok(Buffer.concat(chunks).equals(createMultichannelTransferPcmBuffer([short, long], { fast: true })))
+    assert.throws(() => createMultichannelTransferPcmBuffer([]), /at least one channel/)
+})
+
+/**
+ * Verify that the benchmark renders the same PCM size in every mode and reports throughput and peak RSS.
+ */
+test('transfer benchmark reports throughput and peak RSS per mode', () => {
+    const output = execFileSync(
+        process.execPath,
+        ['scripts/bench-transfer-pcm.mjs', '--sizes', '2', '--text-length', '16', '--json'],
+        { cwd: repoRoot, encoding: 'utf8' }
+    )
+    const runs = output.trim().split('\n').map((line) => JSON.parse(line))
+
+    assert.deepEqual(runs.map((run) => run.mode), ['buffer', 'chunk', 'stream'])
+    for (const run of runs) {
+        assert.equal(run.patterns, 2)
+        assert.equal(run.pcmBytes, runs[0].pcmBytes)
+        assert.ok(run.mbPerSecond > 0)
+        assert.ok(run.peakRssMb > 0)
+    }
+})
+
 /**
  * Verify that the npm script still points at the one-shot transfer entrypoint.
  */
 test('package.json exposes the transfer:test script', () => {
     assert.equal(packageJson.scripts['transfer:test'], 'node scripts/play-transfer-once.mjs')
 })
+
+/**
+ * Verify that the npm script exposes the PCM benchmark.
+ */
+test('package.json exposes the transfer:bench script', () => {
+    assert.equal(packageJson.scripts['transfer:bench'], 'node scripts/bench-transfer-pcm.mjs')
+})
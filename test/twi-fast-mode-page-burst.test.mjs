@@ -0,0 +1,49 @@
+import test from 'node:test'
+import assert from 'node:assert/strict'
+import fs from 'node:fs'
+import path from 'node:path'
+import { fileURLToPath } from 'node:url'
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url))
+const repoRoot = path.join(__dirname, '..')
+const twiBusHeaderPath = path.join(repoRoot, 'firmware', 'lib', 'TwiBus', 'TwiBus.h')
+const twiBusSourcePath = path.join(repoRoot, 'firmware', 'lib', 'TwiBus', 'TwiBus.cpp')
+const storageHeaderPath = path.join(repoRoot, 'firmware', 'lib', 'Storage', 'Storage.h')
+const storageSourcePath = path.join(repoRoot, 'firmware', 'lib', 'Storage', 'Storage.cpp')
+const receiverSourcePath = path.join(repoRoot, 'firmware', 'lib', 'Modem', 'Receiver.cpp')
+const platformioPath = path.join(repoRoot, 'firmware', 'platformio.ini')
+
+/**
+ * Verify that the shared TWI bus defaults to 100 kHz, makes 400 kHz opt-in, and keeps the speed overridable per build.
+ */
+test('twi bus defaults to 100 kHz with the 400 kHz fast-mode profile opt-in', () => {
+    const twiBusHeader = fs.readFileSync(twiBusHeaderPath, 'utf8')
+    const twiBusSource = fs.readFileSync(twiBusSourcePath, 'utf8')
+    const platformio = fs.readFileSync(platformioPath, 'utf8')
+
+    assert.match(
+        twiBusHeader,
+        /#ifndef TWI_BUS_FREQ_HZ\s*#ifdef TWI_FAST_MODE\s*#define TWI_BUS_FREQ_HZ 400000UL\s*#else\s*#define TWI_BUS_FREQ_HZ 100000UL\s*#endif\s*#endif/
+    )
+    // No checked-in build opts in until the fitted EEPROM is confirmed.
+    assert.doesNotMatch(platformio, /TWI_FAST_MODE|TWI_BUS_FREQ_HZ/)
+    assert.match(twiBusSource, /TWBR = \(\(F_CPU \/ TWI_BUS_FREQ_HZ\) - 16\) \/ 2;/)
+    assert.doesNotMatch(twiBusSource, /F_CPU \/ 100000UL/)
+})
+
+/**
+ * Verify that batched page writes use acknowledge polling and report each page.
+ */
+test('storage batches page writes with acknowledge polling and per-page completion', () => {
+    const twiBusHeader = fs.readFileSync(twiBusHeaderPath, 'utf8')
+    const storageHeader = fs.readFileSync(storageHeaderPath, 'utf8')
+    const storageSource = fs.readFileSync(storageSourcePath, 'utf8')
+    const receiverSource = fs.readFileSync(receiverSourcePath, 'utf8')
+
+    assert.match(twiBusHeader, /Status waitReady\(uint8_t deviceAddress\);/)
+    assert.match(storageHeader, /typedef void \(\*PageWriteCallback\)\(uint8_t page, bool ok\);/)
+    assert.match(storageHeader, /uint8_t appendPages\(uint8_t \*data, uint8_t count, PageWriteCallback onPage = nullptr\);/)
+    assert.match(storageSource, /twiBus\.waitReady\(I2C_EEPROM_ADDR\) == TwiBus::OK/)
+    assert.match(storageSource, /if \(onPage\)\s*\{\s*onPage\(page, ok\);\s*\}/)
+    assert.match(receiverSource, /storage\.appendPages\(store_pages_\[1\], store_pages_used_ - 1, onBufferedPageStored\);/)
+})